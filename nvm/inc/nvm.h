@@ -1,214 +1,807 @@
-/***************************************************************************//**
- * @file
- * @brief Non-Volatile Memory Manager.
- * @author Energy Micro AS
- * @version 3.20.0
- * @details
- * This is a software manager module for non-volatile memory. It consists of
- * nvm.c, nvm.h and nvm_hal.h. In addition to this it requires a valid nvm_hal.c.
- * This lets the manager work with different types of memory. 
- * Files nvm_config_template.* shows possible configuration of objects and could
- * be used as template for customer application.
- *
- * The module has the following public interfaces:
- *
- * NVM_Init()
- * NVM_Erase()
- * NVM_Write()
- * NVM_Read()
- * NVM_WearLevel()
- *
- * Users have to be aware of the following limitations of the module:
- * - Maximum 254 objects in a page and 256 pages (limited by uint8_t).
- *
- *******************************************************************************
- * @section License
- * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
- *******************************************************************************
- *
- * Permission is granted to anyone to use this software for any purpose,
- * including commercial applications, and to alter it and redistribute it
- * freely, subject to the following restrictions:
- *
- * 1. The origin of this software must not be misrepresented; you must not
- *    claim that you wrote the original software.
- * 2. Altered source versions must be plainly marked as such, and must not be
- *    misrepresented as being the original software.
- * 3. This notice may not be removed or altered from any source distribution.
- * 4. The source and compiled code may only be used on Energy Micro "EFM32"
- *    microcontrollers and "EFR4" radios.
- *
- * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
- * obligation to support this Software. Energy Micro AS is providing the
- * Software "AS IS", with no express or implied warranties of any kind,
- * including, but not limited to, any implied warranties of merchantability
- * or fitness for any particular purpose or warranties against infringement
- * of any proprietary rights of a third party.
- *
- * Energy Micro AS will not be liable for any consequential, incidental, or
- * special damages, or any other relief, or for any claim by any third party,
- * arising from your use of this Software.
- *
- *****************************************************************************/
-#ifndef __NVM_H
-#define __NVM_H
-
-#include <stdint.h>
-#include <stdbool.h>
-
-/* needed to get CPU flash size and calculate page size */
-#include "em_device.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-/***************************************************************************//**
- * @addtogroup EM_Drivers
- * @{
- ******************************************************************************/
-
-/***************************************************************************//**
- * @addtogroup NVM
- * @{
- ******************************************************************************/
-
-/*******************************************************************************
- *******************************   DEFINES   ***********************************
- ******************************************************************************/
-
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
-
-/** Certain features can be turned on and off on compile time to make the API
-* faster, save RAM and flash space. Set it to TRUE to turn the feature on. */
-
-/** Without this define the wear pages are no longer supported. */
-#define NVM_FEATURE_WEAR_PAGES_ENABLED               true
-
-/** Include and activate the static wear leveling functionality. */
-#define NVM_FEATURE_STATIC_WEAR_ENABLED              true
-
-/** The threshold used to decide when to do static wear leveling.*/
-#define NVM_STATIC_WEAR_THRESHOLD                    100
-
-/** Validate data against checksums on every read operation. */
-#define NVM_FEATURE_READ_VALIDATION_ENABLED          true
-
-/** Validate data against checksums after every write operation. */
-#define NVM_FEATURE_WRITE_VALIDATION_ENABLED         true
-
-/** Include the NVM_WearLevelGet function. */
-#define NVM_FEATURE_WEARLEVELGET_ENABLED             true
-
-/** Check if data has been updated before writing update to the NVM. */
-#define NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED    true
-
-/** define maximum number of flash pages that can be used as NVM */
-#define NVM_MAX_NUMBER_OF_PAGES                      32
-
-/** Calculate page size. */
-#if defined(_EFM32_GIANT_FAMILY) || defined(_EFM32_WONDER_FAMILY)
-#define NVM_PAGE_SIZE           (FLASH_SIZE < (512 * 1024) ? 2048 : 4096)
-#else
-/* _EFM32_GECKO_FAMILY || _EFM32_TINY_FAMILY */
-#define NVM_PAGE_SIZE           (512)
-#endif
-  
-/** All objects are written from RAM. */
-#define NVM_WRITE_ALL_CMD         0xff
-/** All objects are copied from the old page. */
-#define NVM_WRITE_NONE_CMD        0xfe
-/** All objects are read to RAM. */
-#define NVM_READ_ALL_CMD          0xff
-
-/** Retains the registered erase count when eraseing a page. */
-#define NVM_ERASE_RETAINCOUNT    0xffffffffUL
-
-/** Structure defining end of pages table. */
-#define NVM_PAGE_TERMINATION    { NULL, 0, (NVM_Object_Ids) 0 }
-
-/** @endcond */
-
-/*******************************************************************************
- ******************************   TYPEDEFS   ***********************************
- ******************************************************************************/
-
-/** Enum describing the type of logical page we have; normal or wear. */
-typedef enum
-{
-  nvmPageTypeNormal = 0, /**< Normal page, always rewrite. */
-  nvmPageTypeWear   = 1  /**< Wear page. Can be used several times before rewrite. */
-} NVM_Page_Type_t;
-
-/** Describes the properties of an object in a page. */
-typedef struct
-{
-  uint8_t  * location; /**< A pointer to the location of the object in RAM. */
-  uint16_t size;       /**< The size of the object in bytes. */
-  uint8_t  objectId;   /**< An object ID used to reference the object. Must be unique in the page. */
-} NVM_Object_Descriptor_t;
-
-/** A collection of object descriptors that make up a page. */
-typedef NVM_Object_Descriptor_t   NVM_Page_t[];
-
-
-/** Describes the properties of a page. */
-typedef struct
-{
-  uint8_t          pageId;     /**< A page ID used when referring to the page. Must be unique. */
-  NVM_Page_t const * page;    /**< A pointer to the list of all the objects in the page. */
-  uint8_t          pageType;   /**< The type of page, normal or wear. */
-} NVM_Page_Descriptor_t;
-
-/** The list of pages registered for use. */
-typedef NVM_Page_Descriptor_t   NVM_Page_Table_t[];
-
-/** Configuration structure. */
-typedef struct
-{ NVM_Page_Table_t const *nvmPages;  /**< Pointer to table defining NVM pages. */
-  uint8_t          const pages;      /**< Total number of physical pages. */
-  uint8_t          const userPages;  /**< Number of defined (used) pages. */
-  uint8_t          const *nvmArea;   /**< Pointer to nvm area in flash. */
-} NVM_Config_t;
-
-/** Result type for all the API functions. */
-typedef enum
-{
-  nvmResultOk           = 0, /**< Flash read/write/erase successful. */
-  nvmResultAddrInvalid  = 1, /**< Invalid address. Write to an address out of
-                              *       bounds. */
-  nvmResultInputInvalid = 2, /**< Invalid input data. */
-  nvmResultDataInvalid  = 3, /**< Invalid data. */
-  nvmResultWriteLock    = 4, /**< A write is currently in progress, and any
-                             *        concurrent operations might cause problems. */
-  nvmResultNoPages      = 5, /**< Initialization didn't find any pages. */
-  nvmResultNoPage       = 6, /**< Could not find the specified page. It
-                              *       might not have been saved yet. */
-  nvmResultErrorInitial = 7, /**< Result not changed to OK. */
-  nvmResultError        = 8  /**< General error. */
-} NVM_Result_t;
-
-/*******************************************************************************
- ***************************   PROTOTYPES   ************************************
- ******************************************************************************/
-
-NVM_Result_t NVM_Init(NVM_Config_t const *nvmConfig);
-NVM_Result_t NVM_Erase(uint32_t erasureCount);
-NVM_Result_t NVM_Write(uint16_t pageId, uint8_t objectId);
-NVM_Result_t NVM_Read(uint16_t pageId, uint8_t objectId);
-
-#ifndef NVM_FEATURE_WEARLEVELGET_ENABLED
-#define NVM_FEATURE_WEARLEVELGET_ENABLED    true
-#endif
-#if (NVM_FEATURE_WEARLEVELGET_ENABLED == true)
-uint32_t NVM_WearLevelGet(void);
-#endif
-
-/** @} (end defgroup NVM) */
-/** @} (end addtogroup EM_Drivers) */
-
-#ifdef __cplusplus
-}
-#endif
-
-#endif /* __NVM_H */
+/***************************************************************************//**
+ * @file
+ * @brief Non-Volatile Memory Manager.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ * @details
+ * This is a software manager module for non-volatile memory. It consists of
+ * nvm.c, nvm.h and nvm_hal.h. In addition to this it requires a valid nvm_hal.c.
+ * This lets the manager work with different types of memory. 
+ * Files nvm_config_template.* shows possible configuration of objects and could
+ * be used as template for customer application.
+ * C++ applications can describe their pages with the types in nvm.hpp.
+ *
+ * The module has the following public interfaces:
+ *
+ * NVM_Init()
+ * NVM_Erase()
+ * NVM_Write()
+ * NVM_Read()
+ * NVM_ReadV()
+ * NVM_WriteV()
+ * NVM_ReadPtr()
+ * NVM_ReadInto()
+ * NVM_WriteRange()
+ * NVM_CounterAdd()
+ * NVM_CounterGet()
+ * NVM_LogAppend()
+ * NVM_LogSeek()
+ * NVM_LogNext()
+ * NVM_LogRangeGet()
+ * NVM_KvSet()
+ * NVM_KvGet()
+ * NVM_KvDelete()
+ * NVM_EepromWrite()
+ * NVM_EepromRead()
+ * NVM_TxBegin()
+ * NVM_TxWrite()
+ * NVM_TxCommit()
+ * NVM_Flush()
+ * NVM_WriteBehindTick()
+ * NVM_GovernorTick()
+ * NVM_GovernorStatus()
+ * NVM_WearLevelGet()
+ * NVM_StatsGet()
+ * NVM_StatsReset()
+ *
+ * Users have to be aware of the following limitations of the module:
+ * - Object IDs from 0 to 0xfc, or 0xfffc when NVM_OBJECT_ID_SIZE is 2.
+ * - Maximum NVM_MAX_NUMBER_OF_PAGES physical pages. Page IDs are 8 bit unless
+ *   NVM_MAX_NUMBER_OF_PAGES is above 255, and then below 0x7ffe.
+ * - With NVM_FEATURE_CHECKPOINT_ENABLED the page map must fit in one flash
+ *   page, which is about 220 pages of 512 bytes.
+ *
+ *******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#ifndef __NVM_H
+#define __NVM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* needed to get CPU flash size and calculate page size */
+#include "em_device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************************************************************//**
+ * @addtogroup EM_Drivers
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup NVM
+ * @{
+ ******************************************************************************/
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+/** Certain features can be turned on and off on compile time to make the API
+* faster, save RAM and flash space. Set it to TRUE to turn the feature on.
+* Every setting below is a default, which is changed with -D. */
+
+/** Without this define the wear pages are no longer supported. */
+#ifndef NVM_FEATURE_WEAR_PAGES_ENABLED
+#define NVM_FEATURE_WEAR_PAGES_ENABLED               true
+#endif
+
+/** Include and activate the static wear leveling functionality. */
+#ifndef NVM_FEATURE_STATIC_WEAR_ENABLED
+#define NVM_FEATURE_STATIC_WEAR_ENABLED              true
+#endif
+
+/** The threshold used to decide when to do static wear leveling. Used when
+ * NVM_Config_t has got no wearPolicy. */
+#ifndef NVM_STATIC_WEAR_THRESHOLD
+#define NVM_STATIC_WEAR_THRESHOLD                    100
+#endif
+
+/** Validate data against checksums on every read operation. */
+#ifndef NVM_FEATURE_READ_VALIDATION_ENABLED
+#define NVM_FEATURE_READ_VALIDATION_ENABLED          true
+#endif
+
+/** Validate data against checksums after every write operation. */
+#ifndef NVM_FEATURE_WRITE_VALIDATION_ENABLED
+#define NVM_FEATURE_WRITE_VALIDATION_ENABLED         true
+#endif
+
+/** Include the NVM_WearLevelGet function. */
+#ifndef NVM_FEATURE_WEARLEVELGET_ENABLED
+#define NVM_FEATURE_WEARLEVELGET_ENABLED             true
+#endif
+
+/** Check if data has been updated before writing update to the NVM. */
+#ifndef NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED
+#define NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED    true
+#endif
+
+/** Only check page headers and footers in NVM_Init, and defer the checksum
+ * validation of each page until it is first read or written. */
+#ifndef NVM_FEATURE_LAZY_VALIDATION_ENABLED
+#define NVM_FEATURE_LAZY_VALIDATION_ENABLED          false
+#endif
+
+/** Include the NVM_StatsGet function and the operation counters and cycle
+ * timing behind it. When false all instrumentation is compiled out. The
+ * timing reads the DWT cycle counter, so on a core or host without it
+ * NVM_STATS_CYCLES_GET() must be defined as a clock hook, e.g. with -D. */
+#ifndef NVM_FEATURE_STATS_ENABLED
+#define NVM_FEATURE_STATS_ENABLED                    false
+#endif
+
+/** Include the NVM_ReadPtr function, which returns pointers to objects in
+ * flash instead of copying them. Requires a memory mapped NVM. */
+#ifndef NVM_FEATURE_READ_POINTER_ENABLED
+#define NVM_FEATURE_READ_POINTER_ENABLED             false
+#endif
+
+/** Include the NVM_ReadInto function, which reads part of an object into a
+ * buffer given by the caller. */
+#ifndef NVM_FEATURE_READ_INTO_ENABLED
+#define NVM_FEATURE_READ_INTO_ENABLED                false
+#endif
+
+/** Include the NVM_WriteRange function, which writes part of an object. Small
+ * changes that only clear bits are programmed in place, and recorded in a
+ * patch journal in the free space at the end of the page. */
+#ifndef NVM_FEATURE_WRITE_RANGE_ENABLED
+#define NVM_FEATURE_WRITE_RANGE_ENABLED              false
+#endif
+
+/** Let NVM_Write program a single object in place when the new value only
+ * clears bits in the stored one, instead of moving the page. Uses the same
+ * patch journal as NVM_WriteRange. */
+#ifndef NVM_FEATURE_WRITE_IN_PLACE_ENABLED
+#define NVM_FEATURE_WRITE_IN_PLACE_ENABLED           false
+#endif
+
+/** Support counter pages, which record increments by clearing bits in the
+ * free space of the page, and are only rewritten when that space is used up. */
+#ifndef NVM_FEATURE_COUNTER_PAGES_ENABLED
+#define NVM_FEATURE_COUNTER_PAGES_ENABLED            false
+#endif
+
+/** The number of increments recorded in each flash word of a counter page.
+ * Every increment programs the word once, so this must not be more than the
+ * number of writes the flash allows to a word between erases. Must be 1, 2,
+ * 4, 8, 16 or 32. */
+#ifndef NVM_COUNTER_WRITES_PER_WORD
+#define NVM_COUNTER_WRITES_PER_WORD                  32
+#endif
+
+/** Support log pages, which append records to a ring of physical pages. */
+#ifndef NVM_FEATURE_LOG_PAGES_ENABLED
+#define NVM_FEATURE_LOG_PAGES_ENABLED                false
+#endif
+
+/** The maximum number of log pages, and of physical pages in each of them.
+ * Used to size the log index in RAM. */
+#ifndef NVM_LOG_MAX_PAGES
+#define NVM_LOG_MAX_PAGES                            2
+#endif
+#ifndef NVM_LOG_MAX_SEGMENTS
+#define NVM_LOG_MAX_SEGMENTS                         8
+#endif
+
+/** Support a key-value page, which stores values of any length by key in
+ * log segments, and reclaims the space of old values by garbage collection.
+ * The page needs at least 2 segments, and NVM_Init returns nvmResultError
+ * for fewer. Requires NVM_FEATURE_LOG_PAGES_ENABLED. */
+#ifndef NVM_FEATURE_KV_ENABLED
+#define NVM_FEATURE_KV_ENABLED                       false
+#endif
+
+/** The maximum number of keys in the key-value page. Used to size the hash
+ * index in RAM. */
+#ifndef NVM_KV_MAX_KEYS
+#define NVM_KV_MAX_KEYS                              32
+#endif
+
+/** The number of records the garbage collector of the key-value page checks
+ * on each set or delete, when the page uses all its physical pages. */
+#ifndef NVM_KV_COLLECT_STEP
+#define NVM_KV_COLLECT_STEP                          2
+#endif
+
+/** Support an EEPROM page, which emulates a byte addressable EEPROM by
+ * appending the written bytes with their address to log segments. The
+ * content is kept in RAM for reads. Requires NVM_FEATURE_LOG_PAGES_ENABLED. */
+#ifndef NVM_FEATURE_EEPROM_ENABLED
+#define NVM_FEATURE_EEPROM_ENABLED                   false
+#endif
+
+/** The size of the emulated EEPROM in bytes. A copy of the content is kept
+ * in RAM, and all of it must fit in one physical page with room to spare. */
+#ifndef NVM_EEPROM_SIZE
+#define NVM_EEPROM_SIZE                              128
+#endif
+
+/** Support packed pages, which store their objects as one value in the
+ * key-value page, so that several small pages share its physical pages
+ * instead of using one each. Requires NVM_FEATURE_KV_ENABLED. */
+#ifndef NVM_FEATURE_PACKED_PAGES_ENABLED
+#define NVM_FEATURE_PACKED_PAGES_ENABLED             false
+#endif
+
+/** The largest size of all the objects of a packed page together. A buffer
+ * of this size is kept in RAM to put the value together before it is
+ * written. */
+#ifndef NVM_PACKED_PAGE_MAX_SIZE
+#define NVM_PACKED_PAGE_MAX_SIZE                     128
+#endif
+
+/** Support spanning pages, which store objects that are too big for one
+ * physical page in several. Each physical page has got its own header and
+ * checksum, and only those holding changed objects are rewritten. */
+#ifndef NVM_FEATURE_SPAN_PAGES_ENABLED
+#define NVM_FEATURE_SPAN_PAGES_ENABLED               false
+#endif
+
+/** The largest number of physical pages used by a spanning page. At most
+ * 64. */
+#ifndef NVM_SPAN_MAX_SEGMENTS
+#define NVM_SPAN_MAX_SEGMENTS                        4
+#endif
+
+/** The largest number of objects in a spanning page. The parts of the
+ * objects held by a physical page are described in RAM while it is used. */
+#ifndef NVM_SPAN_MAX_OBJECTS
+#define NVM_SPAN_MAX_OBJECTS                         16
+#endif
+
+/** Support compressed pages, whose objects are run-length encoded before
+ * they are written to one physical page, so that sparse or repetitive
+ * objects bigger than a page fit in it. The checksum covers the encoded
+ * bytes. */
+#ifndef NVM_FEATURE_COMPRESSED_PAGES_ENABLED
+#define NVM_FEATURE_COMPRESSED_PAGES_ENABLED         false
+#endif
+
+/** The largest size of all the objects of a compressed page together. A
+ * buffer of this size and one of a physical page are kept in RAM to encode
+ * and decode the objects. */
+#ifndef NVM_COMPRESSED_PAGE_MAX_SIZE
+#define NVM_COMPRESSED_PAGE_MAX_SIZE                 1024
+#endif
+
+/** Count the writes to each page, and store a normal page with a single
+ * object like a wear page while it is written often, so that new versions
+ * are appended to the physical page instead of moving it. The page is
+ * stored as a normal page again when it is no longer written often.
+ * Requires NVM_FEATURE_WEAR_PAGES_ENABLED. */
+#ifndef NVM_FEATURE_HOT_PAGES_ENABLED
+#define NVM_FEATURE_HOT_PAGES_ENABLED                false
+#endif
+
+/** The number of writes to all pages after which the write count of each
+ * page is halved, so that the counts follow the recent writes. */
+#ifndef NVM_HOT_PAGE_WINDOW
+#define NVM_HOT_PAGE_WINDOW                          64
+#endif
+
+/** A page is stored like a wear page when its write count reaches this
+ * value, and as a normal page again when the count falls below half of it.
+ * At most 255. */
+#ifndef NVM_HOT_PAGE_THRESHOLD
+#define NVM_HOT_PAGE_THRESHOLD                       16
+#endif
+
+/** Choose the empty physical page to move a page to from the recent writes
+ * to the page. A page that is seldom written, or is moved by the static wear
+ * leveling system, is moved to the most worn empty page, so that the least
+ * worn ones are used by the pages written often. The writes are counted over
+ * NVM_HOT_PAGE_WINDOW like with NVM_FEATURE_HOT_PAGES_ENABLED. */
+#ifndef NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED
+#define NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED      false
+#endif
+
+/** A page is seldom written when its write count is at most this value,
+ * once the counts have been halved at least once. At most 254. */
+#ifndef NVM_COLD_PAGE_THRESHOLD
+#define NVM_COLD_PAGE_THRESHOLD                      1
+#endif
+
+/** Hold back writes to pages marked NVM_PAGE_DEFERRABLE while the flash is
+ * erased faster than the endurance and lifetime of the wearPolicy allow. The
+ * objects stay in RAM, and the page is written in full when the erase budget
+ * allows it again, or by NVM_Flush. Time is counted by NVM_GovernorTick.
+ * With NVM_FEATURE_CHECKPOINT_ENABLED the budget is stored in the checkpoint,
+ * and NVM_Init takes the erases counted in the page headers since then from
+ * it. Otherwise, or when there is no valid checkpoint, NVM_Init starts with a
+ * full budget, so a device that restarts in a loop is not held back. */
+#ifndef NVM_FEATURE_GOVERNOR_ENABLED
+#define NVM_FEATURE_GOVERNOR_ENABLED                 false
+#endif
+
+/** Hold writes to pages marked NVM_PAGE_WRITE_BEHIND in RAM, so that writes
+ * that follow each other closely are written to flash once. The pages are
+ * written when no write has been held back for NVM_WRITE_BEHIND_DELAY, as
+ * counted by NVM_WriteBehindTick, or by NVM_Flush. Writes held back are lost
+ * if the RAM is lost before that. */
+#ifndef NVM_FEATURE_WRITE_BEHIND_ENABLED
+#define NVM_FEATURE_WRITE_BEHIND_ENABLED             false
+#endif
+
+/** Milliseconds without writes held back before the write-behind cache
+ * writes its pages. */
+#ifndef NVM_WRITE_BEHIND_DELAY
+#define NVM_WRITE_BEHIND_DELAY                       1000
+#endif
+
+/** Store the offset of each object in its descriptor, so that objects are
+ * found without adding up the sizes before them. Every page must then be
+ * defined with NVM_PAGE_LAYOUT, which works out the offsets when compiling.
+ * NVM_Init fails if an offset is not the sum of the sizes before it. */
+#ifndef NVM_FEATURE_STATIC_LAYOUT_ENABLED
+#define NVM_FEATURE_STATIC_LAYOUT_ENABLED            false
+#endif
+
+/** Support transactions, which write several pages so that either all or
+ * none of them are replaced after a power loss. */
+#ifndef NVM_FEATURE_TRANSACTIONS_ENABLED
+#define NVM_FEATURE_TRANSACTIONS_ENABLED             false
+#endif
+
+/** The maximum number of pages in a transaction. A transaction needs as many
+ * free physical pages as it has got pages, and NVM_Init only keeps one free.
+ * Give the NVM one more physical page than it needs for each page of the
+ * largest transaction after the first, or NVM_TxCommit may return
+ * nvmResultInputInvalid. */
+#ifndef NVM_TX_MAX_PAGES
+#define NVM_TX_MAX_PAGES                             4
+#endif
+
+/** Support NVM_ReadV and NVM_WriteV, which read or write a list of objects
+ * in several pages, and find and validate or relocate each page only once. */
+#ifndef NVM_FEATURE_VECTORED_ENABLED
+#define NVM_FEATURE_VECTORED_ENABLED                 false
+#endif
+
+/** Keep a checkpoint of the page map in flash, so that NVM_Init does not
+ * have to scan every page. Requires NVM_FEATURE_LAZY_VALIDATION_ENABLED.
+ * The page map of NVM_MAX_NUMBER_OF_PAGES pages is stored in one flash page,
+ * which limits it to about 220 pages of 512 bytes, and fewer with static wear
+ * leveling or the governor. Compiling stops if it does not fit. */
+#ifndef NVM_FEATURE_CHECKPOINT_ENABLED
+#define NVM_FEATURE_CHECKPOINT_ENABLED               false
+#endif
+
+/** Number of flash pages used to store page map checkpoints. */
+#define NVM_CHECKPOINT_PAGES                         2
+
+/** Maximum number of flash pages that can be used as NVM. The RAM kept for
+ * each physical page is sized from it, and page counts and IDs are 16 bit
+ * when it is above 255. At most 32767. It sizes NVM_Stats_t, so set it for
+ * every file that includes nvm.h with -D. */
+#ifndef NVM_MAX_NUMBER_OF_PAGES
+#define NVM_MAX_NUMBER_OF_PAGES                      32
+#endif
+
+/** Size of an object ID in bytes, 1 or 2. It changes NVM_Page_t, so set it
+ * for every file that includes nvm.h with -D. */
+#ifndef NVM_OBJECT_ID_SIZE
+#define NVM_OBJECT_ID_SIZE                           1
+#endif
+
+/** Calculate page size. */
+#if defined(_EFM32_GIANT_FAMILY) || defined(_EFM32_WONDER_FAMILY)
+#define NVM_PAGE_SIZE           (FLASH_SIZE < (512 * 1024) ? 2048 : 4096)
+#else
+/* _EFM32_GECKO_FAMILY || _EFM32_TINY_FAMILY */
+#define NVM_PAGE_SIZE           (512)
+#endif
+  
+#if (NVM_OBJECT_ID_SIZE == 2)
+/** All objects are written from RAM. */
+#define NVM_WRITE_ALL_CMD         0xffff
+/** All objects are copied from the old page. */
+#define NVM_WRITE_NONE_CMD        0xfffe
+/** The objects listed in a call to NVM_WriteV are written from RAM. */
+#define NVM_WRITE_VECTOR_CMD      0xfffd
+/** All objects are read to RAM. */
+#define NVM_READ_ALL_CMD          0xffff
+#else
+/** All objects are written from RAM. */
+#define NVM_WRITE_ALL_CMD         0xff
+/** All objects are copied from the old page. */
+#define NVM_WRITE_NONE_CMD        0xfe
+/** The objects listed in a call to NVM_WriteV are written from RAM. */
+#define NVM_WRITE_VECTOR_CMD      0xfd
+/** All objects are read to RAM. */
+#define NVM_READ_ALL_CMD          0xff
+#endif
+
+/** Retains the registered erase count when eraseing a page. */
+#define NVM_ERASE_RETAINCOUNT    0xffffffffUL
+
+/** Structure defining end of pages table. */
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+#define NVM_PAGE_TERMINATION    { NULL, 0, (NVM_Object_Ids) 0, 0 }
+#else
+#define NVM_PAGE_TERMINATION    { NULL, 0, (NVM_Object_Ids) 0 }
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+/** Flag of a page whose writes may be held back by the governor. */
+#define NVM_PAGE_DEFERRABLE     0x01U
+#endif
+
+#if (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+/** Flag of a page whose writes are held by the write-behind cache. */
+#define NVM_PAGE_WRITE_BEHIND   0x02U
+#endif
+
+/** Bytes available for the objects of a normal page, after the 8 byte page
+ *  header and the 4 byte footer. */
+#define NVM_PAGE_CONTENT_SIZE   (NVM_PAGE_SIZE - 12)
+
+/** Define a page from a list of objects. The list is a macro taking a macro
+ *  X and the page name P, and giving X(P, object, objectId) for each object
+ *  variable in the page:
+ *
+ *    #define NVM_FIRST_PAGE_OBJECTS(X, P) \
+ *      X(P, nvmFirstTable,     FIRST_TABL_ID) \
+ *      X(P, nvmSingleVariable, SINGL_VAR_ID)
+ *
+ *    NVM_PAGE_LAYOUT(nvmFirstPage, NVM_FIRST_PAGE_OBJECTS);
+ *
+ *  The objects are laid out as the members of a struct of byte arrays, which
+ *  has got no padding, so the compiler works out the offset of each object.
+ *  Compiling stops if the objects do not fit in a normal page. Pages of other
+ *  types are defined the same way with NVM_PAGE_LAYOUT_SIZED and the largest
+ *  size of their objects. */
+#define NVM_PAGE_LAYOUT(name, OBJECTS) \
+  NVM_PAGE_LAYOUT_SIZED(name, OBJECTS, NVM_PAGE_CONTENT_SIZE)
+
+/** Define a page from a list of objects, which must fit in maxSize bytes. */
+#define NVM_PAGE_LAYOUT_SIZED(name, OBJECTS, maxSize)                                          \
+  typedef struct { OBJECTS(NVM_LAYOUT_MEMBER, name) } name##_Layout_t;                        \
+  typedef char name##_Layout_Fits[(sizeof(name##_Layout_t) <= (maxSize)) ? 1 : -1];           \
+  NVM_Page_t const name = { OBJECTS(NVM_LAYOUT_OBJECT, name) NVM_PAGE_TERMINATION }
+
+/** Size of the objects of a page defined with NVM_PAGE_LAYOUT. */
+#define NVM_PAGE_LAYOUT_SIZE(name)    sizeof(name##_Layout_t)
+
+/** Member of the struct describing the layout of a page. */
+#define NVM_LAYOUT_MEMBER(name, object, objectId)   uint8_t object[sizeof(object)];
+
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+/** Object descriptor with the offset of the object in the layout of a page. */
+#define NVM_LAYOUT_OBJECT(name, object, objectId)   \
+  { (uint8_t *) &(object), sizeof(object), (objectId), (uint16_t) offsetof(name##_Layout_t, object) },
+#else
+/** Object descriptor of an object in the layout of a page. */
+#define NVM_LAYOUT_OBJECT(name, object, objectId)   \
+  { (uint8_t *) &(object), sizeof(object), (objectId) },
+#endif
+
+/** @endcond */
+
+/*******************************************************************************
+ ******************************   TYPEDEFS   ***********************************
+ ******************************************************************************/
+
+#if (NVM_OBJECT_ID_SIZE == 2)
+/** Identifier of an object in a page. */
+typedef uint16_t NVM_Object_Id_t;
+#else
+/** Identifier of an object in a page. */
+typedef uint8_t NVM_Object_Id_t;
+#endif
+
+#if (NVM_MAX_NUMBER_OF_PAGES > 255)
+/** Identifier of a page, or a number of pages. */
+typedef uint16_t NVM_Page_Id_t;
+#else
+/** Identifier of a page, or a number of pages. */
+typedef uint8_t NVM_Page_Id_t;
+#endif
+
+/** Enum describing the type of logical page we have; normal, wear, counter, log, key-value, EEPROM, packed, spanning or compressed. */
+typedef enum
+{
+  nvmPageTypeNormal     = 0, /**< Normal page, always rewrite. */
+  nvmPageTypeWear       = 1, /**< Wear page. Can be used several times before rewrite. */
+  nvmPageTypeCounter    = 2, /**< Counter page. Holds a single uint32_t object, and records increments without rewrite. */
+  nvmPageTypeLog        = 3, /**< Log page. Records are appended to several physical pages, and the oldest is erased when they are full. */
+  nvmPageTypeKv         = 4, /**< Key-value page. Values are appended to several physical pages, and old values are garbage collected. */
+  nvmPageTypeEeprom     = 5, /**< EEPROM page. Written bytes are appended to several physical pages, and the content is compacted into a new one when they are full. */
+  nvmPageTypePacked     = 6, /**< Packed page. The objects are stored as one value in the key-value page, which several packed pages share. */
+  nvmPageTypeSpan       = 7, /**< Spanning page. The objects are stored in several physical pages, and only those holding changed objects are rewritten. */
+  nvmPageTypeCompressed = 8  /**< Compressed page. The objects are run-length encoded, and the encoded bytes are stored in one physical page. */
+} NVM_Page_Type_t;
+
+/** Describes the properties of an object in a page. */
+typedef struct
+{
+  uint8_t         * location; /**< A pointer to the location of the object in RAM. NULL if the object is only accessed with NVM_ReadInto, NVM_ReadPtr or NVM_WriteRange. */
+  uint16_t        size;       /**< The size of the object in bytes. */
+  NVM_Object_Id_t objectId;   /**< An object ID used to reference the object. Must be unique in the page. */
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+  uint16_t        offset;     /**< Offset of the object from the start of the objects of the page. Set by NVM_PAGE_LAYOUT. */
+#endif
+} NVM_Object_Descriptor_t;
+
+/** A collection of object descriptors that make up a page. */
+typedef NVM_Object_Descriptor_t   NVM_Page_t[];
+
+
+/** Describes the properties of a page. */
+typedef struct
+{
+  NVM_Page_Id_t    pageId;     /**< A page ID used when referring to the page. Must be unique. */
+  NVM_Page_t const * page;    /**< A pointer to the list of all the objects in the page. NULL for log, key-value and EEPROM pages. */
+  uint8_t          pageType;   /**< The type of page, normal or wear. */
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  uint8_t          segments;   /**< Number of physical pages used by a log, key-value or EEPROM page, at least 2 for a log or key-value page and 1 for an EEPROM page. Key-value and EEPROM pages use one more while reclaiming space. Not used by other page types. */
+#endif
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true) || (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+  uint8_t          flags;      /**< NVM_PAGE_DEFERRABLE and NVM_PAGE_WRITE_BEHIND, or 0. Only used for normal and wear pages. */
+#endif
+} NVM_Page_Descriptor_t;
+
+/** The list of pages registered for use. */
+typedef NVM_Page_Descriptor_t   NVM_Page_Table_t[];
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true) || (NVM_FEATURE_GOVERNOR_ENABLED == true)
+/** Wear leveling policy, chosen at run time. */
+typedef struct
+{
+  uint16_t staticWearThreshold; /**< Erases per page rewritten before the pages not rewritten are moved, like NVM_STATIC_WEAR_THRESHOLD. 0 turns static wear leveling off. */
+  uint16_t relocationBudget;    /**< Largest number of pages moved by the static wear leveler in one operation, or 0 for no limit. The rest are moved by later operations. */
+  uint32_t minimumSpread;       /**< Smallest difference between the highest and the lowest erase count of the physical pages before pages are moved, or 0. */
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  uint32_t endurance;           /**< Erase cycles each physical page is rated for. */
+  uint32_t lifetime;            /**< Target lifetime in seconds, as counted by NVM_GovernorTick. 0 turns the governor off. */
+  uint16_t burst;               /**< Erases allowed at once before writes are held back. */
+#endif
+} NVM_Wear_Policy_t;
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+/** Status of the governor, returned by NVM_GovernorStatus(). */
+typedef struct
+{
+  bool     throttled;      /**< Set while writes to deferrable pages are held back. */
+  uint16_t pendingPages;   /**< Pages with writes held back. */
+  uint32_t deferredWrites; /**< Writes held back since NVM_Init. */
+  uint32_t erases;         /**< Erases since NVM_Init. */
+} NVM_Governor_Status_t;
+#endif
+#endif
+
+/** Configuration structure. */
+typedef struct
+{ NVM_Page_Table_t const *nvmPages;  /**< Pointer to table defining NVM pages. */
+  NVM_Page_Id_t    const pages;      /**< Total number of physical pages. */
+  NVM_Page_Id_t    const userPages;  /**< Number of defined (used) pages. */
+  uint8_t          const *nvmArea;   /**< Pointer to nvm area in flash. */
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  uint8_t          const *checkpointArea; /**< Pointer to NVM_CHECKPOINT_PAGES pages in flash for page map checkpoints, or NULL. */
+#endif
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true) || (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  NVM_Wear_Policy_t const *wearPolicy; /**< Pointer to the wear leveling policy, or NULL for NVM_STATIC_WEAR_THRESHOLD with no budget or spread, and no governor. */
+#endif
+} NVM_Config_t;
+
+/** API functions timed by the statistics module. */
+typedef enum
+{
+  nvmStatsApiInit        =  0, /**< NVM_Init(). */
+  nvmStatsApiErase       =  1, /**< NVM_Erase(). */
+  nvmStatsApiWrite       =  2, /**< NVM_Write(). */
+  nvmStatsApiRead        =  3, /**< NVM_Read(). */
+  nvmStatsApiReadV       =  4, /**< NVM_ReadV(). */
+  nvmStatsApiWriteV      =  5, /**< NVM_WriteV(). */
+  nvmStatsApiReadPtr     =  6, /**< NVM_ReadPtr(). */
+  nvmStatsApiReadInto    =  7, /**< NVM_ReadInto(). */
+  nvmStatsApiWriteRange  =  8, /**< NVM_WriteRange(). */
+  nvmStatsApiCounterAdd  =  9, /**< NVM_CounterAdd(). */
+  nvmStatsApiCounterGet  = 10, /**< NVM_CounterGet(). */
+  nvmStatsApiLogAppend   = 11, /**< NVM_LogAppend(). */
+  nvmStatsApiLogSeek     = 12, /**< NVM_LogSeek(). */
+  nvmStatsApiLogNext     = 13, /**< NVM_LogNext(). */
+  nvmStatsApiLogRangeGet = 14, /**< NVM_LogRangeGet(). */
+  nvmStatsApiKvSet       = 15, /**< NVM_KvSet(). */
+  nvmStatsApiKvGet       = 16, /**< NVM_KvGet(). */
+  nvmStatsApiKvDelete    = 17, /**< NVM_KvDelete(). */
+  nvmStatsApiEepromWrite = 18, /**< NVM_EepromWrite(). */
+  nvmStatsApiEepromRead  = 19, /**< NVM_EepromRead(). */
+  nvmStatsApiTxBegin     = 20, /**< NVM_TxBegin(). */
+  nvmStatsApiTxWrite     = 21, /**< NVM_TxWrite(). */
+  nvmStatsApiTxCommit    = 22, /**< NVM_TxCommit(). */
+  nvmStatsApiCount       = 23  /**< Number of timed API functions. */
+} NVM_Stats_Api_t;
+
+/** Cycle count statistics for one API function. */
+typedef struct
+{
+  uint32_t calls; /**< Number of calls recorded. */
+  uint32_t min;   /**< Fewest cycles spent in one call. */
+  uint32_t max;   /**< Most cycles spent in one call. */
+  uint32_t avg;   /**< Average cycles spent per call. */
+} NVM_Stats_Timing_t;
+
+/** Run time statistics returned by NVM_StatsGet(). */
+typedef struct
+{
+  uint32_t           reads;              /**< Successful NVM_Read calls. */
+  uint32_t           writesSkipped;      /**< Writes skipped because the data was unchanged. */
+  uint32_t           wearSlotAppends;    /**< Objects appended to a free slot in a wear page. */
+  uint32_t           pageRelocations;    /**< Pages rewritten to a new physical page. */
+  uint32_t           inPlaceWrites;      /**< Ranges programmed in place without relocating the page. */
+  uint32_t           counterAdds;        /**< Counter increments recorded without relocating the page. */
+  uint32_t           logAppends;         /**< Records appended to log pages. */
+  uint32_t           kvWrites;           /**< Values set or deleted in the key-value page. */
+  uint32_t           kvMoves;            /**< Values moved by the garbage collector of the key-value page. */
+  uint32_t           eepromWrites;       /**< Writes appended to the EEPROM page. */
+  uint32_t           eepromCompactions;  /**< Times the content of the EEPROM page was compacted into a new physical page. */
+  uint32_t           txCommits;          /**< Transactions committed. */
+  uint32_t           pageErases;         /**< Physical page erase operations. */
+  uint32_t           staticWearMoves;    /**< Pages moved by the static wear leveler. */
+  uint32_t           hotPromotions;      /**< Normal pages stored like wear pages because they were written often. */
+  uint32_t           hotDemotions;       /**< Such pages stored as normal pages again. */
+  uint32_t           coldAllocations;    /**< Pages moved to the most worn empty page because they were seldom written. */
+  uint32_t           writesCoalesced;    /**< Writes held in RAM by the write-behind cache. */
+  uint32_t           validationFailures; /**< Pages that failed validation. */
+  NVM_Stats_Timing_t timing[nvmStatsApiCount];           /**< Cycle counts per API, indexed by NVM_Stats_Api_t. */
+  uint32_t           eraseCount[NVM_MAX_NUMBER_OF_PAGES]; /**< Erase count of each physical page, from the page header. */
+} NVM_Stats_t;
+
+/** Result type for all the API functions. */
+typedef enum
+{
+  nvmResultOk           = 0, /**< Flash read/write/erase successful. */
+  nvmResultAddrInvalid  = 1, /**< Invalid address. Write to an address out of
+                              *       bounds. */
+  nvmResultInputInvalid = 2, /**< Invalid input data. */
+  nvmResultDataInvalid  = 3, /**< Invalid data. */
+  nvmResultWriteLock    = 4, /**< A write is currently in progress, and any
+                             *        concurrent operations might cause problems. */
+  nvmResultNoPages      = 5, /**< Initialization didn't find any pages. */
+  nvmResultNoPage       = 6, /**< Could not find the specified page. It
+                              *       might not have been saved yet. */
+  nvmResultErrorInitial = 7, /**< Result not changed to OK. */
+  nvmResultError        = 8  /**< General error. */
+} NVM_Result_t;
+
+#if (NVM_FEATURE_VECTORED_ENABLED == true)
+/** An object in a page, used in the lists given to NVM_ReadV and NVM_WriteV. */
+typedef struct
+{
+  uint16_t        pageId;   /**< The page of the object. */
+  NVM_Object_Id_t objectId; /**< The object, or NVM_READ_ALL / NVM_WRITE_ALL for the entire page. */
+} NVM_Object_Ref_t;
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+/** Position in a log page, used to read the records in order. Set up with
+ *  NVM_LogSeek, and moved to the next record by NVM_LogNext. */
+typedef struct
+{
+  uint16_t pageId;   /**< The log page. */
+  uint32_t sequence; /**< Sequence number of the record returned by the next call to NVM_LogNext. */
+  uint16_t page;     /**< Physical page of the record. */
+  uint16_t offset;   /**< Offset of the record in the physical page. */
+} NVM_Log_Iterator_t;
+#endif
+
+/*******************************************************************************
+ ***************************   PROTOTYPES   ************************************
+ ******************************************************************************/
+
+NVM_Result_t NVM_Init(NVM_Config_t const *nvmConfig);
+NVM_Result_t NVM_Erase(uint32_t erasureCount);
+NVM_Result_t NVM_Write(uint16_t pageId, NVM_Object_Id_t objectId);
+NVM_Result_t NVM_Read(uint16_t pageId, NVM_Object_Id_t objectId);
+
+#if (NVM_FEATURE_VECTORED_ENABLED == true)
+NVM_Result_t NVM_ReadV(NVM_Object_Ref_t const *pRefs, uint16_t count);
+NVM_Result_t NVM_WriteV(NVM_Object_Ref_t const *pRefs, uint16_t count);
+#endif
+
+#if (NVM_FEATURE_READ_POINTER_ENABLED == true)
+NVM_Result_t NVM_ReadPtr(uint16_t pageId, NVM_Object_Id_t objectId, void const **ptr, uint16_t *len);
+#endif
+
+#if (NVM_FEATURE_READ_INTO_ENABLED == true)
+NVM_Result_t NVM_ReadInto(uint16_t pageId, NVM_Object_Id_t objectId, uint16_t offset, uint16_t len, void *buf);
+#endif
+
+#if (NVM_FEATURE_WRITE_RANGE_ENABLED == true)
+NVM_Result_t NVM_WriteRange(uint16_t pageId, NVM_Object_Id_t objectId, uint16_t offset, uint16_t len, void const *src);
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+NVM_Result_t NVM_CounterAdd(uint16_t pageId, uint32_t count);
+NVM_Result_t NVM_CounterGet(uint16_t pageId, uint32_t *pValue);
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+NVM_Result_t NVM_LogAppend(uint16_t pageId, void const *pData, uint16_t len, uint32_t *pSequence);
+NVM_Result_t NVM_LogSeek(uint16_t pageId, uint32_t sequence, NVM_Log_Iterator_t *pIterator);
+NVM_Result_t NVM_LogNext(NVM_Log_Iterator_t *pIterator, void *pBuffer, uint16_t size, uint16_t *pLen);
+NVM_Result_t NVM_LogRangeGet(uint16_t pageId, uint32_t *pFirst, uint32_t *pNext);
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+NVM_Result_t NVM_KvSet(uint16_t key, void const *pData, uint16_t len);
+NVM_Result_t NVM_KvGet(uint16_t key, void *pBuffer, uint16_t size, uint16_t *pLen);
+NVM_Result_t NVM_KvDelete(uint16_t key);
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+NVM_Result_t NVM_EepromWrite(uint16_t address, void const *pData, uint16_t len);
+NVM_Result_t NVM_EepromRead(uint16_t address, void *pBuffer, uint16_t len);
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+NVM_Result_t NVM_TxBegin(void);
+NVM_Result_t NVM_TxWrite(uint16_t pageId, NVM_Object_Id_t objectId);
+NVM_Result_t NVM_TxCommit(void);
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+NVM_Result_t NVM_GovernorTick(uint32_t seconds);
+NVM_Result_t NVM_GovernorStatus(NVM_Governor_Status_t *pStatus);
+#endif
+
+#if (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+NVM_Result_t NVM_WriteBehindTick(uint32_t milliseconds);
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true) || (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+NVM_Result_t NVM_Flush(void);
+#endif
+
+#if (NVM_FEATURE_WEARLEVELGET_ENABLED == true)
+uint32_t NVM_WearLevelGet(void);
+#endif
+
+#if (NVM_FEATURE_STATS_ENABLED == true)
+void NVM_StatsGet(NVM_Stats_t *stats);
+void NVM_StatsReset(void);
+#endif
+
+/** @} (end defgroup NVM) */
+/** @} (end addtogroup EM_Drivers) */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NVM_H */
@@ -0,0 +1,397 @@
+/***************************************************************************//**
+ * @file
+ * @brief Non-Volatile Memory Manager C++ interface.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ * @details
+ * Header only C++ interface to the NVM manager in nvm.h. Pages are described
+ * by their types, and the object tables of nvm.h are generated from them:
+ *
+ *   typedef nvm::Object<SETTINGS_ID, Settings> SettingsObject;
+ *   typedef nvm::Object<COUNT_ID, uint32_t>    CountObject;
+ *   typedef nvm::Page<FIRST_PAGE_ID, nvmPageTypeNormal,
+ *                     SettingsObject, CountObject> FirstPage;
+ *   typedef nvm::PageTable<FirstPage>              Pages;
+ *
+ *   NVM_Config_t const config =
+ *   { Pages::table(), NVM_PAGES + NVM_PAGES_SCRATCH, Pages::count,
+ *     (uint8_t *) NVM_START_LOCATION };
+ *
+ *   FirstPage::write<CountObject>(42);
+ *
+ * The offset and size of every object, and the fit of every page, are worked
+ * out when compiling, and errors stop the compilation. The calls are inline
+ * and go directly to the C functions. The RAM copy of each object is kept by
+ * the page, and is given by Page::ram.
+ *
+ * The tables hold the addresses of the RAM copies, and are initialized
+ * when compiling, so they are placed in read-only memory and need no set up
+ * at start-up.
+ *
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#ifndef __NVM_HPP
+#define __NVM_HPP
+
+#include <stdint.h>
+#include <type_traits>
+#include "nvm.h"
+
+/***************************************************************************//**
+ * @addtogroup EM_Drivers
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup NVM
+ * @{
+ ******************************************************************************/
+
+namespace nvm
+{
+
+/*******************************************************************************
+ ******************************   TYPEDEFS   ***********************************
+ ******************************************************************************/
+
+/** An object of type T, referred to by the object ID Id. T is copied to and
+ *  from flash as bytes, so it must be trivially copyable. */
+template <NVM_Object_Id_t Id, typename T>
+struct Object
+{
+  static_assert(std::is_trivially_copyable<T>::value, "NVM objects are stored as bytes.");
+  static_assert(sizeof(T) <= 0xffffU, "NVM objects are at most 65535 bytes.");
+  static_assert((Id != NVM_WRITE_ALL_CMD) && (Id != NVM_WRITE_NONE_CMD) && (Id != NVM_WRITE_VECTOR_CMD),
+                "The object ID is reserved.");
+
+  /** Type of the object in RAM. */
+  typedef T type;
+
+  /** Identifier of the object. */
+  static constexpr NVM_Object_Id_t id = Id;
+
+  /** Size of the object in bytes. */
+  static constexpr uint16_t size = (uint16_t) sizeof(T);
+};
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+namespace detail
+{
+  /* Total size of the objects. */
+  template <typename... Objects>
+  struct SizeOf
+  {
+    static constexpr uint32_t value = 0;
+  };
+
+  template <typename First, typename... Rest>
+  struct SizeOf<First, Rest...>
+  {
+    static constexpr uint32_t value = First::size + SizeOf<Rest...>::value;
+  };
+
+  /* Offset of the object from the start of the objects. Only defined if the
+   * object is in the list. */
+  template <typename Wanted, typename... Objects>
+  struct OffsetOf;
+
+  template <typename Wanted, typename... Rest>
+  struct OffsetOf<Wanted, Wanted, Rest...>
+  {
+    static constexpr uint16_t value = 0;
+  };
+
+  template <typename Wanted, typename First, typename... Rest>
+  struct OffsetOf<Wanted, First, Rest...>
+  {
+    static constexpr uint16_t value = First::size + OffsetOf<Wanted, Rest...>::value;
+  };
+
+  /* Set if the object is in the list. */
+  template <typename Wanted, typename... Objects>
+  struct Contains : std::false_type
+  {
+  };
+
+  template <typename Wanted, typename First, typename... Rest>
+  struct Contains<Wanted, First, Rest...>
+    : std::integral_constant<bool, std::is_same<Wanted, First>::value || Contains<Wanted, Rest...>::value>
+  {
+  };
+
+  /* Set if one of the other items has got the same ID as the item. */
+  template <typename Item, typename... Others>
+  struct SameId : std::false_type
+  {
+  };
+
+  template <typename Item, typename First, typename... Rest>
+  struct SameId<Item, First, Rest...>
+    : std::integral_constant<bool, (Item::id == First::id) || SameId<Item, Rest...>::value>
+  {
+  };
+
+  /* Set if no two of the items have got the same ID. */
+  template <typename... Items>
+  struct UniqueIds : std::true_type
+  {
+  };
+
+  template <typename First, typename... Rest>
+  struct UniqueIds<First, Rest...>
+    : std::integral_constant<bool, !SameId<First, Rest...>::value && UniqueIds<Rest...>::value>
+  {
+  };
+
+  /* Largest size of the objects of a page of the given type. */
+  constexpr uint32_t MaxSize(NVM_Page_Type_t type)
+  {
+    return (nvmPageTypeNormal == type) ? NVM_PAGE_CONTENT_SIZE
+           /* A wear page needs room for at least one copy and its checksum. */
+           : (nvmPageTypeWear == type) ? (NVM_PAGE_CONTENT_SIZE + 2U)
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+           : (nvmPageTypeCounter == type) ? sizeof(uint32_t)
+#endif
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+           : (nvmPageTypePacked == type) ? NVM_PACKED_PAGE_MAX_SIZE
+#endif
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+           : (nvmPageTypeSpan == type) ? (NVM_SPAN_MAX_SEGMENTS * NVM_PAGE_CONTENT_SIZE)
+#endif
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+           : (nvmPageTypeCompressed == type) ? NVM_COMPRESSED_PAGE_MAX_SIZE
+#endif
+           : 0U;
+  }
+
+  /* The RAM copy of an object in a page. The object is read and written by
+   * nvm.h as the bytes overlaying it, whose address is a constant expression
+   * and can be put in the object table. */
+  template <uint16_t PageId, typename Object>
+  struct Storage
+  {
+    union Cell
+    {
+      constexpr Cell() : value() {}
+
+      typename Object::type value;
+      uint8_t               bytes[Object::size];
+    };
+
+    static Cell cell;
+  };
+
+  template <uint16_t PageId, typename Object>
+  typename Storage<PageId, Object>::Cell Storage<PageId, Object>::cell;
+}
+
+/* The page descriptor of the page type P, as an aggregate of constants. The
+ * object table is cast to the array of unknown bound used by nvm.h, which
+ * C++ only allows as a reinterpret_cast before C++20. Written out in the
+ * initializer it is still an address constant, so the page table is
+ * initialized when compiling and not by a constructor at start-up, as it
+ * would be from a call to Page::descriptor(). */
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+#define NVM_HPP_SEGMENTS_INIT   , 0
+#else
+#define NVM_HPP_SEGMENTS_INIT
+#endif
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true) || (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+#define NVM_HPP_FLAGS_INIT      , 0
+#else
+#define NVM_HPP_FLAGS_INIT
+#endif
+#define NVM_HPP_PAGE_DESCRIPTOR(P)                                                \
+  NVM_Page_Descriptor_t { (NVM_Page_Id_t) P::id,                                  \
+                          reinterpret_cast<NVM_Page_t const *>(&P::table),        \
+                          (uint8_t) P::type NVM_HPP_SEGMENTS_INIT NVM_HPP_FLAGS_INIT }
+/** @endcond */
+
+/** A page with the ID Id and the type Type, holding the objects in the order
+ *  they are given. */
+template <uint16_t Id, NVM_Page_Type_t Type, typename... Objects>
+class Page
+{
+public:
+  static_assert(sizeof...(Objects) > 0, "A page must hold an object.");
+  static_assert(detail::UniqueIds<Objects...>::value, "The object IDs of a page must be unique.");
+  static_assert(detail::SizeOf<Objects...>::value <= detail::MaxSize(Type),
+                "The objects do not fit in the page, or the page type has got no objects.");
+  static_assert(((nvmPageTypeWear != Type) && (nvmPageTypeCounter != Type)) || (sizeof...(Objects) == 1),
+                "Wear and counter pages hold a single object.");
+#if (NVM_MAX_NUMBER_OF_PAGES > 255)
+  static_assert(Id < 0x7ffeU, "The page ID is reserved.");
+#else
+  static_assert(Id <= 0xffU, "The page ID is larger than NVM_Page_Id_t.");
+#endif
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+  static_assert((nvmPageTypeSpan != Type) || (Id <= 0xffU),
+                "The ID of a spanning page must fit in 8 bits, as its segments are stored with the segment in the bits above.");
+#endif
+
+  /** Identifier of the page. */
+  static constexpr uint16_t id = Id;
+
+  /** Type of the page. */
+  static constexpr NVM_Page_Type_t type = Type;
+
+  /** Size of all the objects of the page in bytes. */
+  static constexpr uint32_t size = detail::SizeOf<Objects...>::value;
+
+  /** Offset of an object from the start of the objects of the page. */
+  template <typename Object>
+  static constexpr uint16_t offset()
+  {
+    return detail::OffsetOf<Object, Objects...>::value;
+  }
+
+  /** The object table of the page, as used by nvm.h. */
+  static NVM_Page_t const *objects()
+  {
+    return reinterpret_cast<NVM_Page_t const *>(&table);
+  }
+
+  /** The page descriptor of the page, as used in the page table of nvm.h. */
+  static NVM_Page_Descriptor_t descriptor()
+  {
+    return NVM_HPP_PAGE_DESCRIPTOR(Page);
+  }
+
+  /** The RAM copy of an object, which is read and written by the page. */
+  template <typename Object>
+  static typename Object::type &ram()
+  {
+    static_assert(detail::Contains<Object, Objects...>::value, "The object is not in the page.");
+    return detail::Storage<Id, Object>::cell.value;
+  }
+
+  /** Read an object from flash to its RAM copy. */
+  template <typename Object>
+  static NVM_Result_t read()
+  {
+    static_assert(detail::Contains<Object, Objects...>::value, "The object is not in the page.");
+    return NVM_Read(Id, Object::id);
+  }
+
+  /** Read an object from flash, and copy it to value if it was read. */
+  template <typename Object>
+  static NVM_Result_t read(typename Object::type &value)
+  {
+    NVM_Result_t result = read<Object>();
+    if (nvmResultOk == result)
+    {
+      value = ram<Object>();
+    }
+    return result;
+  }
+
+  /** Write the RAM copy of an object to flash. */
+  template <typename Object>
+  static NVM_Result_t write()
+  {
+    static_assert(detail::Contains<Object, Objects...>::value, "The object is not in the page.");
+    return NVM_Write(Id, Object::id);
+  }
+
+  /** Set the RAM copy of an object to value, and write it to flash. */
+  template <typename Object>
+  static NVM_Result_t write(typename Object::type const &value)
+  {
+    ram<Object>() = value;
+    return write<Object>();
+  }
+
+  /** Read all the objects from flash to their RAM copies. */
+  static NVM_Result_t readAll()
+  {
+    return NVM_Read(Id, NVM_READ_ALL_CMD);
+  }
+
+  /** Write the RAM copies of all the objects to flash. */
+  static NVM_Result_t writeAll()
+  {
+    return NVM_Write(Id, NVM_WRITE_ALL_CMD);
+  }
+
+private:
+  template <typename... Pages>
+  friend class PageTable;
+
+  static NVM_Object_Descriptor_t const table[sizeof...(Objects) + 1];
+};
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+template <uint16_t Id, NVM_Page_Type_t Type, typename... Objects>
+constexpr NVM_Object_Descriptor_t Page<Id, Type, Objects...>::table[sizeof...(Objects) + 1] =
+{
+  { detail::Storage<Id, Objects>::cell.bytes, Objects::size, Objects::id
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+    , detail::OffsetOf<Objects, Objects...>::value
+#endif
+  }...,
+  NVM_Object_Descriptor_t() /* Null termination of table. */
+};
+/** @endcond */
+
+/** The page table of the given pages, used for the nvmPages and userPages of
+ *  NVM_Config_t. */
+template <typename... Pages>
+class PageTable
+{
+public:
+  static_assert(detail::UniqueIds<Pages...>::value, "The page IDs must be unique.");
+  static_assert(sizeof...(Pages) <= NVM_MAX_NUMBER_OF_PAGES, "There are more pages than NVM_MAX_NUMBER_OF_PAGES.");
+
+  /** Number of pages in the table. */
+  static constexpr NVM_Page_Id_t count = (NVM_Page_Id_t) sizeof...(Pages);
+
+  /** The page table. */
+  static NVM_Page_Table_t const *table()
+  {
+    return reinterpret_cast<NVM_Page_Table_t const *>(&pages);
+  }
+
+private:
+  static NVM_Page_Descriptor_t const pages[sizeof...(Pages)];
+};
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+template <typename... Pages>
+NVM_Page_Descriptor_t const PageTable<Pages...>::pages[sizeof...(Pages)] =
+{
+  NVM_HPP_PAGE_DESCRIPTOR(Pages)...
+};
+/** @endcond */
+
+} /* namespace nvm */
+
+/** @} (end addtogroup NVM) */
+/** @} (end addtogroup EM_Drivers) */
+
+#endif /* __NVM_HPP */
@@ -1,1580 +1,9675 @@
-/***************************************************************************//**
- * @file
- * @brief Non-Volatile Memory Driver.
- * @author Energy Micro AS
- * @version 3.20.0
- * @details
- * This is a software manager module for non-volatile memory. It consists of
- * nvm.c, nvm.h and nvm_hal.h. In addition to this it requires a valid nvm_hal.c.
- * This lets the manager work with different types of memory. 
- * Files nvm_config_template.* shows possible configuration of objects and could
- * be used as template for customer application.
- *
- * The module has the following public interfaces:
- *
- * NVM_Erase()
- * NVM_Init()
- * NVM_Read()
- * NVM_WearLevel()
- * NVM_Write()
- *
- * Users have to be aware of the following limitations of the module:
- * - Maximum 254 objects in a page and 256 pages (limited by uint8_t).
- *
- *******************************************************************************
- * @section License
- * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
- *******************************************************************************
- *
- * Permission is granted to anyone to use this software for any purpose,
- * including commercial applications, and to alter it and redistribute it
- * freely, subject to the following restrictions:
- *
- * 1. The origin of this software must not be misrepresented; you must not
- *    claim that you wrote the original software.
- * 2. Altered source versions must be plainly marked as such, and must not be
- *    misrepresented as being the original software.
- * 3. This notice may not be removed or altered from any source distribution.
- * 4. The source and compiled code may only be used on Energy Micro "EFM32"
- *    microcontrollers and "EFR4" radios.
- *
- * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
- * obligation to support this Software. Energy Micro AS is providing the
- * Software "AS IS", with no express or implied warranties of any kind,
- * including, but not limited to, any implied warranties of merchantability
- * or fitness for any particular purpose or warranties against infringement
- * of any proprietary rights of a third party.
- *
- * Energy Micro AS will not be liable for any consequential, incidental, or
- * special damages, or any other relief, or for any claim by any third party,
- * arising from your use of this Software.
- *
- *****************************************************************************/
-#include <stdbool.h>
-#include "nvm.h"
-#include "nvm_hal.h"
-
-/***************************************************************************//**
- * @addtogroup EM_Drivers
- * @{
- ******************************************************************************/
-
-/***************************************************************************//**
- * @addtogroup NVM
- * @{
- ******************************************************************************/
-
-/*******************************************************************************
- *******************************   DEFINES   ***********************************
- ******************************************************************************/
-
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
-
-/** Version constant of the NVM system. Is stored together with the datablocks
- * so that it is easy to upgrade between different versions of the system. */
-#define NVM_VERSION              0x2U
-
-/* Sizes. Internal sizes of different objects */
-#define NVM_CONTENT_SIZE         (NVM_PAGE_SIZE - (NVM_HEADER_SIZE + NVM_FOOTER_SIZE))
-#define NVM_WEAR_CONTENT_SIZE    (NVM_PAGE_SIZE - NVM_HEADER_SIZE)
-
-/* Generic constants. Clears up the code and make it more readable. */
-#define NVM_PAGE_EMPTY_VALUE                   0xffffU
-#define NVM_NO_PAGE_RETURNED                   0xffffffffUL
-#define NVM_NO_WRITE_16BIT                     0xffffU
-#define NVM_NO_WRITE_32BIT                     0xffffffffUL
-#define NVM_HIGHEST_32BIT                      0xffffffffUL
-#define NVM_FLIP_FIRST_BIT_OF_32_WHEN_WRITE    0xffff7fffUL
-#define NVM_FIRST_BIT_ONE                      0x8000U
-#define NVM_FIRST_BIT_ZERO                     0x7fffU
-#define NVM_LAST_BIT_ZERO                      0xfffeU
-
-#define NVM_CHECKSUM_INITIAL                   0xffffU
-#define NVM_CHECKSUM_LENGTH                    2U
-
-#define NVM_PAGES_PER_WEAR_HISTORY             8U
-
-/* Macros for acquiring and releasing write lock. Currently empty but could be redefined */
-/* in RTOSes to add resources protection. Without it, it is not smart to call NVM module */
-/* from interrupts or other tasks without ensuring that it is not used by main thread.   */
-#ifndef NVM_ACQUIRE_WRITE_LOCK
-#define NVM_ACQUIRE_WRITE_LOCK
-#endif
-
-#ifndef NVM_RELEASE_WRITE_LOCK
-#define NVM_RELEASE_WRITE_LOCK
-#endif
-
-/** @endcond */
-
-/*******************************************************************************
- ******************************   TYPEDEFS   ***********************************
- ******************************************************************************/
-
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
-/** Result types for the internal page validation function. */
-typedef enum
-{
-  nvmValidateResultOk       = 0, /**< Page validates. */
-  nvmValidateResultOkMarked = 1, /**< Page validates, but is marked for copying. */
-  nvmValidateResultOld      = 2, /**< Page has got an older version number. */
-  nvmValidateResultError    = 3  /**< Page does not validate. */
-} NVM_ValidateResult_t;
-
-/** A struct representing the header of each page stored in NVM. This is a
- *  packed struct that is stored and retrieved from NVM directly. */
-typedef struct
-{
-  uint16_t watermark; /**< The watermark is made up of a update flag (1st bit) and the logical address of the page.  */
-  uint32_t updateId;  /**< The update id is the update id of this physical location in memory and sticks with it. */
-  uint16_t version;   /**< The version number of the API is also stored in the page for any future updates. */
-} NVM_Page_Header_t;
-
-/** size of page header on flash (not in RAM) */
-#define NVM_HEADER_SIZE          (2*sizeof(uint16_t)+sizeof(uint32_t))
-
-/** A struct representing the footer of each page stored in NVM. This is a
- *  packed struct that is stored and retrieved from NVM directly. */
-typedef struct
-{
-  uint16_t checksum;  /**< Contains a 16 bit XOR checksum of the content of the page. */
-  uint16_t watermark; /**< Contains the same watermark as the opening of the page, but with the update bit always set to high.*/
-} NVM_Page_Footer_t;
-
-/** size of page footer on flash (not in RAM) */
-#define NVM_FOOTER_SIZE          (2*sizeof(uint16_t))
-
-/** @endcond */
-
-/*******************************************************************************
- *******************************   STATICS   ***********************************
- ******************************************************************************/
-
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
-/** Result types for the internal page validation function. */
-
-static NVM_Config_t const *nvmConfig;
-
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-/* Static wear leveling */
-
-/* Bit list that records which pages have been rewritten.
- * The array contains number of pages divided by 8 bits in a byte. */
-static uint8_t nvmStaticWearWriteHistory[(NVM_MAX_NUMBER_OF_PAGES+(NVM_PAGES_PER_WEAR_HISTORY-1))/NVM_PAGES_PER_WEAR_HISTORY];
-
-/* Number of different page writes recorded in history. */
-static uint16_t nvmStaticWearWritesInHistory;
-
-/* Number of page erases performed since last rest. */
-static uint16_t nvmStaticWearErasesSinceReset;
-
-/* Stop recurring calls from causing mayhem. */
-static bool nvmStaticWearWorking = false;
-#endif
-
-/** @endcond */
-
-/*******************************************************************************
- ******************************   PROTOTYPES   *********************************
- ******************************************************************************/
-
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
-
-static uint8_t* NVM_PageFind(uint16_t pageId);
-static uint8_t* NVM_ScratchPageFindBest(void);
-static NVM_Result_t NVM_PageErase(uint8_t *pPhysicalAddress);
-static NVM_Page_Descriptor_t NVM_PageGet(uint16_t pageId);
-static NVM_ValidateResult_t NVM_PageValidate(uint8_t *pPhysicalAddress);
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-static uint16_t NVM_WearIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc);
-static bool NVM_WearReadIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, uint16_t *pIndex);
-#endif
-
-static void NVM_ChecksumAdditive(uint16_t *pChecksum, void *pBuffer, uint16_t len);
-
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-static void NVM_StaticWearReset(void);
-static void NVM_StaticWearUpdate(uint16_t address);
-static NVM_Result_t NVM_StaticWearCheck(void);
-#endif
-/** @endcond */
-
-/*******************************************************************************
- ***************************   GLOBAL FUNCTIONS   ******************************
- ******************************************************************************/
-
-/***************************************************************************//**
- * @brief
- *   Initialize the NVM manager.
- *
- * @details
- *   Use this function to initialize and validate the NVM. Should be run on
- *   startup. The result of this process is then returned in the form of a
- *   NVM_Result_t.
- *
- *   If nvmResultOk is returned, everything went according to plan and you
- *   can use the API right away. If nvmResultNoPages is returned this is a
- *   device that validates, but is empty. The proper way to handle this is to
- *   first reset the memory using NVM_Erase, and then write any initial
- *   data.
- *
- *   If a nvmResultError, or anything more specific, is returned something
- *   irreparable happened, and the system cannot be used reliably. A simple
- *   solution to this would be to erase and reinitialize, but this will then
- *   cause data loss.
- *
- * @param[in] config
- *   Pointer to structure defining NVM area.
- *
- * @return
- *   Returns the result of the initialization using a
- *   NVM_InitResult_TypeDef.
- ******************************************************************************/
-NVM_Result_t NVM_Init(NVM_Config_t const *config)
-{
-  uint16_t     page;
-  /* Variable to store the result returned at the end. */
-  NVM_Result_t result = nvmResultErrorInitial;
-
-  /* Physical address of the current page. */
-  uint8_t *pPhysicalAddress = (uint8_t *)(config->nvmArea);
-  /* Physical address of a suspected duplicate page under observation. */
-  uint8_t *pDuplicatePhysicalAddress;
-
-  /* Logical address of the current page. */
-  uint16_t logicalAddress;
-  /* Logical address of a duplicate page. */
-  uint16_t duplicateLogicalAddress;
-
-  /* Temporary variable to store results of a validation operation. */
-  NVM_ValidateResult_t validationResult;
-  /* Temporary variable to store results of a erase operation. */
-  NVM_Result_t         eraseResult;
-
-  /* if there is no spare page, return error */
-  if( (config->pages <= config->userPages) || (config->pages > NVM_MAX_NUMBER_OF_PAGES) )
-    return nvmResultError;
-
-  /* now check that page structures fits to physical page size */
-  { 
-    uint16_t pageIdx = 0, obj = 0, sum = 0;
-    const NVM_Page_Descriptor_t *current_page;
-    
-    for(pageIdx=0;pageIdx < config->userPages; pageIdx++)
-    { 
-      sum = 0;
-      obj = 0;
-      current_page = &((*(config->nvmPages))[pageIdx]);
-
-      while( (*(current_page->page))[obj].location != 0)
-        sum += (*(current_page->page))[obj++].size;
-
-      if(current_page->pageType == nvmPageTypeNormal)
-      {
-        if( sum > NVM_CONTENT_SIZE )
-        {
-          return nvmResultError; /* objects bigger than page size */
-        }
-      } 
-      else
-      {
-        if(current_page->pageType == nvmPageTypeWear)
-        {
-          if( (sum+NVM_CHECKSUM_LENGTH) > NVM_WEAR_CONTENT_SIZE )
-          {
-            return nvmResultError; /* objects bigger than page size */
-          }
-        } else 
-          {
-            return nvmResultError; /* unknown page type */
-          }
-      }
-    }
-  }
-
-  nvmConfig = config;
-
-  /* Require write lock to continue. */
-  NVM_ACQUIRE_WRITE_LOCK
-
-  /* Initialize the NVM. */
-  NVMHAL_Init();
-
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-  /* Initialize the static wear leveling functionality. */
-  NVM_StaticWearReset();
-#endif
-
-  /* Run through all pages and see if they validate if they contain content. */
-  for (page = 0; page < nvmConfig->pages; ++page)
-  {
-    /* Read the logical address of the page stored at the current physical
-     * address, and compare it to the value of an empty page. */
-    NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
-    if (NVM_PAGE_EMPTY_VALUE != logicalAddress)
-    {
-      /* Not an empty page. Check if it validates. */
-      validationResult = NVM_PageValidate(pPhysicalAddress);
-
-      /* Three different kinds of pages. */
-      if (nvmValidateResultOk == validationResult)
-      {
-        /* We have found a valid page, so the initial error can be changed to an
-         * OK result. */
-        if (nvmResultErrorInitial == result)
-        {
-          result = nvmResultOk;
-        }
-      }
-      else if (nvmValidateResultOkMarked == validationResult)
-      {
-        /* Page validates, but is marked for write.
-         * There might exist a newer version. */
-
-        /* Walk through all the possible pages looking for a page with
-         * matching watermark. */
-        pDuplicatePhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
-        for (page = 0; (NVM_PAGE_EMPTY_VALUE != logicalAddress) && (page < nvmConfig->pages);
-             ++page)
-        {
-          NVMHAL_Read(pDuplicatePhysicalAddress, &duplicateLogicalAddress, sizeof(duplicateLogicalAddress));
-
-          if ((pDuplicatePhysicalAddress != pPhysicalAddress) && ((logicalAddress | NVM_FIRST_BIT_ONE) == duplicateLogicalAddress))
-          {
-            /* Duplicate page has got the same logical address. Check if it
-             * validates. */
-            validationResult = NVM_PageValidate(pDuplicatePhysicalAddress);
-
-            if (nvmValidateResultOk == validationResult)
-            {
-              /* The new one validates, delete the old one. */
-              eraseResult = NVM_PageErase(pPhysicalAddress);
-            }
-            else
-            {
-              /* The new one is broken, delete the new one. */
-              eraseResult = NVM_PageErase(pDuplicatePhysicalAddress);
-            }
-
-            /* Something went wrong */
-            if (nvmResultOk != eraseResult)
-            {
-              result = nvmResultError;
-            }
-          }
-
-          /* Go to the next physical page. */
-          pDuplicatePhysicalAddress += NVM_PAGE_SIZE;
-        } /* End duplicate search loop. */
-
-        /* If everything went OK and this is the first page we found, then
-         * we can change the status from initial error to OK. */
-        if (nvmResultErrorInitial == result)
-        {
-          result = nvmResultOk;
-        }
-      }
-      else
-      {
-        /* Page does not validate */
-        result = nvmResultError;
-      }
-    } /* End - not empty if. */
-
-    /* Go to the next physical page. */
-    pPhysicalAddress += NVM_PAGE_SIZE;
-  } /* End pages loop. */
-
-  /* If no pages was found, the system is not in use and should be reset. */
-  if (nvmResultErrorInitial == result)
-  {
-    result = nvmResultNoPages;
-  }
-
-  /* Give up write lock and open for other API operations. */
-  NVM_RELEASE_WRITE_LOCK
-
-  return result;
-}
-
-/***************************************************************************//**
- * @brief
- *   Erase the entire NVM.
- *
- * @details
- *   Use this function to erase the entire non-volatile memory area allocated to
- *   the NVM system. It is possible to set a fixed erasure count for all the
- *   pages, or retain the existing one. To retain the erasure count might not be
- *   advisable if an error has occurred since this data may also have been
- *   damaged.
- *
- * @param[in] erasureCount
- *   Specifies which erasure count to set for the blank pages. Pass
- *   NVM_ERASE_RETAINCOUNT to retain the erasure count.
- *
- * @return
- *   Returns the result of the erase operation using a NVM_Result_t.
- ******************************************************************************/
-NVM_Result_t NVM_Erase(uint32_t erasureCount)
-{
-  uint16_t     page;
-  /* Result used when returning from the function. */
-  NVM_Result_t result = nvmResultErrorInitial;
-
-  /* Location of physical page. */
-  uint8_t *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
-
-  /* Container for moving old erasure count, or set to new. */
-  uint32_t tempErasureCount = erasureCount;
-
-
-  /* Require write lock to continue. */
-  NVM_ACQUIRE_WRITE_LOCK
-
-
-  /* Loop over all the pages, as long as everything is OK. */
-  for (page = 0;
-       (page < nvmConfig->pages) && ((nvmResultOk == result) || (nvmResultErrorInitial == result));
-       ++page)
-  {
-    /* If erasureCount input is set to the retain constant, we need to get the
-     * old erasure count before we erase the page. */
-    if (NVM_ERASE_RETAINCOUNT == erasureCount)
-    {
-      /* Read old erasure count. */
-      NVMHAL_Read(pPhysicalAddress + 2, &tempErasureCount, sizeof(tempErasureCount));
-    }
-
-    /* Erase page. */
-    result = NVMHAL_PageErase(pPhysicalAddress);
-
-    /* If still OK, write erasure count to page. */
-    if (nvmResultOk == result)
-    {
-      result = NVMHAL_Write(pPhysicalAddress + 2, &tempErasureCount, sizeof(tempErasureCount));
-    }
-
-    /* Go to the next physical page. */
-    pPhysicalAddress += NVM_PAGE_SIZE;
-  }
-
-  /* Give up write lock and open for other API operations. */
-  NVM_RELEASE_WRITE_LOCK
-
-  return result;
-}
-
-/***************************************************************************//**
- * @brief
- *   Write an object or a page.
- *
- * @details
- *   Use this function to write an object or an entire page to NVM. It takes a
- *   page and an object and updates this object with the data pointed to by the
- *   corresponding page entry. All the objects in a page can be written
- *   simultaneously by using NVM_WRITE_ALL instead of an object ID. For "normal"
- *   pages it simply finds not used page in flash (with lowest erase counter) and
- *   copies all objects belonging to this page updating objects defined by 
- *   objectId argument. For "wear" pages function tries to find spare place in 
- *   already used page and write object here - if there is no free space it uses
- *   new page invalidating previously used one.
- *
- * @param[in] pageId
- *   Identifier of the page you want to write to NVM.
- *
- * @param[in] objectId
- *   Identifier of the object you want to write. May be set to NVM_WRITE_ALL
- *   to write the entire page to memory.
- *
- * @return
- *   Returns the result of the write operation using a NVM_Result_t.
- ******************************************************************************/
-NVM_Result_t NVM_Write(uint16_t pageId, uint8_t objectId)
-{
-  /* Result variable used as return value from the function. */
-  NVM_Result_t result = nvmResultErrorInitial;
-
-  /* Watermark to look for when finding page. First bit true. */
-  uint16_t              watermark = pageId | NVM_FIRST_BIT_ONE;
-  /* Watermark used when flipping the duplication bit of a page. */
-  const uint32_t flipWatermark = NVM_FLIP_FIRST_BIT_OF_32_WHEN_WRITE;
-
-  /* Page descriptor used for accessing page type and page objects. */
-  NVM_Page_Descriptor_t pageDesc;
-
-  /* Page header and footer. Used to store old version and to easily update and
-   * write new version. */
-  NVM_Page_Header_t header;
-
-  /* Variable used for checksum calculation. Starts at defined initial value. */
-  uint16_t checksum = NVM_CHECKSUM_INITIAL;
-
-  /* Physical addresses in memory for the old and new version of the page. */
-  uint8_t *pOldPhysicalAddress = (uint8_t *) NVM_NO_PAGE_RETURNED;
-  uint8_t *pNewPhysicalAddress = (uint8_t *) NVM_NO_PAGE_RETURNED;
-
-  /* Offset address within page. */
-  uint16_t offsetAddress;
-  /* Single byte buffer used when copying data from an old page.*/
-  uint8_t  copyBuffer;
-  /* Object in page counter. */
-  uint8_t  objectIndex;
-  /* Amount of bytes to copy. */
-  uint16_t copyLength;
-
-  /* Handle wear pages. Should we handle this as an extra write to an existing
-   * page or create a new one. */
-  bool wearWrite = false;
-
-#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
-  /* Bool used when checking if a write operation is needed. */
-  bool rewriteNeeded;
-#endif
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  /* Used to hold the checksum of the wear object. */
-  uint16_t wearChecksum;
-  /* Byte size of the wear object. Includes checksum length. */
-  uint16_t wearObjectSize;
-  /* Used to specify the internal index of the wear object in a page. */
-  uint16_t wearIndex;
-
-  #if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
-  /* The new wear index the object will be written to. */
-  uint16_t wearIndexNew;
-  #endif
-#endif
-
-  /* Require write lock to continue. */
-  NVM_ACQUIRE_WRITE_LOCK
-
-  /* Find old physical address. */
-  pOldPhysicalAddress = NVM_PageFind(pageId);
-
-  /* Get the page configuration. */
-  pageDesc = NVM_PageGet(pageId);
-
-#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
-  /* If there is an old version of the page, it might not be necessary to update
-   * the data. Also check that this is a normal page and that the static wear
-   * leveling system is not working (this system might want to rewrite pages
-   * even if the data is similar to the old version). */
-  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
-      && (nvmPageTypeNormal == pageDesc.pageType)
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-      && !nvmStaticWearWorking
-#endif
-
-      )
-  {
-    rewriteNeeded = false;
-    objectIndex   = 0;
-    offsetAddress = 0;
-
-    /* Loop over items as long as no rewrite is needed and the current item has
-    * got a size other than 0. Size 0 is used as a marker for a NULL object. */
-    while (((*pageDesc.page)[objectIndex].size != 0) && !rewriteNeeded)
-    {
-      /* Check if every object should be written or if this is the object to
-       * write. */
-      if ((NVM_WRITE_ALL_CMD == objectId) ||
-          ((*pageDesc.page)[objectIndex].objectId == objectId))
-      {
-        /* Compare object to RAM. */
-
-        copyLength = (*pageDesc.page)[objectIndex].size;
-
-        /* Loop over each byte of the object and compare with RAM. */
-        while (copyLength != 0)
-        {
-          /* Get byte from NVM. */
-          NVMHAL_Read(pOldPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
-                      &copyBuffer,
-                      sizeof(copyBuffer));
-
-          /* Check byte in NVM with the corresponding byte in RAM. */
-          if (*(uint8_t *)((*pageDesc.page)[objectIndex].location + offsetAddress) != copyBuffer)
-          {
-            rewriteNeeded = true;
-            break;
-          }
-
-          /* Move offset. */
-          offsetAddress += sizeof(copyBuffer);
-          copyLength    -= sizeof(copyBuffer);
-        }
-      }
-      else
-      {
-        /* Move offset past the object. */
-        offsetAddress += (*pageDesc.page)[objectIndex].size;
-      }
-
-      /* Check next object. */
-      objectIndex++;
-    }
-
-    if (!rewriteNeeded)
-    {
-      /* Release write lock before return. */
-      NVM_RELEASE_WRITE_LOCK
-
-      return nvmResultOk;
-    }
-  }
-#endif
-
-
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  /* If this is a wear page then we can check if we can possibly squeeze another
-   * version of the object inside the already existing page. If this is possible
-   * we set the wearWrite boolean. This will then make us ignore the normal
-   * write operation. */
-  if (nvmPageTypeWear == pageDesc.pageType)
-  {
-    /* Calculate checksum. The wear page checksum is only stored in 15 bits,
-     * because we need one bit to mark that the object is written. This bit is
-     * always set to 0. */
-
-    wearChecksum = NVM_CHECKSUM_INITIAL;
-    NVM_ChecksumAdditive(&wearChecksum, (*pageDesc.page)[0].location, (*pageDesc.page)[0].size);
-    wearChecksum &= NVM_LAST_BIT_ZERO;
-
-    /* If there was an old page. */
-    if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
-    {
-      /* Find location in old page. */
-      wearIndex      = NVM_WearIndex(pOldPhysicalAddress, &pageDesc);
-      wearObjectSize = (*pageDesc.page)[0].size + NVM_CHECKSUM_LENGTH;
-
-      /* Check that the wearIndex returned is within the length of the page. */
-      if (wearIndex < ((uint16_t) NVM_WEAR_CONTENT_SIZE) / wearObjectSize)
-      {
-        result = NVMHAL_Write(pOldPhysicalAddress + NVM_HEADER_SIZE + wearIndex * wearObjectSize,
-                              (*pageDesc.page)[0].location,
-                              (*pageDesc.page)[0].size);
-        result = NVMHAL_Write(pOldPhysicalAddress + NVM_HEADER_SIZE + wearIndex * wearObjectSize + (*pageDesc.page)[0].size,
-                              &wearChecksum,
-                              sizeof(wearChecksum));
-
-        /* Register that we have now written to the old page. */
-        wearWrite = true;
-
-#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
-        /* Check if the newest one that is valid is the same as the one we just
-         * wrote to the NVM. */
-        if ((!NVM_WearReadIndex(pOldPhysicalAddress, &pageDesc, &wearIndexNew)) ||
-            (wearIndexNew != wearIndex))
-        {
-          result = nvmResultError;
-        }
-#endif
-      }
-    } /* End of old page if. */
-  }   /* End of wear page if. */
-#endif
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  /* Do not create a new page if we have already done an in-page wear write. */
-  if (!wearWrite)
-  {
-#endif
-  /* Mark any old page before creating a new one. */
-  if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
-  {
-    result = NVMHAL_Write(pOldPhysicalAddress, &flipWatermark, 4);
-
-    if (nvmResultOk != result)
-    {
-      /* Give up write lock and open for other API operations. */
-      NVM_RELEASE_WRITE_LOCK
-      return result;
-    }
-  }
-
-  /* Find new physical address to write to. */
-  pNewPhysicalAddress = NVM_ScratchPageFindBest();
-
-  if ((uint8_t*) NVM_NO_PAGE_RETURNED == pNewPhysicalAddress)
-  {
-    /* Give up write lock and open for other API operations. */
-    NVM_RELEASE_WRITE_LOCK
-    return nvmResultError;
-  }
-
-  /* Generate and write header */
-  header.watermark = watermark;
-  header.updateId  = NVM_NO_WRITE_32BIT;
-  header.version   = NVM_VERSION;
-
-  /* store header at beginning of page */
-  result = NVMHAL_Write(pNewPhysicalAddress, &header.watermark, sizeof(header.watermark));
-  result = NVMHAL_Write(pNewPhysicalAddress + sizeof(header.watermark), &header.updateId, sizeof(header.updateId));
-  result = NVMHAL_Write(pNewPhysicalAddress + sizeof(header.watermark)+ + sizeof(header.updateId), &header.version, sizeof(header.version));
-
-  /* Reset address index within page. */
-  offsetAddress = 0;
-  /* Reset object in page counter. */
-  objectIndex = 0;
-
-  /* Loop over items as long as everything is OK, and the current item has got
-   * a size other than 0. Size 0 is used as a marker for a NULL object. */
-  while (((*pageDesc.page)[objectIndex].size != 0) && (nvmResultOk == result))
-  {
-    /* Check if every object should be written or if this is the object to
-     * write. */
-    if ((NVM_WRITE_ALL_CMD == objectId) ||
-        ((*pageDesc.page)[objectIndex].objectId == objectId))
-    {
-      /* Write object from RAM. */
-      result = NVMHAL_Write(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
-                            (*pageDesc.page)[objectIndex].location,
-                            (*pageDesc.page)[objectIndex].size);
-      offsetAddress += (*pageDesc.page)[objectIndex].size;
-
-      NVM_ChecksumAdditive(&checksum, (*pageDesc.page)[objectIndex].location, (*pageDesc.page)[objectIndex].size);
-    }
-    else
-    {
-      /* Get version from old page. */
-      if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
-      {
-        NVM_ChecksumAdditive(&checksum, pOldPhysicalAddress + offsetAddress + NVM_HEADER_SIZE, (*pageDesc.page)[objectIndex].size);
-
-        copyLength = (*pageDesc.page)[objectIndex].size;
-
-        while ((copyLength != 0) && (nvmResultOk == result))
-        {
-          /* Copies using an 1 byte buffer. Might be better to dynamically use larger if possible. */
-          NVMHAL_Read(pOldPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
-                      &copyBuffer,
-                      sizeof(copyBuffer));
-          result = NVMHAL_Write(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
-                                &copyBuffer,
-                                sizeof(copyBuffer));
-
-          offsetAddress += sizeof(copyBuffer);
-          copyLength    -= sizeof(copyBuffer);
-        }
-      }  /* End if old page. */
-    }   /* Else-end of NVM_WRITE_ALL if-statement. */
-
-    objectIndex++;
-  }
-
-  /* If we are creating a wear page, add the checksum directly after the data. */
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  if (nvmPageTypeWear == pageDesc.pageType)
-  {
-    result = NVMHAL_Write(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
-                          &wearChecksum,
-                          sizeof(wearChecksum));
-  }
-  /* Generate and write footer on normal pages. */
-  else
-  {
-#endif
-  if (nvmResultOk == result)
-  {
-    /* write checksum at end of page */
-    result = NVMHAL_Write(pNewPhysicalAddress + (NVM_PAGE_SIZE - NVM_FOOTER_SIZE), &checksum, sizeof(checksum));
-    /* write watermark just after checksum at end of page */
-    result = NVMHAL_Write(pNewPhysicalAddress + (NVM_PAGE_SIZE + sizeof(checksum) - NVM_FOOTER_SIZE), &watermark, sizeof(watermark));
-  }
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-}     /* End of else from page type. */
-#endif
-
-#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
-  /* Validate that the correct data was written. */
-  if (nvmValidateResultOk != NVM_PageValidate(pNewPhysicalAddress))
-  {
-    result = nvmResultError;
-  }
-#endif
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-}   /* End of if for normal write (!wearWrite). */
-#endif
-
-  /* Erase old if there was an old one and everything else have gone OK. */
-  if ((!wearWrite) &&
-      ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress))
-  {
-    if (nvmResultOk == result)
-    {
-      result = NVM_PageErase(pOldPhysicalAddress);
-    }
-    else
-    {
-      NVM_PageErase(pNewPhysicalAddress);
-    }
-  }
-
-  /* Give up write lock and open for other API operations. */
-  NVM_RELEASE_WRITE_LOCK
-
-  return result;
-}
-
-/***************************************************************************//**
- * @brief
- *   Read an object or an entire page.
- *
- * @details
- *   Use this function to read an object or an entire page from memory. It takes
- *   a page id and an object id (or the NVM_READ_ALL constant to read
- *   everything) and reads data from flash and puts it in the memory locations
- *   given in the page specification.
- *
- * @param[in] pageId
- *   Identifier of the page to read from.
- *
- * @param[in] objectId
- *   Identifier of the object to read. Can be set to NVM_READ_ALL to read
- *   an entire page.
- *
- * @return
- *   Returns the result of the read operation using a NVM_Result_t.
- ******************************************************************************/
-NVM_Result_t NVM_Read(uint16_t pageId, uint8_t objectId)
-{
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  /* Variable used to fetch read index. */
-  uint16_t wearIndex;
-#endif
-
-  /* Physical address of the page to read from. */
-  uint8_t *pPhysicalAddress;
-
-  /* Description of the page, used to find page type and objects. */
-  NVM_Page_Descriptor_t pageDesc;
-
-  /* Index of object in page. */
-  uint8_t  objectIndex;
-  /* Address of read location within a page. */
-  uint16_t offsetAddress;
-
-
-  /* Require write lock to continue. */
-  NVM_ACQUIRE_WRITE_LOCK
-
-  /* Find physical page. */
-  pPhysicalAddress = NVM_PageFind(pageId);
-
-  /* If no page was found, we cannot read anything. */
-  if ((uint8_t*) NVM_NO_PAGE_RETURNED == pPhysicalAddress)
-  {
-    /* Give up write lock and open for other API operations. */
-    NVM_RELEASE_WRITE_LOCK
-    return nvmResultNoPage;
-  }
-
-  /* Get page description. */
-  pageDesc = NVM_PageGet(pageId);
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  /* If this is a wear page, we must find out which object in the page should be
-   * read. */
-  if (nvmPageTypeWear == pageDesc.pageType)
-  {
-    /* Find valid object in wear page and read it. */
-    if (NVM_WearReadIndex(pPhysicalAddress, &pageDesc, &wearIndex))
-    {
-      NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE +
-                  wearIndex * ((*pageDesc.page)[0].size + NVM_CHECKSUM_LENGTH),
-                  (*pageDesc.page)[0].location,
-                  (*pageDesc.page)[0].size);
-    }
-    else
-    {
-      /* No valid object was found in the page. */
-      /* Give up write lock and open for other API operations. */
-      NVM_RELEASE_WRITE_LOCK
-      return nvmResultDataInvalid;
-    }
-  }
-  else
-#endif
-  {
-    /* Read normal page. */
-    objectIndex   = 0;
-    offsetAddress = 0;
-
-#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
-    if (nvmValidateResultError == NVM_PageValidate(pPhysicalAddress))
-    {
-      /* Give up write lock and open for other API operations. */
-      NVM_RELEASE_WRITE_LOCK
-      return nvmResultDataInvalid;
-    }
-#endif
-
-    /* Loop through and read the objects of a page, as long as the current item
-     * has got a size other than 0. Size 0 is a marker for the NULL object. */
-    while ((*pageDesc.page)[objectIndex].size != 0)
-    {
-      /* Check if every object should be read or if this is the object to read. */
-      if ((NVM_READ_ALL_CMD == objectId) || ((*pageDesc.page)[objectIndex].objectId == objectId))
-      {
-        NVMHAL_Read(pPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
-                    (*pageDesc.page)[objectIndex].location,
-                    (*pageDesc.page)[objectIndex].size);
-      }
-
-      offsetAddress += (*pageDesc.page)[objectIndex].size;
-      objectIndex++;
-    }
-  }
-
-  /* Give up write lock and open for other API operations. */
-  NVM_RELEASE_WRITE_LOCK
-
-  return nvmResultOk;
-}
-
-/***************************************************************************//**
- * @brief
- *   Get maximum wear level.
- *
- * @details
- *   This function returns the amount of erase cycles for the most erased page
- *   in memory. This can be used as a rough measure of health for the device.
- *
- * @return
- *   Returns the wear level as a uint32_t.
- ******************************************************************************/
-#if (NVM_FEATURE_WEARLEVELGET_ENABLED == true)
-uint32_t NVM_WearLevelGet(void)
-{
-  uint16_t page;
-  /* Used to temporarily store the update id of the current page. */
-  uint32_t updateId;
-  /* Worst (highest) update id. Used as return value. */
-  uint32_t worstUpdateId = 0;
-
-  /* Address of physical page. */
-  uint8_t *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
-
-  /* Loop through all pages in memory. */
-  for (page = 0; page < nvmConfig->pages; ++page)
-  {
-    /* Find and compare erasure count. */
-    NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
-    if (updateId > worstUpdateId)
-    {
-      worstUpdateId = updateId;
-    }
-
-    /* Go to the next physical page. */
-    pPhysicalAddress += NVM_PAGE_SIZE;
-  }
-
-  return worstUpdateId;
-}
-#endif
-
-/*******************************************************************************
- ***************************   LOCAL FUNCTIONS   *******************************
- ******************************************************************************/
-
-/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
-
-/***************************************************************************//**
- * @brief
- *   Find the physical address of a page.
- *
- * @details
- *   This function finds the physical address of a page given a page id by
- *   traversing the flash memory.
- *
- * @param[in] pageId
- *   NVM_Page_Ids that identifies the page.
- *
- * @return
- *   Returns the resulting address as a uint8_t*. If no page was found
- *   (uint8_t*)NVM_NO_PAGE_RETURNED is returned.
- ******************************************************************************/
-static uint8_t* NVM_PageFind(uint16_t pageId)
-{
-  uint16_t page;
-  /* Physical address to return. */
-  uint8_t  *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
-  /* Temporary variable used to read and compare logical page address. */
-  uint16_t logicalAddress;
-
-  /* Loop through memory looking for a matching watermark. */
-  for (page = 0; page < nvmConfig->pages; ++page)
-  {
-    /* Allow both versions of writing mark, invalid duplicates should already
-     * have been deleted. */
-    NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
-    if (((pageId | NVM_FIRST_BIT_ONE) == logicalAddress) || (pageId == logicalAddress))
-    {
-      return pPhysicalAddress;
-    }
-
-    /* Move lookup point to the next page. */
-    pPhysicalAddress += NVM_PAGE_SIZE;
-  }
-
-  /* No page found. */
-  return (uint8_t *) NVM_NO_PAGE_RETURNED;
-}
-
-/***************************************************************************//**
- * @brief
- *   Finds the best scratch page.
- *
- * @details
- *   This function returns the least used of all the currently empty pages. This
- *   can be thought of as the best page to use if one wants the system to
- *   perform dynamic wear leveling.
- *
- * @return
- *   Address of the page is returned as a uint8_t*.
- ******************************************************************************/
-static uint8_t* NVM_ScratchPageFindBest(void)
-{
-  uint16_t page;
-  /* Address for physical page to return. */
-  uint8_t  *pPhysicalPage = (uint8_t *) NVM_NO_PAGE_RETURNED;
-
-  /* Variable used to read and compare update id of physical pages. */
-  uint32_t updateId = NVM_HIGHEST_32BIT;
-  /* The best update id found. */
-  uint32_t bestUpdateId = NVM_HIGHEST_32BIT;
-
-  /* Pointer to the current physical page. */
-  uint8_t  *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
-  /* Logical address that identifies the page. */
-  uint16_t logicalAddress;
-
-  /* Loop through all pages in memory. */
-  for (page = 0; page < nvmConfig->pages; ++page)
-  {
-    /* Read and check logical address. */
-    NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
-    if ((uint16_t) NVM_PAGE_EMPTY_VALUE == logicalAddress)
-    {
-      /* Find and compare erasure count. */
-      NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
-      if (updateId < bestUpdateId)
-      {
-        bestUpdateId  = updateId;
-        pPhysicalPage = pPhysicalAddress;
-      }
-    }
-
-    /* Move lookup point to the next page. */
-    pPhysicalAddress += NVM_PAGE_SIZE;
-  }
-
-  /* Return a pointer to the best/least used page. */
-  return pPhysicalPage;
-}
-
-/***************************************************************************//**
- * @brief
- *   Erases a page.
- *
- * @details
- *   This function erases the page at a certain address. All the data is erased
- *   while the erasure count of the page is retained and updated.
- *
- * @param[in] address
- *   Pointer to the location you want to erase.
- *
- * @return
- *   Returns the result of the operation as a NVM_Result_t.
- ******************************************************************************/
-static NVM_Result_t NVM_PageErase(uint8_t *pPhysicalAddress)
-{
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-  /* Logical page address. */
-  uint16_t logicalAddress;
-#endif
-
-  /* Read out the old page update id. */
-  uint32_t updateId;
-  NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
-
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-  /* Get logical page address. */
-  NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
-
-  /* If not empty: mark as erased and check against threshold. */
-  if (logicalAddress != NVM_PAGE_EMPTY_VALUE)
-  {
-    /* Set first bit low. */
-    logicalAddress = logicalAddress & NVM_FIRST_BIT_ZERO;
-    NVM_StaticWearUpdate(logicalAddress);
-  }
-#endif
-
-  /* Erase the page. */
-  NVMHAL_PageErase(pPhysicalAddress);
-
-  /* Update erasure count. */
-  updateId++;
-
-  /* Write increased erasure count. */
-  return NVMHAL_Write(pPhysicalAddress + 2, &updateId, sizeof(updateId));
-}
-
-/***************************************************************************//**
- * @brief
- *   Get the description of a page.
- *
- * @details
- *   This function returns the NVM_Page_Descriptor_t corresponding to a
- *   given NVM_Page_Ids.
- *
- * @note
- *   This function returns a struct instead of a pointer since the packed struct
- *   is as small as a pointer, and using a pointer might add more instruction
- *   overhead.
- *
- * @param[in] pageId
- *   Identifier of the page.
- *
- * @return
- *   Returns the page description as a NVM_Page_Descriptor_t.
- ******************************************************************************/
-static NVM_Page_Descriptor_t NVM_PageGet(uint16_t pageId)
-{
-  uint8_t                            pageIndex;
-  static const NVM_Page_Descriptor_t nullPage = { (uint8_t) 0, 0, (NVM_Page_Type_t) 0 };
-
-  /* Step through all configured pages. */
-  for (pageIndex = 0; pageIndex < nvmConfig->userPages; ++pageIndex)
-  {
-    /* If this is the page we want, return it. */
-    if ( (*(nvmConfig->nvmPages))[pageIndex].pageId == pageId)
-    {
-      return (*(nvmConfig->nvmPages))[pageIndex];
-    }
-  }
-
-  /* No page matched the ID, return a NULL page to mark the error. */
-  return nullPage;
-}
-
-/***************************************************************************//**
- * @brief
- *   Validate a certain address.
- *
- * @details
- *   This function checks if there is a valid page at the supplied address.
- *
- *   For normal pages the checksum is calculated and compared against the one
- *   stored in NVM, and the watermark in the header and footer are compared.
- *   Results are returned based on the write mark of the page.
- *
- *   For wear pages we check that there are any readable objects in the page
- *   using the lookup function used by the read command. Here we are dependent
- *   on user settings to control the checksum.
- *
- * @param[in] pPhysicalAddress
- *   Pointer to the location you want to check.
- *
- * @return
- *   Returns the validation status of the address as a NVM_ValidateResult_t.
- ******************************************************************************/
-static NVM_ValidateResult_t NVM_PageValidate(uint8_t *pPhysicalAddress)
-{
-  /* Result used as return value from the function. */
-  NVM_ValidateResult_t result;
-
-  /* Objects used to read out the page header and footer. */
-  NVM_Page_Header_t header;
-  NVM_Page_Footer_t footer;
-
-  /* Descriptor for the current page. */
-  NVM_Page_Descriptor_t pageDesc;
-
-  /* Variable used for calculating checksums. */
-  uint16_t checksum;
-
-  /* Offset of object in page. */
-  uint8_t  objectIndex;
-  /* Address of read location within a page. */
-  uint16_t offsetAddress;
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  /* Variable used to fetch read index. */
-  uint16_t index;
-#endif
-
-  /* Read page header data */
-  NVMHAL_Read(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
-  NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark), &header.updateId, sizeof(header.updateId));
-  NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
-
-  /* Stop immediately if data is from another version of the API. */
-  if (NVM_VERSION != header.version)
-  {
-    return nvmValidateResultOld;
-  }
-
-  /* Get the page configuration. */
-  pageDesc = NVM_PageGet((header.watermark & NVM_FIRST_BIT_ZERO));
-
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-  if (nvmPageTypeWear == pageDesc.pageType)
-  {
-    /* Wear page. */
-
-    /* If first bit is already zero the page is marked as a duplicate. */
-    if ((header.watermark & NVM_FIRST_BIT_ZERO) == header.watermark)
-    {
-      result = nvmValidateResultOkMarked;
-    }
-    else
-    {
-      /* Page is not marked as a duplicate. */
-      result = nvmValidateResultOk;
-    }
-
-    /* If we do not have any valid objects in the page it is invalid. */
-    if (!NVM_WearReadIndex(pPhysicalAddress, &pageDesc, &index))
-    {
-      result = nvmValidateResultError;
-    }
-  }
-  else
-#endif
-  {
-    /* Normal page. */
-    NVMHAL_Read(pPhysicalAddress + (NVM_PAGE_SIZE - NVM_FOOTER_SIZE), &footer.checksum, sizeof(footer.checksum));
-    NVMHAL_Read(pPhysicalAddress + (NVM_PAGE_SIZE + sizeof(checksum) - NVM_FOOTER_SIZE), &footer.watermark, sizeof(footer.watermark));
-    /* Check if watermark or watermark with flipped write bit matches. */
-    if (header.watermark == footer.watermark)
-    {
-      result = nvmValidateResultOk;
-    }
-    else if ((header.watermark | NVM_FIRST_BIT_ONE) == footer.watermark)
-    {
-      result = nvmValidateResultOkMarked;
-    }
-    else
-    {
-      result = nvmValidateResultError;
-    }
-
-    /* Calculate checksum and compare with the one stored. */
-    objectIndex   = 0;
-    offsetAddress = 0;
-    checksum      = NVM_CHECKSUM_INITIAL;
-
-    /* Calculate per object using the HAL. Loop over items as long as the
-     * current object has got a size other than 0. Size 0 is used as a marker
-     * for a NULL object. */
-    while ((*pageDesc.page)[objectIndex].size != 0)
-    {
-      NVMHAL_Checksum(&checksum, (uint8_t *) pPhysicalAddress + NVM_HEADER_SIZE + offsetAddress, (*pageDesc.page)[objectIndex].size);
-      offsetAddress += (*pageDesc.page)[objectIndex].size;
-      objectIndex++;
-    }
-
-    if (checksum != footer.checksum)
-    {
-      result = nvmValidateResultError;
-    }
-  }
-
-  return result;
-}
-
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-/***************************************************************************//**
- * @brief
- *   Find used wear slots.
- *
- * @details
- *   This function returns the index of the first unused space in a wear page,
- *   might be outside of the page. The index is based on using the size of the
- *   object and checksum as the step size when traversing the memory.
- *
- * @param[in] *pPhysicalAddress
- *   Pointer to the start of the page you want to check.
- *
- * @param[in] pageDesc
- *   The page descriptor for the page.
- *
- * @return
- *   Returns the index as a uint16_t.
- ******************************************************************************/
-static uint16_t NVM_WearIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc)
-{
-  /* Index to return. */
-  uint16_t wearIndex = 0;
-
-  /* Temporary variable used when calculating and comparing checksums. */
-  uint16_t checksum;
-
-  /* Size of the object in the wear page, including a 16 bit checksum. */
-  uint16_t wearObjectSize = ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH);
-
-
-  /* Loop over possible pages. Stop when empty page was found. */
-  while (wearIndex < NVM_WEAR_CONTENT_SIZE / wearObjectSize)
-  {
-    NVMHAL_Read((uint8_t *)(pPhysicalAddress + NVM_HEADER_SIZE +
-                            wearIndex * wearObjectSize +
-                            (*pPageDesc->page)[0].size
-                            ),
-                &checksum,
-                sizeof(checksum));
-
-    /* Flip the last bit of the checksum to zero. This is a mark used to
-     * determine that an object is written to this location. */
-    if ((checksum & NVM_LAST_BIT_ZERO) != checksum)
-    {
-      /* Break the loop and accept this location. */
-      break;
-    }
-
-    /* Not a valid position for a new write.
-    * Increase the index and check again. */
-    wearIndex++;
-  }
-
-  return wearIndex;
-}
-#endif
-
-/***************************************************************************//**
- * @brief
- *   Find newest wear index in a page.
- *
- * @details
- *   This function finds the index of the newest valid instance of the wear
- *   object in a given page and assigns it to the given index variable. The
- *   function returns false if there are no valid instances.
- *
- * @param[in] *pPhysicalAddress
- *   Pointer to the start of the page you want to check.
- *
- * @param[in] *pageDesc
- *   The page descriptor for the page.
- *
- * @param[in] *index
- *   Pointer to where to store the index found.
- *
- * @return
- *   Returns the result of the operation as a boolean.
- ******************************************************************************/
-#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
-static bool NVM_WearReadIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, uint16_t *pIndex)
-{
-#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
-  /* Variable used for calculating checksum when validating. */
-  uint16_t checksum = NVM_CHECKSUM_INITIAL;
-#endif
-
-  /* Length of wear object plus checksum. */
-  const uint16_t wearObjectSize = ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH);
-
-  /* Return value. */
-  bool validObjectFound = false;
-
-  /* Buffer used when reading checksum. */
-  uint16_t readBuffer;
-
-  /* Initialize index at max plus one object. */
-  *pIndex = (((uint16_t) NVM_WEAR_CONTENT_SIZE) / wearObjectSize);
-
-  /* Loop over possible pages. Stop when first OK page is found. */
-  while ((*pIndex > 0) && (!validObjectFound))
-  {
-    (*pIndex)--;
-
-    /* Initialize checksum, and then calculate it from the HAL.*/
-    uint8_t *temp = pPhysicalAddress + NVM_HEADER_SIZE + (*pIndex) * wearObjectSize + (*pPageDesc->page)[0].size;
-    NVMHAL_Read((uint8_t *) temp, &readBuffer, sizeof(readBuffer));
-
-#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
-    /* Calculate the checksum before accepting the object. */
-    checksum = NVM_CHECKSUM_INITIAL;
-    NVMHAL_Checksum(&checksum, pPhysicalAddress + NVM_HEADER_SIZE + (*pIndex) * wearObjectSize, (*pPageDesc->page)[0].size);
-    /* Flips the last bit of the checksum to zero. This is a mark used to
-     * determine whether we have written anything to the page. */
-    if ((uint16_t)(checksum & NVM_LAST_BIT_ZERO) == readBuffer)
-#else
-    if (NVM_NO_WRITE_16BIT != readBuffer)
-#endif
-    {
-      validObjectFound = true;
-    }
-  }
-
-  return validObjectFound;
-}
-#endif
-
-/***************************************************************************//**
- * @brief
- *   Calculate checksum according to CCITT CRC16.
- *
- * @details
- *   This function calculates a checksum of the supplied buffer.
- *   The checksum is calculated using CCITT CRC16 plynomial x^16+x^12+x^5+1.
- *
- * @param[in] pChecksum
- *   Pointer to where the checksum should be calculated and stored. This buffer
- *   should be initialized. A good consistent starting point would be
- *   NVM_CHECKSUM_INITIAL.
- *
- * @param[in] pBuffer
- *   Pointer to the data you want to calculate a checksum for.
- *
- * @param[in] len
- *   The length of the data.
- ******************************************************************************/
-static void NVM_ChecksumAdditive(uint16_t *pChecksum, void *pBuffer, uint16_t len)
-{
-  uint8_t *pointer = (uint8_t *) pBuffer;
-  uint16_t crc = *pChecksum;
-
-  while(len--)
-  {
-    crc = (crc >> 8) | (crc << 8);
-    crc ^= *pointer++;
-    crc ^= (crc & 0xf0) >> 4;
-    crc ^= (crc & 0x0f) << 12;
-    crc ^= (crc & 0xff) << 5;
-  }
-
-  *pChecksum = crc;
-}
-
-#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
-/***************************************************************************//**
- * @brief
- *   Resets the static wear leveling system.
- *
- * @details
- *   This function resets the history of the static wear leveling system. This
- *   is done at startup and whenever all the pages have been updated at least
- *   once and the threshold for rewrites have been reached.
- ******************************************************************************/
-static void NVM_StaticWearReset(void)
-{
-  uint16_t i;
-  nvmStaticWearErasesSinceReset = 0;
-  nvmStaticWearWritesInHistory  = 0;
-
-  for (i = 0; (NVM_PAGES_PER_WEAR_HISTORY * i) < nvmConfig->userPages; i += 1)
-  {
-    nvmStaticWearWriteHistory[i] = 0;
-  }
-}
-
-/***************************************************************************//**
- * @brief
- *   Mark a page as updated.
- *
- * @details
- *   This function marks the given page as updated, and updates the update
- *   count. It then executes the StaticWearCheck function.
- *
- * @param[in] address
- *   Logical address of the page that was updated.
- ******************************************************************************/
-static void NVM_StaticWearUpdate(uint16_t address)
-{
-  if (address < nvmConfig->userPages)
-  {
-    /* Mark page with logical address as written. */
-
-    /* Bitmask to check and change the desired bit. */
-    uint8_t mask = 1U << (address % NVM_PAGES_PER_WEAR_HISTORY);
-
-    if ((nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] & mask) == 0)
-    {
-      /* Flip bit. */
-      nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] |= mask;
-      /* Record flip. */
-      nvmStaticWearWritesInHistory++;
-    }
-
-    /* Record erase operation. */
-    nvmStaticWearErasesSinceReset++;
-
-    /* Call the static wear leveler. */
-    NVM_StaticWearCheck();
-  }
-}
-
-/***************************************************************************//**
- * @brief
- *   Run the static wear leveling check.
- *
- * @details
- *   The static wear leveling check is executed in this function. It uses the
- *   give threshold value to decide whether it is time to walk through the pages
- *   and move non-updated ones.
- ******************************************************************************/
-static NVM_Result_t NVM_StaticWearCheck(void)
-{
-  /* Check if there is a check already running. We do not need more of these. */
-  if (!nvmStaticWearWorking)
-  {
-    nvmStaticWearWorking = true;
-    while (nvmStaticWearErasesSinceReset / nvmStaticWearWritesInHistory > NVM_STATIC_WEAR_THRESHOLD)
-    {
-      /* If all the pages have been moved in this cycle: reset. */
-      if (nvmStaticWearWritesInHistory >= nvmConfig->userPages)
-      {
-        NVM_StaticWearReset();
-        break;
-      }
-
-      /* Find an address for a page that has not been rewritten. */
-      uint16_t address = 0;
-      uint8_t  mask    = 1U << (address % NVM_PAGES_PER_WEAR_HISTORY);
-      while ((nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] & mask) != 0)
-      {
-        address++;
-        mask = 1U << (address % NVM_PAGES_PER_WEAR_HISTORY);
-      }
-
-      /* Check for wear page. */
-      if (nvmPageTypeWear == NVM_PageGet(address).pageType)
-      {
-        /* Flip bit. */
-        nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] |= mask;
-        /* Record flip. */
-        nvmStaticWearWritesInHistory++;
-      }
-      else
-      {
-        /* Must release write lock, run the write function to move the data,
-         * then acquire lock again. */
-
-        /* Give up write lock and open for other API operations. */
-        NVM_RELEASE_WRITE_LOCK
-
-        NVM_Write(address, NVM_WRITE_NONE_CMD);
-
-        /* Require write lock to continue. */
-        NVM_ACQUIRE_WRITE_LOCK
-      }
-    }
-    nvmStaticWearWorking = false;
-  }
-
-  return nvmResultOk;
-}
-
-#endif
-
-/** @endcond */
-
-/** @} (end addtogroup NVM */
-/** @} (end addtogroup EM_Drivers) */
+/***************************************************************************//**
+ * @file
+ * @brief Non-Volatile Memory Driver.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ * @details
+ * This is a software manager module for non-volatile memory. It consists of
+ * nvm.c, nvm.h and nvm_hal.h. In addition to this it requires a valid nvm_hal.c.
+ * This lets the manager work with different types of memory. 
+ * Files nvm_config_template.* shows possible configuration of objects and could
+ * be used as template for customer application.
+ *
+ * The module has the following public interfaces:
+ *
+ * NVM_Init()
+ * NVM_Erase()
+ * NVM_Write()
+ * NVM_Read()
+ * NVM_ReadV()
+ * NVM_WriteV()
+ * NVM_ReadPtr()
+ * NVM_ReadInto()
+ * NVM_WriteRange()
+ * NVM_CounterAdd()
+ * NVM_CounterGet()
+ * NVM_LogAppend()
+ * NVM_LogSeek()
+ * NVM_LogNext()
+ * NVM_LogRangeGet()
+ * NVM_KvSet()
+ * NVM_KvGet()
+ * NVM_KvDelete()
+ * NVM_EepromWrite()
+ * NVM_EepromRead()
+ * NVM_TxBegin()
+ * NVM_TxWrite()
+ * NVM_TxCommit()
+ * NVM_Flush()
+ * NVM_WriteBehindTick()
+ * NVM_GovernorTick()
+ * NVM_GovernorStatus()
+ * NVM_WearLevelGet()
+ * NVM_StatsGet()
+ * NVM_StatsReset()
+ *
+ * Users have to be aware of the following limitations of the module:
+ * - Object IDs from 0 to 0xfc, or 0xfffc when NVM_OBJECT_ID_SIZE is 2.
+ * - Maximum NVM_MAX_NUMBER_OF_PAGES physical pages. Page IDs are 8 bit unless
+ *   NVM_MAX_NUMBER_OF_PAGES is above 255, and then below 0x7ffe.
+ * - With NVM_FEATURE_CHECKPOINT_ENABLED the page map must fit in one flash
+ *   page, which is about 220 pages of 512 bytes.
+ *
+ *******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#include <stdbool.h>
+#include "nvm.h"
+#include "nvm_hal.h"
+
+/***************************************************************************//**
+ * @addtogroup EM_Drivers
+ * @{
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @addtogroup NVM
+ * @{
+ ******************************************************************************/
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+/** Version constant of the NVM system. Is stored together with the datablocks
+ * so that it is easy to upgrade between different versions of the system. */
+#define NVM_VERSION              0x2U
+
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+/* The offset of an object is stored in its descriptor. Otherwise it is the
+ * sum of the sizes of the objects before it, counted while walking the page. */
+#define NVM_OBJECT_OFFSET(pPage, objectIndex, offsetAddress)   ((*(pPage))[(objectIndex)].offset)
+#else
+#define NVM_OBJECT_OFFSET(pPage, objectIndex, offsetAddress)   (offsetAddress)
+#endif
+
+/* Sizes. Internal sizes of different objects */
+#define NVM_CONTENT_SIZE         (NVM_PAGE_SIZE - (NVM_HEADER_SIZE + NVM_FOOTER_SIZE))
+#define NVM_WEAR_CONTENT_SIZE    (NVM_PAGE_SIZE - NVM_HEADER_SIZE)
+
+/* Generic constants. Clears up the code and make it more readable. */
+#define NVM_PAGE_EMPTY_VALUE                   0xffffU
+#define NVM_NO_PAGE_RETURNED                   0xffffffffUL
+#define NVM_INIT_NO_PAGE                       0xffffU
+#define NVM_NO_WRITE_8BIT                      0xffU
+#define NVM_NO_WRITE_16BIT                     0xffffU
+#define NVM_NO_WRITE_32BIT                     0xffffffffUL
+#define NVM_HIGHEST_32BIT                      0xffffffffUL
+#define NVM_FLIP_FIRST_BIT_OF_32_WHEN_WRITE    0xffff7fffUL
+#define NVM_FIRST_BIT_ONE                      0x8000U
+#define NVM_FIRST_BIT_ZERO                     0x7fffU
+#define NVM_LAST_BIT_ZERO                      0xfffeU
+
+#define NVM_CHECKSUM_INITIAL                   0xffffU
+#define NVM_CHECKSUM_LENGTH                    2U
+
+#define NVM_PAGES_PER_WEAR_HISTORY             8U
+#define NVM_PAGES_PER_VALIDATION_BYTE          8U
+
+/* Size of the buffer used when copying data between pages. */
+#define NVM_COPY_BUFFER_SIZE                   32U
+
+/* Page map checkpoints. The watermark is never a valid logical address. */
+#define NVM_CHECKPOINT_WATERMARK               0x7ffeU
+#define NVM_CHECKPOINT_NO_PAGE                 0xffffU
+#define NVM_CHECKPOINT_INFLIGHT_MAX            2U
+
+/* Macros for acquiring and releasing write lock. Currently empty but could be redefined */
+/* in RTOSes to add resources protection. Without it, it is not smart to call NVM module */
+/* from interrupts or other tasks without ensuring that it is not used by main thread.   */
+#ifndef NVM_ACQUIRE_WRITE_LOCK
+#define NVM_ACQUIRE_WRITE_LOCK
+#endif
+
+#ifndef NVM_RELEASE_WRITE_LOCK
+#define NVM_RELEASE_WRITE_LOCK
+#endif
+
+#if (NVM_FEATURE_READ_POINTER_ENABLED == true) && (NVMHAL_MEMORY_MAPPED != true)
+#error "NVM_FEATURE_READ_POINTER_ENABLED requires a memory mapped NVM (NVMHAL_MEMORY_MAPPED)."
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true) && (NVM_FEATURE_LAZY_VALIDATION_ENABLED != true)
+#error "NVM_FEATURE_CHECKPOINT_ENABLED requires NVM_FEATURE_LAZY_VALIDATION_ENABLED."
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true) && ((NVM_COUNTER_WRITES_PER_WORD > 32) || ((32 % NVM_COUNTER_WRITES_PER_WORD) != 0))
+#error "NVM_COUNTER_WRITES_PER_WORD must be 1, 2, 4, 8, 16 or 32."
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true) && (NVM_FEATURE_LOG_PAGES_ENABLED != true)
+#error "NVM_FEATURE_KV_ENABLED requires NVM_FEATURE_LOG_PAGES_ENABLED."
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true) && (NVM_FEATURE_LOG_PAGES_ENABLED != true)
+#error "NVM_FEATURE_EEPROM_ENABLED requires NVM_FEATURE_LOG_PAGES_ENABLED."
+#endif
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true) && (NVM_FEATURE_KV_ENABLED != true)
+#error "NVM_FEATURE_PACKED_PAGES_ENABLED requires NVM_FEATURE_KV_ENABLED."
+#endif
+
+#if (NVM_MAX_NUMBER_OF_PAGES > 32767)
+#error "NVM_MAX_NUMBER_OF_PAGES must be at most 32767."
+#endif
+
+#if (NVM_OBJECT_ID_SIZE != 1) && (NVM_OBJECT_ID_SIZE != 2)
+#error "NVM_OBJECT_ID_SIZE must be 1 or 2."
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true) && ((NVM_SPAN_MAX_SEGMENTS < 1) || (NVM_SPAN_MAX_SEGMENTS > 64))
+#error "NVM_SPAN_MAX_SEGMENTS must be from 1 to 64."
+#endif
+
+/* The page map of a checkpoint has got one entry for each page, which leaves
+ * out all but the first physical page of a spanning page. */
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true) && (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+#error "NVM_FEATURE_SPAN_PAGES_ENABLED cannot be used with NVM_FEATURE_CHECKPOINT_ENABLED."
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true) && (NVM_FEATURE_WEAR_PAGES_ENABLED != true)
+#error "NVM_FEATURE_HOT_PAGES_ENABLED requires NVM_FEATURE_WEAR_PAGES_ENABLED."
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true) && ((NVM_HOT_PAGE_THRESHOLD < 2) || (NVM_HOT_PAGE_THRESHOLD > 255))
+#error "NVM_HOT_PAGE_THRESHOLD must be from 2 to 255."
+#endif
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true) && (NVM_COLD_PAGE_THRESHOLD > 254)
+#error "NVM_COLD_PAGE_THRESHOLD must be at most 254."
+#endif
+
+/* The patch journal is used both by NVM_WriteRange and by in-place writes. */
+#if (NVM_FEATURE_WRITE_RANGE_ENABLED == true) || (NVM_FEATURE_WRITE_IN_PLACE_ENABLED == true)
+#define NVM_PATCH_ENABLED                      true
+#else
+#define NVM_PATCH_ENABLED                      false
+#endif
+
+/* Writes are held back in RAM both by the governor and by the write-behind
+ * cache. */
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true) || (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+#define NVM_PENDING_ENABLED                    true
+#else
+#define NVM_PENDING_ENABLED                    false
+#endif
+
+/* The recent writes to each page are counted both for hot pages and for
+ * hot/cold allocation. */
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true) || (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+#define NVM_WRITE_HISTORY_ENABLED              true
+#else
+#define NVM_WRITE_HISTORY_ENABLED              false
+#endif
+
+/* Macros for collecting run time statistics. They expand to nothing when the
+ * statistics feature is disabled, so the instrumentation costs neither code
+ * nor cycles in that case. */
+#if (NVM_FEATURE_STATS_ENABLED == true)
+
+/* Cycle counter used to time the API functions. Must be defined as a clock
+ * hook, e.g. when running on a host or a core without the DWT unit. */
+#ifndef NVM_STATS_CYCLES_GET
+#if defined(DWT)
+#define NVM_STATS_DWT_CYCLES
+#define NVM_STATS_CYCLES_GET()        (DWT->CYCCNT)
+#else
+#error "NVM_FEATURE_STATS_ENABLED needs the DWT cycle counter, or NVM_STATS_CYCLES_GET() defined as a clock hook."
+#endif
+#endif
+
+#define NVM_STATS_INC(counter)        nvmStats.counter++;
+#define NVM_STATS_TIMER_START         uint32_t nvmStatsCycles = NVM_STATS_CYCLES_GET();
+#define NVM_STATS_TIMER_STOP(api)     NVM_StatsTimingRecord((api), nvmStatsCycles);
+
+/* NVM_Init starts the cycle counter before it reads it. */
+#if defined(NVM_STATS_DWT_CYCLES)
+#define NVM_STATS_INIT_TIMER_START    uint32_t nvmStatsCycles = NVM_StatsCyclesStart();
+#else
+#define NVM_STATS_INIT_TIMER_START    NVM_STATS_TIMER_START
+#endif
+
+#else
+
+#define NVM_STATS_INC(counter)
+#define NVM_STATS_TIMER_START
+#define NVM_STATS_INIT_TIMER_START
+#define NVM_STATS_TIMER_STOP(api)
+
+#endif
+
+/** @endcond */
+
+/*******************************************************************************
+ ******************************   TYPEDEFS   ***********************************
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+/** Result types for the internal page validation function. */
+typedef enum
+{
+  nvmValidateResultOk       = 0, /**< Page validates. */
+  nvmValidateResultOkMarked = 1, /**< Page validates, but is marked for copying. */
+  nvmValidateResultOld      = 2, /**< Page has got an older version number. */
+  nvmValidateResultError    = 3  /**< Page does not validate. */
+} NVM_ValidateResult_t;
+
+/** A struct representing the header of each page stored in NVM. This is a
+ *  packed struct that is stored and retrieved from NVM directly. */
+typedef struct
+{
+  uint16_t watermark; /**< The watermark is made up of a update flag (1st bit) and the logical address of the page.  */
+  uint32_t updateId;  /**< The update id is the update id of this physical location in memory and sticks with it. */
+  uint16_t version;   /**< The version number of the API is also stored in the page for any future updates. */
+} NVM_Page_Header_t;
+
+/** size of page header on flash (not in RAM) */
+#define NVM_HEADER_SIZE          (2*sizeof(uint16_t)+sizeof(uint32_t))
+
+/** A struct representing the footer of each page stored in NVM. This is a
+ *  packed struct that is stored and retrieved from NVM directly. */
+typedef struct
+{
+  uint16_t checksum;  /**< Contains a 16 bit XOR checksum of the content of the page. */
+  uint16_t watermark; /**< Contains the same watermark as the opening of the page, but with the update bit always set to high.*/
+} NVM_Page_Footer_t;
+
+/** size of page footer on flash (not in RAM) */
+#define NVM_FOOTER_SIZE          (2*sizeof(uint16_t))
+
+#if (NVM_PATCH_ENABLED == true)
+/** A record in the patch journal of a normal page. The journal starts at the
+ *  first word after the objects, and each record is followed by its data,
+ *  padded to a whole word. The record is written in two steps, and only counts
+ *  when the second word, holding the check, is written. */
+typedef struct
+{
+  uint16_t offset;   /**< Offset of the patched bytes from the start of the page. */
+  uint16_t length;   /**< Number of patched bytes. */
+  uint16_t checksum; /**< Checksum of the page content after the patch. */
+  uint16_t check;    /**< Checksum of the rest of the record and the data. The last bit is always 0. */
+} NVM_Patch_Header_t;
+
+/** size of patch record header on flash (not in RAM) */
+#define NVM_PATCH_HEADER_SIZE    (4*sizeof(uint16_t))
+
+/** start of the patch journal for a given size of the page content */
+#define NVM_PATCH_JOURNAL_START(contentSize) \
+  ((NVM_HEADER_SIZE + (contentSize) + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1))
+
+/** size of the data of a patch record on flash, padded to a whole word */
+#define NVM_PATCH_DATA_SIZE(length) \
+  (((length) + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1))
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+/** A counter page holds a base value after the header, and the increments
+ *  after it. Each increment clears the next group of bits in the field. */
+#define NVM_COUNTER_FIELD_START  (NVM_HEADER_SIZE + sizeof(uint32_t))
+#define NVM_COUNTER_FIELD_WORDS  ((NVM_PAGE_SIZE - NVM_FOOTER_SIZE - NVM_COUNTER_FIELD_START) / sizeof(uint32_t))
+#define NVM_COUNTER_STEPS        (NVM_COUNTER_FIELD_WORDS * NVM_COUNTER_WRITES_PER_WORD)
+#define NVM_COUNTER_STEP_BITS    (32U / NVM_COUNTER_WRITES_PER_WORD)
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+/** Each physical page of a log, a segment, holds the sequence number of its
+ *  first record after the header, and the records after it. A record is a
+ *  length and a checksum followed by the data, padded to a whole word. */
+#define NVM_LOG_RECORDS_START       (NVM_HEADER_SIZE + sizeof(uint32_t))
+#define NVM_LOG_RECORD_HEADER_SIZE  (2*sizeof(uint16_t))
+#define NVM_LOG_RECORD_SIZE(len) \
+  (NVM_LOG_RECORD_HEADER_SIZE + (((len) + sizeof(uint32_t) - 1) & ~(sizeof(uint32_t) - 1)))
+#define NVM_LOG_RECORD_MAX          (NVM_PAGE_SIZE - NVM_LOG_RECORDS_START - NVM_LOG_RECORD_HEADER_SIZE)
+#define NVM_LOG_SEQUENCE_NONE       0xffffffffUL
+#define NVM_LOG_NO_SEGMENT          0xffffU
+/** Space for records in a segment. */
+#define NVM_LOG_SEGMENT_SPACE       (NVM_PAGE_SIZE - NVM_LOG_RECORDS_START)
+
+/** Log, key-value and EEPROM pages are all stored in log segments. */
+#define NVM_PAGE_TYPE_SEGMENTED(pageType) \
+  ((nvmPageTypeLog == (pageType)) || (nvmPageTypeKv == (pageType)) || (nvmPageTypeEeprom == (pageType)))
+
+/** Key-value and EEPROM pages reclaim their own segments instead of erasing
+ *  the oldest, and use one segment more while they do. */
+#define NVM_PAGE_TYPE_RECLAIMED(pageType) \
+  ((nvmPageTypeKv == (pageType)) || (nvmPageTypeEeprom == (pageType)))
+
+/** Result of reading a record header in a log segment. */
+typedef enum
+{
+  nvmLogRecordValid  = 0, /**< The record validates. */
+  nvmLogRecordEnd    = 1, /**< There are no more records in the segment. */
+  nvmLogRecordBroken = 2  /**< The record was not completely written, or is damaged. */
+} NVM_Log_Record_Result_t;
+
+/** The index of a log page kept in RAM. The segments are sorted by the
+ *  sequence number of their first record. */
+typedef struct
+{
+  uint16_t pageId;                                /**< The log page, or NVM_PAGE_EMPTY_VALUE if not in use. */
+  uint8_t  pageType;                              /**< The type of the page, log, key-value or EEPROM. */
+  uint8_t  segments;                              /**< The number of segments the log may use. */
+  uint8_t  count;                                 /**< The number of segments in use. */
+  uint16_t page[NVM_LOG_MAX_SEGMENTS];            /**< Physical page of each segment, oldest first. */
+  uint32_t firstSequence[NVM_LOG_MAX_SEGMENTS];   /**< Sequence number of the first record in each segment. */
+  uint16_t tailOffset;                            /**< Offset of the next record in the newest segment. */
+  uint32_t nextSequence;                          /**< Sequence number of the next record. */
+} NVM_Log_t;
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+/** The records of the key-value page hold the key before the value. A key
+ *  is deleted by a record of the key with the delete bit set, and no value. */
+#define NVM_KV_KEY_SIZE             sizeof(uint16_t)
+#define NVM_KV_KEY_MAX              0x7fffU
+#define NVM_KV_KEY_DELETED          0x8000U
+#define NVM_KV_KEY_NONE             0xffffU
+#define NVM_KV_NO_ENTRY             0xffffU
+#define NVM_KV_INDEX_SIZE           (2 * NVM_KV_MAX_KEYS)
+#define NVM_KV_COLLECT_ALL          0xffffU
+
+/** The objects of a packed page are the value of a key after the keys left
+ *  for NVM_KvSet, one for each page ID. */
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+#define NVM_KV_PACKED_KEY_BASE      0x7f00U
+#define NVM_KV_PACKED_KEY(pageId)   ((uint16_t)(NVM_KV_PACKED_KEY_BASE + (pageId)))
+#define NVM_KV_USER_KEY_MAX         (NVM_KV_PACKED_KEY_BASE - 1)
+#else
+#define NVM_KV_USER_KEY_MAX         NVM_KV_KEY_MAX
+#endif
+
+/** An entry in the hash index of the key-value page. */
+typedef struct
+{
+  uint16_t key;    /**< The key, or NVM_KV_KEY_NONE if the entry is free. */
+  uint16_t page;   /**< Physical page of the newest record of the key. */
+  uint16_t offset; /**< Offset of the record in the physical page. */
+  uint16_t len;    /**< Length of the value. */
+} NVM_Kv_Entry_t;
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+/** The records of the EEPROM page hold the address of the first byte
+ *  before the bytes written. When the segments are full, the content is
+ *  written to a new segment in chunks, leaving out those still erased. */
+#define NVM_EEPROM_ADDRESS_SIZE     sizeof(uint16_t)
+#define NVM_EEPROM_ERASED           0xffU
+#define NVM_EEPROM_CHUNK_SIZE       32
+#define NVM_EEPROM_IMAGE_SPACE \
+  (((NVM_EEPROM_SIZE + NVM_EEPROM_CHUNK_SIZE - 1) / NVM_EEPROM_CHUNK_SIZE) \
+   * NVM_LOG_RECORD_SIZE(NVM_EEPROM_ADDRESS_SIZE + NVM_EEPROM_CHUNK_SIZE))
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+/** Each physical page of a spanning page is stored as a normal page holding
+ *  the next NVM_CONTENT_SIZE bytes of the objects. The first has got the ID
+ *  of the page, and the others the number of the segment above it. */
+#define NVM_SPAN_SEGMENT_ID(pageId, segment)   ((uint16_t)((pageId) | ((uint16_t)(segment) << 8)))
+#define NVM_SPAN_PAGE_ID(segmentId)            ((uint16_t)((segmentId) & 0xffU))
+#define NVM_SPAN_SEGMENT(segmentId)            ((uint8_t)((segmentId) >> 8))
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+/** The content of a compressed page is the length of the encoded objects,
+ *  followed by them. A control byte below NVM_RLE_RUN_FLAG is followed by
+ *  that many literal bytes plus one, and a control byte with the flag set is
+ *  followed by a byte repeated the lower bits plus NVM_RLE_RUN_MIN times. */
+#define NVM_COMPRESSED_LENGTH_SIZE  sizeof(uint16_t)
+#define NVM_COMPRESSED_STREAM_SIZE  (NVM_CONTENT_SIZE - NVM_COMPRESSED_LENGTH_SIZE)
+#define NVM_RLE_RUN_FLAG            0x80U
+#define NVM_RLE_RUN_MIN             3U
+#define NVM_RLE_RUN_MAX             (0x7fU + NVM_RLE_RUN_MIN)
+#define NVM_RLE_LITERAL_MAX         0x80U
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+/** A normal page stored like a wear page has got NVM_HOT_VERSION instead of
+ *  NVM_VERSION in the header, so that its layout is known from the physical
+ *  page alone. The normal bit, which is set in NVM_VERSION, is programmed to 0
+ *  in it. An erased or partly programmed version word keeps the bit, and is
+ *  never taken for a promoted page. */
+#define NVM_HOT_VERSION_NORMAL      0x0002U
+#define NVM_HOT_VERSION             ((NVM_VERSION & ~NVM_HOT_VERSION_NORMAL) | 0x2000U)
+
+#if ((NVM_VERSION & NVM_HOT_VERSION_NORMAL) == 0)
+#error "The normal bit of NVM_HOT_VERSION must be set in NVM_VERSION."
+#endif
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+/** Pages staged by a transaction have got the staged bit set in the version
+ *  of the header. The open bit is cleared in the last page staged, which
+ *  commits the transaction, and both are cleared when a staged page replaces
+ *  the old version. */
+#define NVM_TX_VERSION_STAGED       0x8000U
+#define NVM_TX_VERSION_OPEN         0x4000U
+#define NVM_TX_VERSION_MASK         0x3fffU
+
+/** A page written by a transaction. */
+typedef struct
+{
+  uint16_t        pageId;   /**< Identifier of the page. */
+  NVM_Object_Id_t objectId; /**< Identifier of the object to write, or NVM_WRITE_ALL. */
+} NVM_Tx_Entry_t;
+#endif
+
+/** A range of bytes in an object, given with new data for the range. */
+typedef struct
+{
+  NVM_Object_Id_t objectId; /**< Identifier of the object. */
+  uint16_t        offset;   /**< Offset of the range from the start of the object. */
+  uint16_t        length;   /**< Number of bytes in the range. */
+  uint8_t const   *pData;   /**< The new data of the range. */
+} NVM_Write_Range_t;
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+/** Types of the records appended to a checkpoint page. */
+typedef enum
+{
+  nvmCheckpointRecordStart = 1, /**< A page is about to be written to a new physical page. */
+  nvmCheckpointRecordDone  = 2  /**< A page write is finished, and the page map points to the result. */
+} NVM_Checkpoint_Record_Type_t;
+
+/** A page write that has been started, but not finished. */
+typedef struct
+{
+  uint16_t pageIndex; /**< Index of the page in the page table. */
+  uint16_t page;      /**< Index of the physical page being written. */
+} NVM_Checkpoint_Inflight_t;
+
+/** The state stored at the start of a checkpoint page. Records of the page
+ *  writes that follow are appended after it. This struct is stored and
+ *  retrieved from NVM directly. */
+typedef struct
+{
+  uint32_t                  sequence;                                /**< Incremented for every checkpoint written. The highest one is the newest. */
+  uint16_t                  pages;                                   /**< Number of physical pages in the configuration. */
+  uint16_t                  userPages;                               /**< Number of user pages in the configuration. */
+  NVM_Checkpoint_Inflight_t inflight[NVM_CHECKPOINT_INFLIGHT_MAX];   /**< Page writes in progress. */
+  uint16_t                  map[NVM_MAX_NUMBER_OF_PAGES];            /**< Physical page of each page in the page table. */
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  uint8_t                   staticWearWriteHistory[(NVM_MAX_NUMBER_OF_PAGES+(NVM_PAGES_PER_WEAR_HISTORY-1))/NVM_PAGES_PER_WEAR_HISTORY]; /**< Static wear leveling history. */
+  uint16_t                  staticWearWritesInHistory;               /**< Static wear leveling write count. */
+  uint16_t                  staticWearErasesSinceReset;              /**< Static wear leveling erase count. */
+#endif
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  int64_t                   governorCredit;                          /**< Erase budget of the governor. */
+  uint32_t                  governorEraseTotal;                      /**< Sum of the erase counts in the page headers when the budget was stored. */
+#endif
+} NVM_Checkpoint_t;
+
+/** A record appended to a checkpoint page. This struct is stored and
+ *  retrieved from NVM directly. */
+typedef struct
+{
+  uint16_t type;      /**< NVM_Checkpoint_Record_Type_t of the record. */
+  uint16_t pageIndex; /**< Index of the page in the page table. */
+  uint16_t page;      /**< Index of the physical page. */
+  uint16_t check;     /**< Inverted XOR of the other fields, to detect a record torn by a power loss. */
+} NVM_Checkpoint_Record_t;
+
+/** The checkpoint is committed by writing its checksum and the inverted
+ *  checksum after it, which can never read as erased flash. */
+#define NVM_CHECKPOINT_COMMIT(checksum)        ((uint32_t)(checksum) | ((uint32_t)(uint16_t)~(checksum) << 16))
+#define NVM_CHECKPOINT_RECORD_CHECK(record)    ((uint16_t)~((record).type ^ (record).pageIndex ^ (record).page))
+
+/** Offset of the first record in a checkpoint page. */
+#define NVM_CHECKPOINT_RECORDS_OFFSET          (NVM_HEADER_SIZE + sizeof(NVM_Checkpoint_t) + sizeof(uint32_t))
+
+/* The page map is sized from NVM_MAX_NUMBER_OF_PAGES, and must leave room for
+ * a record in a checkpoint page. Compiling stops here if it does not. */
+typedef char NVM_Checkpoint_Fits[((NVM_CHECKPOINT_RECORDS_OFFSET + sizeof(NVM_Checkpoint_Record_t)) <= NVM_PAGE_SIZE) ? 1 : -1];
+#endif
+
+/** @endcond */
+
+/*******************************************************************************
+ *******************************   STATICS   ***********************************
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+/** Result types for the internal page validation function. */
+
+static NVM_Config_t const *nvmConfig;
+
+/* Watermark of every physical page, read once from the page headers by
+ * NVM_Init. Kept here rather than on the stack, as it grows with
+ * NVM_MAX_NUMBER_OF_PAGES. */
+static uint16_t nvmInitWatermarks[NVM_MAX_NUMBER_OF_PAGES];
+
+/* Validation result of every physical page that is not empty, found by
+ * NVM_Init. */
+static uint8_t  nvmInitValidationResults[NVM_MAX_NUMBER_OF_PAGES];
+
+/* Physical pages found by NVM_Init, in a bucket for each page ID modulo the
+ * number of physical pages. Each bucket is a list through nvmInitChain, and
+ * holds a single version of each page. */
+static uint16_t nvmInitBuckets[NVM_MAX_NUMBER_OF_PAGES];
+static uint16_t nvmInitChain[NVM_MAX_NUMBER_OF_PAGES];
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+/* Static wear leveling */
+
+/* Bit list that records which pages have been rewritten.
+ * The array contains number of pages divided by 8 bits in a byte. */
+static uint8_t nvmStaticWearWriteHistory[(NVM_MAX_NUMBER_OF_PAGES+(NVM_PAGES_PER_WEAR_HISTORY-1))/NVM_PAGES_PER_WEAR_HISTORY];
+
+/* Number of different page writes recorded in history. */
+static uint16_t nvmStaticWearWritesInHistory;
+
+/* Number of page erases performed since last rest. */
+static uint16_t nvmStaticWearErasesSinceReset;
+
+/* Stop recurring calls from causing mayhem. */
+static bool nvmStaticWearWorking = false;
+#endif
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+/* Bit list that records which physical pages have not been fully validated
+ * since startup. These are validated the first time they are used. */
+static uint8_t nvmValidationPending[(NVM_MAX_NUMBER_OF_PAGES+(NVM_PAGES_PER_VALIDATION_BYTE-1))/NVM_PAGES_PER_VALIDATION_BYTE];
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+/* Page map, together with the rest of the state stored in a checkpoint. */
+static NVM_Checkpoint_t nvmCheckpoint;
+
+/* True when the page map is in sync with the NVM, and checkpoints are kept. */
+static bool nvmCheckpointValid = false;
+
+/* Checkpoint page in use, and the offset of the next record within it. */
+static uint8_t  *nvmCheckpointPage;
+static uint16_t nvmCheckpointOffset;
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+/* Index of the segments of every log page, built by NVM_Init. */
+static NVM_Log_t nvmLogs[NVM_LOG_MAX_PAGES];
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+/* Hash index of the key-value page, using linear probing. */
+static NVM_Kv_Entry_t nvmKvIndex[NVM_KV_INDEX_SIZE];
+
+/* Segments of the key-value page, or NULL if there is none. */
+static NVM_Log_t *nvmKv;
+
+/* Number of keys, and the space used by their newest records. */
+static uint16_t nvmKvKeys;
+static uint32_t nvmKvLiveSize;
+
+/* Record in the oldest segment that the garbage collector checks next. */
+static uint16_t nvmKvCollectPage;
+static uint16_t nvmKvCollectOffset;
+#endif
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+/* Value of a packed page, put together before it is written. */
+static uint8_t nvmPackedBuffer[NVM_PACKED_PAGE_MAX_SIZE];
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+/* The parts of the objects held by a segment of a spanning page, described
+ * by NVM_SpanSegmentGet. */
+static NVM_Object_Descriptor_t nvmSpanObjects[NVM_SPAN_MAX_OBJECTS + 1];
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+/* Recent writes to each page in the page table, halved every
+ * NVM_HOT_PAGE_WINDOW writes. */
+static uint8_t  nvmHotWrites[NVM_MAX_NUMBER_OF_PAGES];
+static uint16_t nvmHotWindowWrites;
+/* Set once the counts have been halved. Only then do they tell which pages
+ * are seldom written. */
+static bool     nvmHotWindowDone;
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+/* Erase budget of the governor, counted in erases times the lifetime. It
+ * grows with the time counted by NVM_GovernorTick, up to the burst of the
+ * policy, and each erase takes one lifetime from it. */
+static int64_t  nvmGovernorCredit;
+/* Writes held back, and erases done, since NVM_Init. */
+static uint32_t nvmGovernorDeferred;
+static uint32_t nvmGovernorErases;
+#endif
+
+#if (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+/* Milliseconds since the last write held back by the write-behind cache. */
+static uint32_t nvmWriteBehindIdle;
+#endif
+
+#if (NVM_PENDING_ENABLED == true)
+/* Pages in the page table with writes held back, one bit each. */
+static uint8_t  nvmPendingPages[(NVM_MAX_NUMBER_OF_PAGES + 7) / 8];
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+/* Objects of a compressed page, put together before they are encoded or
+ * after they are decoded. */
+static uint8_t nvmCompressedBuffer[NVM_COMPRESSED_PAGE_MAX_SIZE];
+
+/* Content of a compressed page, encoded before it is written. */
+static uint8_t nvmCompressedContent[NVM_CONTENT_SIZE];
+
+/* The content of a compressed page as one object, described by
+ * NVM_CompressedContentGet. */
+static NVM_Object_Descriptor_t nvmCompressedObjects[2];
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+/* Content of the EEPROM page. */
+static uint8_t nvmEeprom[NVM_EEPROM_SIZE];
+
+/* Segments of the EEPROM page, or NULL if there is none. */
+static NVM_Log_t *nvmEepromLog;
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+/* Pages added to the open transaction. */
+static NVM_Tx_Entry_t nvmTx[NVM_TX_MAX_PAGES];
+static uint8_t        nvmTxCount;
+static bool           nvmTxOpen = false;
+#endif
+
+#if (NVM_FEATURE_VECTORED_ENABLED == true)
+/* The list given to NVM_WriteV, and the page of it being written. Selects
+ * the objects written from RAM when NVM_WRITE_VECTOR_CMD is used. */
+static NVM_Object_Ref_t const *nvmVectorRefs;
+static uint16_t               nvmVectorCount;
+static uint16_t               nvmVectorPageId;
+#endif
+
+#if (NVM_FEATURE_STATS_ENABLED == true)
+/* Run time statistics. The average cycle counts are calculated from the
+ * cycle totals when the statistics are read out. */
+static NVM_Stats_t nvmStats;
+static uint64_t    nvmStatsCyclesTotal[nvmStatsApiCount];
+#endif
+
+/** @endcond */
+
+/*******************************************************************************
+ ******************************   PROTOTYPES   *********************************
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+static uint8_t* NVM_PageFind(uint16_t pageId);
+static uint8_t* NVM_ScratchPageFindBest(void);
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+static uint8_t* NVM_ScratchPageFindWorn(void);
+#endif
+static NVM_Result_t NVM_PageErase(uint8_t *pPhysicalAddress);
+static NVM_Result_t NVM_InitPages(NVM_Config_t const *config);
+static NVM_Result_t NVM_InitResolve(uint16_t markedPage, uint16_t newPage, uint16_t *pKeptPage);
+static NVM_Result_t NVM_PageRelocate(uint16_t pageId, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId, uint8_t *pOldPhysicalAddress, NVM_Write_Range_t const *pRange, uint16_t version);
+static NVM_Result_t NVM_PageCopy(uint8_t *pDestination, uint8_t *pSource, uint16_t len, uint16_t *pChecksum);
+static NVM_Page_Descriptor_t NVM_PageGet(uint16_t pageId);
+static NVM_ValidateResult_t NVM_PageValidateHeader(uint8_t *pPhysicalAddress);
+static NVM_ValidateResult_t NVM_PageValidate(uint8_t *pPhysicalAddress);
+static NVM_Result_t NVM_PageOpen(uint16_t pageId, uint8_t **ppPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc);
+static NVM_Result_t NVM_ObjectRead(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+static NVM_Result_t NVM_PageWrite(uint16_t pageId, NVM_Object_Id_t objectId);
+static bool NVM_ObjectSelected(NVM_Object_Id_t objectId, NVM_Object_Id_t pageObjectId);
+
+#if (NVM_FEATURE_READ_POINTER_ENABLED == true) || (NVM_FEATURE_READ_INTO_ENABLED == true) \
+  || (NVM_FEATURE_WRITE_RANGE_ENABLED == true)
+static NVM_Result_t NVM_ObjectLocate(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId, uint16_t *pOffset, uint16_t *pSize);
+#endif
+
+#if (NVM_PATCH_ENABLED == true)
+static uint16_t NVM_PatchScan(uint8_t *pPhysicalAddress, uint16_t contentSize, NVM_Patch_Header_t *pNewest, uint16_t *pNewestOffset);
+static NVM_Result_t NVM_PagePatch(uint8_t *pPhysicalAddress, uint16_t contentSize, uint16_t pageOffset, uint16_t len, uint8_t const *pData);
+static bool NVM_PatchCheck(uint8_t *pPhysicalAddress, uint16_t contentSize, uint16_t checksum, uint16_t footerChecksum);
+#endif
+
+#if (NVM_FEATURE_WRITE_IN_PLACE_ENABLED == true)
+static NVM_Result_t NVM_ObjectPatch(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+static uint32_t NVM_CounterSteps(uint8_t *pPhysicalAddress);
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+static NVM_Result_t NVM_LogInit(void);
+static NVM_Log_t* NVM_LogGet(uint16_t pageId);
+static NVM_Log_Record_Result_t NVM_LogRecordCheck(uint8_t *pSegment, uint16_t offset, uint16_t *pLen);
+static NVM_Result_t NVM_LogRecordWrite(NVM_Log_t *pLog, uint8_t const *pPrefix, uint16_t prefixLen, uint8_t const *pData, uint16_t len);
+static NVM_Result_t NVM_LogSegmentOpen(NVM_Log_t *pLog);
+static NVM_Result_t NVM_LogSegmentDrop(NVM_Log_t *pLog);
+static void NVM_LogLocate(NVM_Log_t *pLog, uint32_t sequence, NVM_Log_Iterator_t *pIterator);
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+static NVM_Result_t NVM_KvInit(void);
+static uint16_t NVM_KvFind(uint16_t key);
+static bool NVM_KvInsert(uint16_t key, uint16_t page, uint16_t offset, uint16_t len);
+static void NVM_KvRemove(uint16_t index);
+static NVM_Result_t NVM_KvRecordWrite(uint16_t key, void const *pData, uint16_t len);
+static NVM_Result_t NVM_KvValueWrite(uint16_t key, void const *pData, uint16_t len);
+static NVM_Result_t NVM_KvCollect(uint16_t steps);
+#endif
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+static NVM_Result_t NVM_PackedRead(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+static NVM_Result_t NVM_PackedWrite(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+static NVM_Page_Descriptor_t NVM_SpanSegmentGet(NVM_Page_Descriptor_t const *pPageDesc, uint8_t segment);
+static NVM_Result_t NVM_SpanRead(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+static NVM_Result_t NVM_SpanWrite(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+static bool NVM_SpanSegmentChanged(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pSegmentDesc, NVM_Object_Id_t objectId);
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+static bool NVM_HotPromoted(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t const *pPageDesc);
+static void NVM_HotLayoutGet(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc);
+static bool NVM_HotPageCheck(NVM_Page_Descriptor_t const *pPageDesc, uint8_t writes, bool promoted);
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+static uint8_t NVM_WriteHistoryAdd(uint16_t pageId);
+#endif
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+static uint8_t NVM_WriteHistoryGet(uint16_t pageId);
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+static void NVM_GovernorReset(void);
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+static uint32_t NVM_GovernorEraseTotal(void);
+static void NVM_GovernorRestore(int64_t credit, uint32_t eraseTotal);
+#endif
+static bool NVM_GovernorThrottled(void);
+static bool NVM_GovernorDefers(NVM_Page_Descriptor_t const *pPageDesc);
+static void NVM_GovernorErase(void);
+#endif
+
+#if (NVM_PENDING_ENABLED == true)
+static NVM_Result_t NVM_PendingCheck(uint16_t pageId, NVM_Object_Id_t objectId);
+static bool NVM_PendingGet(uint16_t pageId);
+static void NVM_PendingSet(uint16_t pageId, bool pending);
+static NVM_Result_t NVM_PendingWrite(uint16_t pageId);
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+static NVM_Page_Descriptor_t NVM_CompressedContentGet(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t const *pPageDesc);
+static uint16_t NVM_CompressedDecode(uint8_t *pPhysicalAddress);
+static NVM_Result_t NVM_CompressedRead(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId);
+static NVM_Result_t NVM_CompressedWrite(uint16_t pageId, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId, uint8_t *pOldPhysicalAddress);
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+static NVM_Result_t NVM_EepromInit(void);
+static NVM_Result_t NVM_EepromCompact(void);
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+static NVM_Result_t NVM_TxResolve(bool *pCommitted);
+#endif
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+static NVM_ValidateResult_t NVM_PageValidateDeferred(uint8_t *pPhysicalAddress);
+static void NVM_ValidationPendingSet(uint8_t *pPhysicalAddress, bool pending);
+#endif
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+static uint16_t NVM_WearIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc);
+static bool NVM_WearReadIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, uint16_t *pIndex);
+#endif
+
+static void NVM_ChecksumAdditive(uint16_t *pChecksum, void *pBuffer, uint16_t len);
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+static void NVM_StaticWearReset(void);
+static void NVM_StaticWearUpdate(uint16_t address);
+static NVM_Result_t NVM_StaticWearCheck(void);
+static uint32_t NVM_StaticWearSpread(void);
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+static bool NVM_StaticWearParked(uint16_t pageId);
+#endif
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+static uint16_t NVM_PageIndexGet(uint16_t pageId);
+static void NVM_CheckpointMapClear(void);
+static bool NVM_CheckpointApply(NVM_Checkpoint_Record_t const *pRecord);
+static bool NVM_CheckpointLoad(void);
+static NVM_Result_t NVM_CheckpointResolve(void);
+static NVM_Result_t NVM_CheckpointWrite(void);
+static void NVM_CheckpointRecord(NVM_Checkpoint_Record_Type_t type, uint16_t pageId, uint8_t *pPhysicalAddress);
+static void NVM_CheckpointInvalidate(void);
+static NVM_Result_t NVM_CheckpointPageErase(uint8_t *pPhysicalAddress);
+#endif
+
+#if (NVM_FEATURE_STATS_ENABLED == true)
+static void NVM_StatsTimingRecord(NVM_Stats_Api_t api, uint32_t startCycles);
+#if defined(NVM_STATS_DWT_CYCLES)
+static uint32_t NVM_StatsCyclesStart(void);
+#endif
+#endif
+/** @endcond */
+
+/*******************************************************************************
+ ***************************   GLOBAL FUNCTIONS   ******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Initialize the NVM manager.
+ *
+ * @details
+ *   Use this function to initialize and validate the NVM. Should be run on
+ *   startup. The result of this process is then returned in the form of a
+ *   NVM_Result_t.
+ *
+ *   The header of every physical page is read once into a table in RAM, and
+ *   pages left behind by an interrupted write are resolved from that table.
+ *
+ *   With NVM_FEATURE_LAZY_VALIDATION_ENABLED only the page headers and footers
+ *   are checked here. The checksum of each page is then verified the first
+ *   time it is read or written, and a corrupt page is reported as
+ *   nvmResultDataInvalid by that call instead of by NVM_Init. Pages involved
+ *   in an interrupted write are still fully validated here.
+ *
+ *   With NVM_FEATURE_CHECKPOINT_ENABLED and a checkpoint area in the
+ *   configuration, the page map is loaded from the newest checkpoint instead,
+ *   and only the pages of writes interrupted after it are read. The pages are
+ *   scanned as described above if there is no usable checkpoint, and a new
+ *   checkpoint is written from the result.
+ *
+ *   If nvmResultOk is returned, everything went according to plan and you
+ *   can use the API right away. If nvmResultNoPages is returned this is a
+ *   device that validates, but is empty. The proper way to handle this is to
+ *   first reset the memory using NVM_Erase, and then write any initial
+ *   data.
+ *
+ *   If a nvmResultError, or anything more specific, is returned something
+ *   irreparable happened, and the system cannot be used reliably. A simple
+ *   solution to this would be to erase and reinitialize, but this will then
+ *   cause data loss.
+ *
+ * @param[in] config
+ *   Pointer to structure defining NVM area.
+ *
+ * @return
+ *   Returns the result of the initialization using a
+ *   NVM_InitResult_TypeDef.
+ ******************************************************************************/
+NVM_Result_t NVM_Init(NVM_Config_t const *config)
+{
+  NVM_Result_t result;
+
+  NVM_STATS_INIT_TIMER_START
+
+  result = NVM_InitPages(config);
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiInit)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Validate the NVM area and build the page map for NVM_Init.
+ *
+ * @details
+ *   Holds the work of NVM_Init, which times it as one call with the
+ *   statistics feature.
+ *
+ * @param[in] config
+ *   Pointer to structure defining NVM area.
+ *
+ * @return
+ *   Returns the result of the initialization.
+ ******************************************************************************/
+static NVM_Result_t NVM_InitPages(NVM_Config_t const *config)
+{
+  uint16_t     page;
+  /* Physical page holding another version of the current page, and the one
+   * of the two that is kept. */
+  uint16_t     duplicate;
+  uint16_t     kept;
+  /* Page ID of the current page, and the link to it in its bucket. */
+  uint16_t     pageId;
+  uint16_t     *pLink;
+  /* Set if an interrupted write has lost the new version of its page. */
+  bool         interrupted;
+  /* Variable to store the result returned at the end. */
+  NVM_Result_t result = nvmResultErrorInitial;
+
+  /* Physical address of the current page. */
+  uint8_t *pPhysicalAddress = (uint8_t *)(config->nvmArea);
+
+  /* Temporary variable to store results of a erase operation. */
+  NVM_Result_t         eraseResult;
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Result of building the index of the log pages. */
+  NVM_Result_t         logResult;
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+  /* Set if an interrupted transaction was committed. */
+  bool                 txCommitted;
+#endif
+
+  /* if there is no spare page, return error */
+  if( (config->pages <= config->userPages) || (config->pages > NVM_MAX_NUMBER_OF_PAGES) )
+  {
+    return nvmResultError;
+  }
+
+  /* now check that page structures fits to physical page size */
+  { 
+    uint16_t pageIdx = 0, obj = 0, sum = 0;
+    const NVM_Page_Descriptor_t *current_page;
+    /* Physical pages used in addition to one for each page. */
+    uint16_t extraPages = 0;
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+    uint16_t logPages = 0;
+#endif
+#if (NVM_FEATURE_KV_ENABLED == true)
+    uint16_t kvPages = 0;
+#endif
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+    uint16_t eepromPages = 0;
+#endif
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+    uint16_t packedPages = 0;
+#endif
+#if (NVM_MAX_NUMBER_OF_PAGES > 255) && (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+    uint16_t otherIdx;
+#endif
+    
+    for(pageIdx=0;pageIdx < config->userPages; pageIdx++)
+    { 
+      sum = 0;
+      obj = 0;
+      current_page = &((*(config->nvmPages))[pageIdx]);
+
+#if (NVM_MAX_NUMBER_OF_PAGES > 255)
+      /* The page ID is stored in the watermark, where the highest values are
+       * reserved. */
+      if( current_page->pageId >= NVM_CHECKPOINT_WATERMARK )
+      {
+        return nvmResultError;
+      }
+#endif
+
+      /* Log, key-value and EEPROM pages have got no objects. */
+      while( (NULL != current_page->page) && ((*(current_page->page))[obj].size != 0) )
+      {
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+        /* The stored offsets must be those of NVM_PAGE_LAYOUT, which lays out
+         * the objects one after the other. */
+        if( (*(current_page->page))[obj].offset != sum )
+        {
+          return nvmResultError; /* object descriptor without its offset */
+        }
+#endif
+        sum += (*(current_page->page))[obj++].size;
+      }
+
+      if(current_page->pageType == nvmPageTypeNormal)
+      {
+        if( sum > NVM_CONTENT_SIZE )
+        {
+          return nvmResultError; /* objects bigger than page size */
+        }
+      } 
+      else
+      {
+        if(current_page->pageType == nvmPageTypeWear)
+        {
+          if( ((sum+NVM_CHECKSUM_LENGTH) > NVM_WEAR_CONTENT_SIZE)
+              || (NULL == (*(current_page->page))[0].location) )
+          {
+            return nvmResultError; /* objects bigger than page size */
+          }
+        }
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypeCounter)
+        {
+          if( (obj != 1) || (sum != sizeof(uint32_t)) )
+          {
+            return nvmResultError; /* counter pages hold a single uint32_t */
+          }
+        }
+#endif
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypeLog)
+        {
+          if( (current_page->segments < 2) || (current_page->segments > NVM_LOG_MAX_SEGMENTS)
+              || (++logPages > NVM_LOG_MAX_PAGES) )
+          {
+            return nvmResultError; /* log index too small */
+          }
+          extraPages += current_page->segments - 1;
+        }
+#endif
+#if (NVM_FEATURE_KV_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypeKv)
+        {
+          /* The garbage collector uses one segment more. */
+          if( (current_page->segments < 2) || (current_page->segments >= NVM_LOG_MAX_SEGMENTS)
+              || (++logPages > NVM_LOG_MAX_PAGES) || (++kvPages > 1) )
+          {
+            return nvmResultError; /* log index too small, or more than one key-value page */
+          }
+          extraPages += current_page->segments;
+        }
+#endif
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypeEeprom)
+        {
+          /* Compaction uses one segment more, and must leave room for a
+           * write after the content. */
+          if( (current_page->segments < 1) || (current_page->segments >= NVM_LOG_MAX_SEGMENTS)
+              || (++logPages > NVM_LOG_MAX_PAGES) || (++eepromPages > 1)
+              || ((NVM_EEPROM_IMAGE_SPACE + NVM_LOG_RECORD_SIZE(NVM_EEPROM_ADDRESS_SIZE + 1)) > NVM_LOG_SEGMENT_SPACE) )
+          {
+            return nvmResultError; /* log index too small, more than one EEPROM page, or EEPROM too big */
+          }
+          extraPages += current_page->segments;
+        }
+#endif
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypePacked)
+        {
+          /* The value must fit in the buffer and in a record. */
+          if( (NULL == current_page->page) || (sum > NVM_PACKED_PAGE_MAX_SIZE)
+              || (sum > (NVM_LOG_RECORD_MAX - NVM_KV_KEY_SIZE))
+#if (NVM_MAX_NUMBER_OF_PAGES > 255)
+              || (current_page->pageId > 0xffU) /* the key holds 8 bits of it */
+#endif
+              )
+          {
+            return nvmResultError; /* objects bigger than a value */
+          }
+          packedPages++;
+        }
+#endif
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypeCompressed)
+        {
+          if( (NULL == current_page->page) || (0 == sum) || (sum > NVM_COMPRESSED_PAGE_MAX_SIZE) )
+          {
+            return nvmResultError; /* objects bigger than the buffer */
+          }
+        }
+#endif
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+        else if(current_page->pageType == nvmPageTypeSpan)
+        {
+          if( (NULL == current_page->page) || (0 == sum) || (obj > NVM_SPAN_MAX_OBJECTS)
+              || (sum > (NVM_SPAN_MAX_SEGMENTS * NVM_CONTENT_SIZE)) )
+          {
+            return nvmResultError; /* objects bigger than all the segments */
+          }
+#if (NVM_MAX_NUMBER_OF_PAGES > 255)
+          /* The other segments have got IDs above 255 with the same lower
+           * 8 bits, which no other page may use. */
+          for(otherIdx=0;otherIdx < config->userPages; otherIdx++)
+          {
+            if( (current_page->pageId > 0xffU)
+                || (((*(config->nvmPages))[otherIdx].pageId > 0xffU)
+                    && (((*(config->nvmPages))[otherIdx].pageId & 0xffU) == current_page->pageId)) )
+            {
+              return nvmResultError;
+            }
+          }
+#endif
+          extraPages += ((sum + NVM_CONTENT_SIZE - 1) / NVM_CONTENT_SIZE) - 1;
+        }
+#endif
+        else
+          {
+            return nvmResultError; /* unknown page type */
+          }
+      }
+    }
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+    /* Packed pages are stored in the key-value page. */
+    if( (0 != packedPages) && (0 == kvPages) )
+    {
+      return nvmResultError;
+    }
+#endif
+
+    /* There must still be a spare page when every log is full and every
+     * segment is written. Packed pages have got no physical page of their
+     * own. */
+    if( (config->userPages + extraPages) >= (config->pages
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+                                             + packedPages
+#endif
+                                             ) )
+    {
+      return nvmResultError;
+    }
+  }
+
+  nvmConfig = config;
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  /* Initialize the NVM. */
+  NVMHAL_Init();
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  /* Initialize the static wear leveling functionality. */
+  NVM_StaticWearReset();
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+  /* The write counts start over. */
+  for (page = 0; page < NVM_MAX_NUMBER_OF_PAGES; ++page)
+  {
+    nvmHotWrites[page] = 0;
+  }
+  nvmHotWindowWrites = 0;
+  nvmHotWindowDone   = false;
+#endif
+
+#if (NVM_PENDING_ENABLED == true)
+  /* No writes are held back. */
+  for (page = 0; page < sizeof(nvmPendingPages); ++page)
+  {
+    nvmPendingPages[page] = 0;
+  }
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  /* The erase budget starts full. */
+  NVM_GovernorReset();
+#endif
+
+#if (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+  nvmWriteBehindIdle = 0;
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  nvmCheckpointValid = false;
+  nvmCheckpointPage  = 0;
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+  /* Finish or undo a transaction interrupted by a power loss, before any page
+   * is looked up. */
+  nvmTxOpen  = false;
+  nvmTxCount = 0;
+  if (nvmResultOk != NVM_TxResolve(&txCommitted))
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+
+    return nvmResultError;
+  }
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  /* The page map of the checkpoint does not include the pages of the
+   * transaction, so the pages are scanned instead. */
+  if (txCommitted && (0 != nvmConfig->checkpointArea))
+  {
+    NVM_CheckpointInvalidate();
+  }
+#endif
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  /* Use the page map from the newest checkpoint if there is one. Only the
+   * pages of writes that were interrupted after it need to be checked. */
+  if ((0 != nvmConfig->checkpointArea) && NVM_CheckpointLoad())
+  {
+    result = NVM_CheckpointResolve();
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+    /* The segments of the log pages are not in the page map. */
+    logResult = NVM_LogInit();
+    if (nvmResultError == logResult)
+    {
+      result = nvmResultError;
+    }
+    else if ((nvmResultOk == logResult) && (nvmResultNoPages == result))
+    {
+      result = nvmResultOk;
+    }
+#endif
+
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+
+    return result;
+  }
+#endif
+
+  /* No page IDs have been seen yet. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    nvmInitBuckets[page] = NVM_INIT_NO_PAGE;
+  }
+
+  /* Run through all pages once. Read the header of each page into the page
+   * table, and check if it validates if it contains content. A page that
+   * validates, but is marked for write, might have a newer version with the
+   * same page ID and the write bit still set, left by an interrupted write.
+   * The pages are kept in a bucket for their page ID, so the two versions are
+   * resolved when the second one is read. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    /* Read the logical address of the page stored at the current physical
+     * address, and compare it to the value of an empty page. */
+    NVMHAL_Read(pPhysicalAddress, &nvmInitWatermarks[page], sizeof(nvmInitWatermarks[page]));
+    if (NVM_PAGE_EMPTY_VALUE != nvmInitWatermarks[page])
+    {
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+      /* Only check the header and footer now. The content is validated the
+       * first time the page is used. */
+      nvmInitValidationResults[page] = NVM_PageValidateHeader(pPhysicalAddress);
+      NVM_ValidationPendingSet(pPhysicalAddress, true);
+#else
+      nvmInitValidationResults[page] = NVM_PageValidate(pPhysicalAddress);
+#endif
+
+      if ((nvmValidateResultOk == nvmInitValidationResults[page])
+          || (nvmValidateResultOkMarked == nvmInitValidationResults[page]))
+      {
+        /* Look for another version of the page in the bucket of its ID. */
+        pageId = nvmInitWatermarks[page] & NVM_FIRST_BIT_ZERO;
+        pLink  = &nvmInitBuckets[pageId % nvmConfig->pages];
+        while ((NVM_INIT_NO_PAGE != *pLink)
+               && ((nvmInitWatermarks[*pLink] & NVM_FIRST_BIT_ZERO) != pageId))
+        {
+          pLink = &nvmInitChain[*pLink];
+        }
+
+        if (NVM_INIT_NO_PAGE == *pLink)
+        {
+          /* First version of the page. */
+          nvmInitChain[page] = NVM_INIT_NO_PAGE;
+          *pLink             = page;
+        }
+        else if (nvmInitValidationResults[*pLink] != nvmInitValidationResults[page])
+        {
+          /* One version is marked, and the other one is not. The one that is
+           * kept takes the place of the other one in the bucket. */
+          duplicate = *pLink;
+          if (nvmValidateResultOkMarked == nvmInitValidationResults[page])
+          {
+            eraseResult = NVM_InitResolve(page, duplicate, &kept);
+          }
+          else
+          {
+            eraseResult = NVM_InitResolve(duplicate, page, &kept);
+          }
+          nvmInitChain[kept] = nvmInitChain[duplicate];
+          *pLink             = kept;
+
+          /* Something went wrong */
+          if (nvmResultOk != eraseResult)
+          {
+            result = nvmResultError;
+          }
+        }
+      }
+    }
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+    else
+    {
+      NVM_ValidationPendingSet(pPhysicalAddress, false);
+    }
+#endif
+
+    /* Go to the next physical page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  } /* End pages loop. */
+
+  /* A page that is still marked has lost its new version. If the write was
+   * interrupted before the watermark of the new version could be read, the
+   * new version is found as a page that does not validate. */
+  interrupted = false;
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    if ((NVM_PAGE_EMPTY_VALUE != nvmInitWatermarks[page])
+        && (nvmValidateResultOkMarked == nvmInitValidationResults[page]))
+    {
+      interrupted = true;
+    }
+  }
+
+  /* Check the pages that are left after resolving the interrupted writes. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    if (NVM_PAGE_EMPTY_VALUE != nvmInitWatermarks[page])
+    {
+      if ((nvmValidateResultOk == nvmInitValidationResults[page])
+          || (nvmValidateResultOkMarked == nvmInitValidationResults[page]))
+      {
+        /* We have found a valid page, so the initial error can be changed to an
+         * OK result. */
+        if (nvmResultErrorInitial == result)
+        {
+          result = nvmResultOk;
+        }
+      }
+      else if (interrupted)
+      {
+        /* What is left of the new version of an interrupted write. */
+        if (nvmResultOk != NVM_PageErase((uint8_t *)(nvmConfig->nvmArea) + page * NVM_PAGE_SIZE))
+        {
+          result = nvmResultError;
+        }
+        nvmInitWatermarks[page] = NVM_PAGE_EMPTY_VALUE;
+      }
+      else
+      {
+        /* Page does not validate */
+        result = nvmResultError;
+      }
+    }
+  }
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Build the index of the log pages from the segments found. */
+  logResult = NVM_LogInit();
+  if (nvmResultError == logResult)
+  {
+    result = nvmResultError;
+  }
+  else if ((nvmResultOk == logResult) && (nvmResultErrorInitial == result))
+  {
+    result = nvmResultOk;
+  }
+#endif
+
+  /* If no pages was found, the system is not in use and should be reset. */
+  if (nvmResultErrorInitial == result)
+  {
+    result = nvmResultNoPages;
+  }
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  /* Store the page map found, so that the next startup can skip the scan. */
+  if ((0 != nvmConfig->checkpointArea) && (nvmResultError != result))
+  {
+    /* Index of the page in the page table. */
+    uint16_t pageIndex;
+
+    NVM_CheckpointMapClear();
+    for (page = 0; page < nvmConfig->pages; ++page)
+    {
+      if (NVM_PAGE_EMPTY_VALUE != nvmInitWatermarks[page])
+      {
+        pageIndex = NVM_PageIndexGet(nvmInitWatermarks[page] & NVM_FIRST_BIT_ZERO);
+        if ((NVM_CHECKPOINT_NO_PAGE != pageIndex)
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+            && !NVM_PAGE_TYPE_SEGMENTED((*(nvmConfig->nvmPages))[pageIndex].pageType)
+#endif
+            )
+        {
+          nvmCheckpoint.map[pageIndex] = page;
+        }
+      }
+    }
+
+    nvmCheckpointValid = (nvmResultOk == NVM_CheckpointWrite());
+  }
+#endif
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erase the entire NVM.
+ *
+ * @details
+ *   Use this function to erase the entire non-volatile memory area allocated to
+ *   the NVM system. It is possible to set a fixed erasure count for all the
+ *   pages, or retain the existing one. To retain the erasure count might not be
+ *   advisable if an error has occurred since this data may also have been
+ *   damaged.
+ *
+ * @param[in] erasureCount
+ *   Specifies which erasure count to set for the blank pages. Pass
+ *   NVM_ERASE_RETAINCOUNT to retain the erasure count.
+ *
+ * @return
+ *   Returns the result of the erase operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_Erase(uint32_t erasureCount)
+{
+  uint16_t     page;
+  /* Result used when returning from the function. */
+  NVM_Result_t result = nvmResultErrorInitial;
+
+  /* Location of physical page. */
+  uint8_t *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+
+  /* Container for moving old erasure count, or set to new. */
+  uint32_t tempErasureCount = erasureCount;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+
+  /* Loop over all the pages, as long as everything is OK. */
+  for (page = 0;
+       (page < nvmConfig->pages) && ((nvmResultOk == result) || (nvmResultErrorInitial == result));
+       ++page)
+  {
+    /* If erasureCount input is set to the retain constant, we need to get the
+     * old erasure count before we erase the page. */
+    if (NVM_ERASE_RETAINCOUNT == erasureCount)
+    {
+      /* Read old erasure count. */
+      NVMHAL_Read(pPhysicalAddress + 2, &tempErasureCount, sizeof(tempErasureCount));
+    }
+
+    /* Erase page. */
+    result = NVMHAL_PageErase(pPhysicalAddress);
+    NVM_STATS_INC(pageErases)
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+    NVM_ValidationPendingSet(pPhysicalAddress, false);
+#endif
+
+    /* If still OK, write erasure count to page. */
+    if (nvmResultOk == result)
+    {
+      result = NVMHAL_Write(pPhysicalAddress + 2, &tempErasureCount, sizeof(tempErasureCount));
+    }
+
+    /* Go to the next physical page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  /* Start over with a checkpoint of the empty page map. */
+  if ((nvmResultOk == result) && (0 != nvmConfig->checkpointArea))
+  {
+    NVM_CheckpointMapClear();
+    nvmCheckpointValid = (nvmResultOk == NVM_CheckpointWrite());
+  }
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Start over with empty logs. */
+  NVM_LogInit();
+#endif
+
+#if (NVM_PENDING_ENABLED == true)
+  /* Writes held back are dropped with the rest. */
+  for (page = 0; page < sizeof(nvmPendingPages); ++page)
+  {
+    nvmPendingPages[page] = 0;
+  }
+#endif
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiErase)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write an object or a page.
+ *
+ * @details
+ *   Use this function to write an object or an entire page to NVM. It takes a
+ *   page and an object and updates this object with the data pointed to by the
+ *   corresponding page entry. All the objects in a page can be written
+ *   simultaneously by using NVM_WRITE_ALL instead of an object ID. For "normal"
+ *   pages it simply finds not used page in flash (with lowest erase counter) and
+ *   copies all objects belonging to this page updating objects defined by 
+ *   objectId argument. For "wear" pages function tries to find spare place in 
+ *   already used page and write object here - if there is no free space it uses
+ *   new page invalidating previously used one.
+ *
+ * @param[in] pageId
+ *   Identifier of the page you want to write to NVM.
+ *
+ * @param[in] objectId
+ *   Identifier of the object you want to write. May be set to NVM_WRITE_ALL
+ *   to write the entire page to memory.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_Write(uint16_t pageId, NVM_Object_Id_t objectId)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+#if (NVM_PENDING_ENABLED == true)
+  result = NVM_PendingCheck(pageId, objectId);
+#else
+  result = NVM_PageWrite(pageId, objectId);
+#endif
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiWrite)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read an object or an entire page.
+ *
+ * @details
+ *   Use this function to read an object or an entire page from memory. It takes
+ *   a page id and an object id (or the NVM_READ_ALL constant to read
+ *   everything) and reads data from flash and puts it in the memory locations
+ *   given in the page specification.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to read from.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to read. Can be set to NVM_READ_ALL to read
+ *   an entire page.
+ *
+ * @return
+ *   Returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_Read(uint16_t pageId, NVM_Object_Id_t objectId)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result;
+
+  /* Physical address of the page to read from. */
+  uint8_t *pPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+#if (NVM_PENDING_ENABLED == true)
+  /* The objects of a page with writes held back are newer in RAM. */
+  if (NVM_PendingGet(pageId))
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+
+    NVM_STATS_TIMER_STOP(nvmStatsApiRead)
+    return nvmResultOk;
+  }
+#endif
+
+  result = NVM_PageOpen(pageId, &pPhysicalAddress, &pageDesc);
+  if (nvmResultOk == result)
+  {
+    result = NVM_ObjectRead(pPhysicalAddress, &pageDesc, objectId);
+  }
+
+  if (nvmResultOk == result)
+  {
+    NVM_STATS_INC(reads)
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiRead)
+  return result;
+}
+
+#if (NVM_FEATURE_VECTORED_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Read a list of objects from several pages.
+ *
+ * @details
+ *   Reads the same objects as NVM_Read would for each entry in the list, but
+ *   every page is found and validated only once, and all its objects are read
+ *   in one pass. Reading stops at the first page that fails, and the pages
+ *   before it have been read.
+ *
+ * @param[in] pRefs
+ *   The objects to read. A page may be listed several times, and
+ *   NVM_READ_ALL reads the entire page.
+ *
+ * @param[in] count
+ *   Number of entries in the list.
+ *
+ * @return
+ *   Returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_ReadV(NVM_Object_Ref_t const *pRefs, uint16_t count)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical address of the page to read from. */
+  uint8_t *pPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Entry that starts a page, entry of the same page, and earlier entry. */
+  uint16_t i;
+  uint16_t j;
+  uint16_t k;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == pRefs) && (0 != count))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiReadV)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  for (i = 0; (i < count) && (nvmResultOk == result); i++)
+  {
+    /* Skip pages handled by an earlier entry. */
+    for (k = 0; (k < i) && (pRefs[k].pageId != pRefs[i].pageId); k++)
+    {
+    }
+    if (k < i)
+    {
+      continue;
+    }
+
+#if (NVM_PENDING_ENABLED == true)
+    /* The objects of a page with writes held back are newer in RAM. */
+    if (NVM_PendingGet(pRefs[i].pageId))
+    {
+      continue;
+    }
+#endif
+
+    result = NVM_PageOpen(pRefs[i].pageId, &pPhysicalAddress, &pageDesc);
+
+    /* Read every object listed for this page. */
+    for (j = i; (j < count) && (nvmResultOk == result); j++)
+    {
+      if (pRefs[j].pageId == pRefs[i].pageId)
+      {
+        result = NVM_ObjectRead(pPhysicalAddress, &pageDesc, pRefs[j].objectId);
+
+        if (nvmResultOk == result)
+        {
+          NVM_STATS_INC(reads)
+        }
+      }
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiReadV)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write a list of objects to several pages.
+ *
+ * @details
+ *   Writes the same objects as NVM_Write would for each entry in the list, but
+ *   every page is written only once, with all the objects listed for it
+ *   written from RAM in the same relocation. Writing stops at the first page
+ *   that fails, and the pages before it have been written. Use a transaction
+ *   if the pages must be replaced together.
+ *
+ * @param[in] pRefs
+ *   The objects to write. A page may be listed several times, and
+ *   NVM_WRITE_ALL writes the entire page.
+ *
+ * @param[in] count
+ *   Number of entries in the list.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_WriteV(NVM_Object_Ref_t const *pRefs, uint16_t count)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Objects to write in the current page. */
+  NVM_Object_Id_t objectId;
+
+  /* Entry that starts a page, entry of the same page, and earlier entry. */
+  uint16_t i;
+  uint16_t j;
+  uint16_t k;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == pRefs) && (0 != count))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiWriteV)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  nvmVectorRefs  = pRefs;
+  nvmVectorCount = count;
+
+  for (i = 0; (i < count) && (nvmResultOk == result); i++)
+  {
+    /* Skip pages handled by an earlier entry. */
+    for (k = 0; (k < i) && (pRefs[k].pageId != pRefs[i].pageId); k++)
+    {
+    }
+    if (k < i)
+    {
+      continue;
+    }
+
+    /* A page with one object listed is written as by NVM_Write. With
+     * different objects the list itself selects them. */
+    objectId = pRefs[i].objectId;
+    for (j = i + 1; j < count; j++)
+    {
+      if ((pRefs[j].pageId == pRefs[i].pageId) && (pRefs[j].objectId != objectId)
+          && (NVM_WRITE_ALL_CMD != objectId))
+      {
+        objectId = (NVM_WRITE_ALL_CMD == pRefs[j].objectId) ? NVM_WRITE_ALL_CMD : NVM_WRITE_VECTOR_CMD;
+      }
+    }
+
+    nvmVectorPageId = pRefs[i].pageId;
+#if (NVM_PENDING_ENABLED == true)
+    result          = NVM_PendingCheck(pRefs[i].pageId, objectId);
+#else
+    result          = NVM_PageWrite(pRefs[i].pageId, objectId);
+#endif
+  }
+
+  nvmVectorRefs  = NULL;
+  nvmVectorCount = 0;
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiWriteV)
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_READ_POINTER_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Get a pointer to an object or an entire page in flash.
+ *
+ * @details
+ *   Use this function to read an object directly from a memory mapped NVM,
+ *   without copying it to RAM. The page is validated the same way as by
+ *   NVM_Read before the pointer is returned. When NVM_READ_ALL is used on a
+ *   normal page, the pointer is to the first object, and the objects follow
+ *   each other in the order given in the page specification.
+ *
+ *   The pointer is only valid until the page is written or erased, since a
+ *   write moves the page to another physical location.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to read from.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to read. Can be set to NVM_READ_ALL to get the
+ *   entire page.
+ *
+ * @param[out] ptr
+ *   Pointer to where the address of the object should be stored.
+ *
+ * @param[out] len
+ *   Pointer to where the size of the object should be stored.
+ *
+ * @return
+ *   Returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_ReadPtr(uint16_t pageId, NVM_Object_Id_t objectId, void const **ptr, uint16_t *len)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  /* Physical address of the page to read from. */
+  uint8_t *pPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Location of the object within the page. */
+  uint16_t offsetAddress;
+  uint16_t size;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+#if (NVM_PENDING_ENABLED == true)
+  /* Writes held back are written before the page is read from flash. */
+  if (NVM_PendingGet(pageId))
+  {
+    result = NVM_PendingWrite(pageId);
+    if (nvmResultOk != result)
+    {
+      /* Give up write lock and open for other API operations. */
+      NVM_RELEASE_WRITE_LOCK
+      NVM_STATS_TIMER_STOP(nvmStatsApiReadPtr)
+      return result;
+    }
+  }
+#endif
+
+  /* Find and validate the page the same way as NVM_Read. */
+  result = NVM_PageOpen(pageId, &pPhysicalAddress, &pageDesc);
+  if (nvmResultOk == result)
+  {
+    result = NVM_ObjectLocate(pPhysicalAddress, &pageDesc, objectId, &offsetAddress, &size);
+  }
+  if (nvmResultOk == result)
+  {
+    *ptr = pPhysicalAddress + offsetAddress;
+    *len = size;
+    NVM_STATS_INC(reads)
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiReadPtr)
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_READ_INTO_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Read part of an object into a buffer.
+ *
+ * @details
+ *   Use this function to read a range of bytes from an object into a buffer
+ *   given by the caller, instead of reading the whole object into the RAM
+ *   location given in the page specification. Objects that are only read this
+ *   way can be specified with a NULL location, and need no RAM of their own.
+ *   The page is validated the same way as by NVM_Read.
+ *
+ *   When NVM_READ_ALL is used on a normal page, the offset is counted from the
+ *   start of the first object, and the objects follow each other in the order
+ *   given in the page specification.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to read from.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to read from. Can be set to NVM_READ_ALL to read
+ *   from the entire page.
+ *
+ * @param[in] offset
+ *   Offset of the first byte to read, from the start of the object.
+ *
+ * @param[in] len
+ *   Number of bytes to read.
+ *
+ * @param[out] buf
+ *   Pointer to where the data should be stored.
+ *
+ * @return
+ *   Returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_ReadInto(uint16_t pageId, NVM_Object_Id_t objectId, uint16_t offset, uint16_t len, void *buf)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  /* Physical address of the page to read from. */
+  uint8_t *pPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Location of the object within the page. */
+  uint16_t offsetAddress;
+  uint16_t size;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+#if (NVM_PENDING_ENABLED == true)
+  /* Writes held back are written before the page is read from flash. */
+  if (NVM_PendingGet(pageId))
+  {
+    result = NVM_PendingWrite(pageId);
+    if (nvmResultOk != result)
+    {
+      /* Give up write lock and open for other API operations. */
+      NVM_RELEASE_WRITE_LOCK
+      NVM_STATS_TIMER_STOP(nvmStatsApiReadInto)
+      return result;
+    }
+  }
+#endif
+
+  /* Find and validate the page the same way as NVM_Read. */
+  result = NVM_PageOpen(pageId, &pPhysicalAddress, &pageDesc);
+  if (nvmResultOk == result)
+  {
+    result = NVM_ObjectLocate(pPhysicalAddress, &pageDesc, objectId, &offsetAddress, &size);
+  }
+
+  /* The range must be within the object. */
+  if ((nvmResultOk == result) && (((uint32_t) offset + len) > size))
+  {
+    result = nvmResultInputInvalid;
+  }
+
+  if (nvmResultOk == result)
+  {
+    NVMHAL_Read(pPhysicalAddress + offsetAddress + offset, buf, len);
+    NVM_STATS_INC(reads)
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiReadInto)
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_WRITE_RANGE_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Write part of an object from a buffer.
+ *
+ * @details
+ *   Use this function to update a range of bytes in an object of a normal
+ *   page, from a buffer given by the caller. The rest of the page is kept as
+ *   it is in flash, and the RAM locations given in the page specification are
+ *   not used.
+ *
+ *   If the new data only clears bits in the page, the range is programmed in
+ *   place, and the change is recorded in a patch journal in the free space
+ *   between the objects and the footer. Otherwise, or when the journal is
+ *   full, the page is written to a new physical page. The unchanged data is
+ *   then copied from the old page in blocks.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to write to.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write to.
+ *
+ * @param[in] offset
+ *   Offset of the first byte to write, from the start of the object.
+ *
+ * @param[in] len
+ *   Number of bytes to write.
+ *
+ * @param[in] src
+ *   Pointer to the new data.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_WriteRange(uint16_t pageId, NVM_Object_Id_t objectId, uint16_t offset, uint16_t len, void const *src)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  /* Physical address of the old version of the page. */
+  uint8_t *pOldPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Location of the object within the page. */
+  uint16_t offsetAddress;
+  uint16_t size;
+  /* Location and size of the page content. */
+  uint16_t contentOffset;
+  uint16_t contentSize;
+
+  /* The range to write when the page is moved. */
+  NVM_Write_Range_t range;
+
+  NVM_STATS_TIMER_START
+
+  /* Get page description. Only objects in normal pages can be written in
+   * parts. */
+  pageDesc = NVM_PageGet(pageId);
+
+  if ((NULL == pageDesc.page)
+      || (nvmPageTypeNormal != pageDesc.pageType)
+      || (NVM_WRITE_ALL_CMD == objectId))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiWriteRange)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+#if (NVM_PENDING_ENABLED == true)
+  /* Writes held back are written before the rest of the page is kept. */
+  if (NVM_PendingGet(pageId))
+  {
+    result = NVM_PendingWrite(pageId);
+    if (nvmResultOk != result)
+    {
+      /* Give up write lock and open for other API operations. */
+      NVM_RELEASE_WRITE_LOCK
+      NVM_STATS_TIMER_STOP(nvmStatsApiWriteRange)
+      return result;
+    }
+  }
+#endif
+
+  /* Find old physical address. */
+  pOldPhysicalAddress = NVM_PageFind(pageId);
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  /* The rest of the page is kept from the old page, so it must be validated
+   * before it is used for the first time. */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+      && (nvmValidateResultError == NVM_PageValidateDeferred(pOldPhysicalAddress)))
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+    NVM_STATS_TIMER_STOP(nvmStatsApiWriteRange)
+    return nvmResultDataInvalid;
+  }
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+  NVM_WriteHistoryAdd(pageId);
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* A page stored like a wear page is always moved, and stored as a normal
+   * page again. */
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+  {
+    NVM_HotLayoutGet(pOldPhysicalAddress, &pageDesc);
+  }
+#endif
+
+  result = NVM_ObjectLocate(pOldPhysicalAddress, &pageDesc, objectId, &offsetAddress, &size);
+
+  /* The range must be within the object. */
+  if ((nvmResultOk == result) && (((uint32_t) offset + len) > size))
+  {
+    result = nvmResultInputInvalid;
+  }
+
+  if (nvmResultOk == result)
+  {
+    /* Try to program the range in place first. */
+    result = nvmResultInputInvalid;
+    if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+        && (nvmPageTypeNormal == pageDesc.pageType))
+    {
+      NVM_ObjectLocate(pOldPhysicalAddress, &pageDesc, NVM_READ_ALL_CMD, &contentOffset, &contentSize);
+      result = NVM_PagePatch(pOldPhysicalAddress, contentSize, offsetAddress + offset, len, (uint8_t const *) src);
+    }
+
+    /* Move the page if that was not possible. */
+    if (nvmResultInputInvalid == result)
+    {
+      range.objectId = objectId;
+      range.offset   = offset;
+      range.length   = len;
+      range.pData    = (uint8_t const *) src;
+
+      pageDesc.pageType = nvmPageTypeNormal;
+      result = NVM_PageRelocate(pageId, &pageDesc, NVM_WRITE_NONE_CMD, pOldPhysicalAddress, &range, NVM_VERSION);
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiWriteRange)
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Add to the value of a counter page.
+ *
+ * @details
+ *   Use this function to increment a counter page without rewriting it. Each
+ *   increment clears the next group of bits in the free space of the page, so
+ *   that a flash word records NVM_COUNTER_WRITES_PER_WORD increments. When the
+ *   free space is used up, the page is written to a new physical page with the
+ *   current value as its base value.
+ *
+ *   A counter that has never been written starts at 0. If an increment is
+ *   interrupted by a power loss, the counter may end up with any value from
+ *   the old value to the new one.
+ *
+ *   The RAM location of the counter is not updated. Use NVM_Read or
+ *   NVM_CounterGet to read the new value.
+ *
+ * @param[in] pageId
+ *   Identifier of the counter page.
+ *
+ * @param[in] count
+ *   The number to add to the counter.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_CounterAdd(uint16_t pageId, uint32_t count)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical address of the old version of the page. */
+  uint8_t *pOldPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Base value of the page and number of increments recorded in it. */
+  uint32_t base  = 0;
+  uint32_t steps = 0;
+
+  /* Word to program, its index and the increments recorded in it. */
+  uint32_t word;
+  uint16_t wordIndex;
+  uint8_t  stepIndex;
+  uint8_t  stepCount;
+
+  /* Set if the increments were recorded in the old page. */
+  bool added = false;
+
+  /* The new base value when the page is moved. */
+  NVM_Write_Range_t range;
+
+  NVM_STATS_TIMER_START
+
+  /* Get page description. */
+  pageDesc = NVM_PageGet(pageId);
+
+  if ((NULL == pageDesc.page) || (nvmPageTypeCounter != pageDesc.pageType))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiCounterAdd)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  /* Find old physical address. */
+  pOldPhysicalAddress = NVM_PageFind(pageId);
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+  NVM_WriteHistoryAdd(pageId);
+#endif
+
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+  {
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+    /* The base value is kept from the old page, so it must be validated
+     * before it is used for the first time. */
+    if (nvmValidateResultError == NVM_PageValidateDeferred(pOldPhysicalAddress))
+    {
+      /* Give up write lock and open for other API operations. */
+      NVM_RELEASE_WRITE_LOCK
+      NVM_STATS_TIMER_STOP(nvmStatsApiCounterAdd)
+      return nvmResultDataInvalid;
+    }
+#endif
+
+    NVMHAL_Read(pOldPhysicalAddress + NVM_HEADER_SIZE, &base, sizeof(base));
+    steps = NVM_CounterSteps(pOldPhysicalAddress);
+
+    /* Record the increments in the old page if there is room for them. */
+    if (count <= (NVM_COUNTER_STEPS - steps))
+    {
+      added = true;
+
+      while ((0 != count) && (nvmResultOk == result))
+      {
+        wordIndex = steps / NVM_COUNTER_WRITES_PER_WORD;
+        stepIndex = steps % NVM_COUNTER_WRITES_PER_WORD;
+
+        stepCount = NVM_COUNTER_WRITES_PER_WORD - stepIndex;
+        if (stepCount > count)
+        {
+          stepCount = count;
+        }
+
+        /* Clear every group used in the word so far. */
+        if ((stepIndex + stepCount) == NVM_COUNTER_WRITES_PER_WORD)
+        {
+          word = 0;
+        }
+        else
+        {
+          word = NVM_NO_WRITE_32BIT << ((stepIndex + stepCount) * NVM_COUNTER_STEP_BITS);
+        }
+
+        result = NVMHAL_Write(pOldPhysicalAddress + NVM_COUNTER_FIELD_START + wordIndex * sizeof(uint32_t),
+                              &word,
+                              sizeof(word));
+
+        steps += stepCount;
+        count -= stepCount;
+      }
+
+      if (nvmResultOk == result)
+      {
+        NVM_STATS_INC(counterAdds)
+      }
+    }
+  }
+
+  /* Otherwise write a new page with the new value as base value. */
+  if (!added)
+  {
+    base += steps + count;
+
+    range.objectId = (*pageDesc.page)[0].objectId;
+    range.offset   = 0;
+    range.length   = sizeof(base);
+    range.pData    = (uint8_t const *) &base;
+
+    result = NVM_PageRelocate(pageId, &pageDesc, NVM_WRITE_NONE_CMD, pOldPhysicalAddress, &range, NVM_VERSION);
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiCounterAdd)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the value of a counter page.
+ *
+ * @details
+ *   The value is the base value of the page with the recorded increments
+ *   added. The RAM location of the counter is not updated.
+ *
+ * @param[in] pageId
+ *   Identifier of the counter page.
+ *
+ * @param[out] pValue
+ *   Pointer to where the value should be stored.
+ *
+ * @return
+ *   Returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_CounterGet(uint16_t pageId, uint32_t *pValue)
+{
+  /* Physical address of the page to read from. */
+  uint8_t *pPhysicalAddress;
+
+  /* Description of the page, used to find page type and objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Base value of the page. */
+  uint32_t base;
+
+  NVM_STATS_TIMER_START
+
+  /* Get page description. */
+  pageDesc = NVM_PageGet(pageId);
+
+  if ((NULL == pageDesc.page) || (nvmPageTypeCounter != pageDesc.pageType))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiCounterGet)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  /* Find physical page. */
+  pPhysicalAddress = NVM_PageFind(pageId);
+
+  /* If no page was found, we cannot read anything. */
+  if ((uint8_t*) NVM_NO_PAGE_RETURNED == pPhysicalAddress)
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+    NVM_STATS_TIMER_STOP(nvmStatsApiCounterGet)
+    return nvmResultNoPage;
+  }
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  /* Validate the page if this is the first time it is used. */
+  if (nvmValidateResultError == NVM_PageValidateDeferred(pPhysicalAddress))
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+    NVM_STATS_TIMER_STOP(nvmStatsApiCounterGet)
+    return nvmResultDataInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+  if (nvmValidateResultError == NVM_PageValidate(pPhysicalAddress))
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+    NVM_STATS_TIMER_STOP(nvmStatsApiCounterGet)
+    return nvmResultDataInvalid;
+  }
+#endif
+
+  NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE, &base, sizeof(base));
+  *pValue = base + NVM_CounterSteps(pPhysicalAddress);
+  NVM_STATS_INC(reads)
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiCounterGet)
+  return nvmResultOk;
+}
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Append a record to a log page.
+ *
+ * @details
+ *   Use this function to add a record to the end of a log page. The record is
+ *   programmed after the last one in the newest physical page of the log, so
+ *   an append only costs the bytes of the record. When that page is full, a
+ *   new one is taken from the scratch pages. When the log already uses all
+ *   its physical pages, the oldest one is erased first, and the records in it
+ *   are lost.
+ *
+ *   Every record gets the next sequence number of the log. The numbers of
+ *   the records of a log are consecutive. If an append is interrupted by a
+ *   power loss, the record is dropped, and the next append continues in a
+ *   new physical page.
+ *
+ * @param[in] pageId
+ *   Identifier of the log page.
+ *
+ * @param[in] pData
+ *   Pointer to the data of the record.
+ *
+ * @param[in] len
+ *   The length of the record. Must fit in a physical page together with the
+ *   page header, the sequence number and the record header.
+ *
+ * @param[out] pSequence
+ *   Pointer to where the sequence number of the record should be stored, or
+ *   NULL.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_LogAppend(uint16_t pageId, void const *pData, uint16_t len, uint32_t *pSequence)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Index of the log page. */
+  NVM_Log_t *pLog;
+
+  NVM_STATS_TIMER_START
+
+  pLog = NVM_LogGet(pageId);
+
+  if ((NULL == pLog) || (nvmPageTypeLog != pLog->pageType)
+      || (len > NVM_LOG_RECORD_MAX) || ((NULL == pData) && (0 != len)))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiLogAppend)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  /* Continue in a new segment if the record does not fit in the newest. */
+  if ((pLog->tailOffset + NVM_LOG_RECORD_SIZE(len)) > NVM_PAGE_SIZE)
+  {
+    result = NVM_LogSegmentOpen(pLog);
+  }
+
+  if (nvmResultOk == result)
+  {
+    if (NULL != pSequence)
+    {
+      *pSequence = pLog->nextSequence;
+    }
+
+    result = NVM_LogRecordWrite(pLog, NULL, 0, (uint8_t const *) pData, len);
+  }
+
+  if (nvmResultOk == result)
+  {
+    NVM_STATS_INC(logAppends)
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiLogAppend)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set up an iterator at a record of a log page.
+ *
+ * @details
+ *   The physical page holding the record is found by a binary search on the
+ *   sequence numbers of the physical pages of the log, and the record is then
+ *   found by walking the records of that page. A sequence number older than
+ *   the oldest record left is moved to the oldest record, and a sequence
+ *   number after the newest record is moved to the end of the log. The
+ *   sequence number the iterator ended up at is stored in the iterator.
+ *
+ * @param[in] pageId
+ *   Identifier of the log page.
+ *
+ * @param[in] sequence
+ *   Sequence number of the first record to read.
+ *
+ * @param[out] pIterator
+ *   Pointer to the iterator to set up.
+ *
+ * @return
+ *   Returns the result of the operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_LogSeek(uint16_t pageId, uint32_t sequence, NVM_Log_Iterator_t *pIterator)
+{
+  /* Index of the log page. */
+  NVM_Log_t *pLog;
+
+  NVM_STATS_TIMER_START
+
+  pLog = NVM_LogGet(pageId);
+
+  if ((NULL == pLog) || (nvmPageTypeLog != pLog->pageType) || (NULL == pIterator))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiLogSeek)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  NVM_LogLocate(pLog, sequence, pIterator);
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiLogSeek)
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read the next record of a log page.
+ *
+ * @details
+ *   Use this function to read the record at an iterator set up by
+ *   NVM_LogSeek, and move the iterator to the next record. The checksum of
+ *   the record is checked before it is returned.
+ *
+ *   If records at the iterator have been lost, because the physical page
+ *   they were in has been reclaimed or is damaged, the iterator is moved to
+ *   the next record that is left and nvmResultDataInvalid is returned.
+ *   Nothing is read in that case, and the function can be called again to
+ *   continue.
+ *
+ * @param[in,out] pIterator
+ *   Pointer to the iterator.
+ *
+ * @param[out] pBuffer
+ *   Pointer to where the record should be stored.
+ *
+ * @param[in] size
+ *   The size of the buffer.
+ *
+ * @param[out] pLen
+ *   Pointer to where the length of the record should be stored.
+ *
+ * @return
+ *   Returns nvmResultNoPage at the end of the log, and nvmResultInputInvalid
+ *   if the record does not fit in the buffer. The iterator is not moved in
+ *   those cases.
+ ******************************************************************************/
+NVM_Result_t NVM_LogNext(NVM_Log_Iterator_t *pIterator, void *pBuffer, uint16_t size, uint16_t *pLen)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultErrorInitial;
+
+  /* Index of the log page. */
+  NVM_Log_t *pLog;
+
+  /* Index of the segment of the iterator. */
+  uint8_t segment;
+
+  /* Physical address of the segment. */
+  uint8_t *pSegment;
+
+  /* Length of the record. */
+  uint16_t len = 0;
+
+  /* Sequence number of the iterator before it is moved. */
+  uint32_t sequence;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == pIterator) || (NULL == pLen))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiLogNext)
+    return nvmResultInputInvalid;
+  }
+
+  pLog = NVM_LogGet(pIterator->pageId);
+
+  if ((NULL == pLog) || (nvmPageTypeLog != pLog->pageType))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiLogNext)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  while (nvmResultErrorInitial == result)
+  {
+    if (pIterator->sequence >= pLog->nextSequence)
+    {
+      result = nvmResultNoPage;
+      break;
+    }
+
+    /* Find the segment of the iterator. It is gone if it has been reclaimed,
+     * or if it was at the end of the log. */
+    for (segment = 0; segment < pLog->count; ++segment)
+    {
+      if ((pLog->page[segment] == pIterator->page)
+          && (pLog->firstSequence[segment] <= pIterator->sequence)
+          && (((segment + 1) == pLog->count) || (pLog->firstSequence[segment + 1] > pIterator->sequence)))
+      {
+        break;
+      }
+    }
+
+    if (segment == pLog->count)
+    {
+      /* Find the segment again. The record is lost if it has been
+       * reclaimed, and the iterator is moved to the oldest record left. */
+      sequence = pIterator->sequence;
+      NVM_LogLocate(pLog, sequence, pIterator);
+      if (pIterator->sequence != sequence)
+      {
+        result = nvmResultDataInvalid;
+      }
+      continue;
+    }
+
+    pSegment = (uint8_t *)(nvmConfig->nvmArea) + pIterator->page * NVM_PAGE_SIZE;
+
+    if (nvmLogRecordValid == NVM_LogRecordCheck(pSegment, pIterator->offset, &len))
+    {
+      *pLen = len;
+
+      if (len > size)
+      {
+        result = nvmResultInputInvalid;
+      }
+      else
+      {
+        NVMHAL_Read(pSegment + pIterator->offset + NVM_LOG_RECORD_HEADER_SIZE, pBuffer, len);
+        pIterator->offset += NVM_LOG_RECORD_SIZE(len);
+        pIterator->sequence++;
+        NVM_STATS_INC(reads)
+        result = nvmResultOk;
+      }
+    }
+    else if ((segment + 1) < pLog->count)
+    {
+      /* The segment ends here. Records are lost if the next one does not
+       * start at the iterator. */
+      if (pLog->firstSequence[segment + 1] != pIterator->sequence)
+      {
+        result = nvmResultDataInvalid;
+      }
+      pIterator->sequence = pLog->firstSequence[segment + 1];
+      pIterator->page     = pLog->page[segment + 1];
+      pIterator->offset   = NVM_LOG_RECORDS_START;
+    }
+    else
+    {
+      /* The newest segment ends before the newest record. */
+      NVM_LogLocate(pLog, pLog->nextSequence, pIterator);
+      result = nvmResultDataInvalid;
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiLogNext)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the range of records in a log page.
+ *
+ * @param[in] pageId
+ *   Identifier of the log page.
+ *
+ * @param[out] pFirst
+ *   Pointer to where the sequence number of the oldest record should be
+ *   stored.
+ *
+ * @param[out] pNext
+ *   Pointer to where the sequence number of the next record appended should
+ *   be stored. It is the same as the oldest if the log is empty.
+ *
+ * @return
+ *   Returns the result of the operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_LogRangeGet(uint16_t pageId, uint32_t *pFirst, uint32_t *pNext)
+{
+  /* Index of the log page. */
+  NVM_Log_t *pLog;
+
+  NVM_STATS_TIMER_START
+
+  pLog = NVM_LogGet(pageId);
+
+  if ((NULL == pLog) || (nvmPageTypeLog != pLog->pageType) || (NULL == pFirst) || (NULL == pNext))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiLogRangeGet)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  *pFirst = pLog->nextSequence;
+  if (0 != pLog->count)
+  {
+    *pFirst = pLog->firstSequence[0];
+  }
+  *pNext = pLog->nextSequence;
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiLogRangeGet)
+  return nvmResultOk;
+}
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Set the value of a key in the key-value page.
+ *
+ * @details
+ *   Use this function to store a value of any length under a key, without a
+ *   page layout known at compile time. The value is appended as a record to
+ *   the newest physical page of the key-value page, so a small value only
+ *   costs the bytes of its record. The record of the old value becomes
+ *   garbage.
+ *
+ *   When the key-value page uses all its physical pages, each set or delete
+ *   checks NVM_KV_COLLECT_STEP records of the oldest one, and moves those
+ *   that hold the newest value of their key to the newest one. The oldest
+ *   physical page is erased when all its records are checked. If a record
+ *   does not fit before that, the rest of the oldest physical page is
+ *   collected at once.
+ *
+ *   If a set is interrupted by a power loss, the key keeps its old value.
+ *
+ * @param[in] key
+ *   The key. Must not be more than 0x7fff, or 0x7eff when packed pages are
+ *   enabled, since they use the keys after it.
+ *
+ * @param[in] pData
+ *   Pointer to the value.
+ *
+ * @param[in] len
+ *   The length of the value.
+ *
+ * @return
+ *   Returns nvmResultNoPages if there are NVM_KV_MAX_KEYS keys already, or
+ *   if the values would take more than all but one of the physical pages of
+ *   the key-value page. Otherwise returns the result of the write operation
+ *   using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_KvSet(uint16_t key, void const *pData, uint16_t len)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == nvmKv) || (key > NVM_KV_USER_KEY_MAX)
+      || (len > (NVM_LOG_RECORD_MAX - NVM_KV_KEY_SIZE)) || ((NULL == pData) && (0 != len)))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiKvSet)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  result = NVM_KvValueWrite(key, pData, len);
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiKvSet)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the value of a key in the key-value page.
+ *
+ * @details
+ *   The record of the value is found through the hash index in RAM, so only
+ *   the record itself is read from NVM.
+ *
+ * @param[in] key
+ *   The key.
+ *
+ * @param[out] pBuffer
+ *   Pointer to where the value should be stored.
+ *
+ * @param[in] size
+ *   The size of the buffer.
+ *
+ * @param[out] pLen
+ *   Pointer to where the length of the value should be stored.
+ *
+ * @return
+ *   Returns nvmResultNoPage if the key has got no value, and
+ *   nvmResultInputInvalid if the value does not fit in the buffer. With
+ *   NVM_FEATURE_READ_VALIDATION_ENABLED, returns nvmResultDataInvalid if the
+ *   record fails its checksum or its length differs from the indexed value.
+ *   Otherwise returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_KvGet(uint16_t key, void *pBuffer, uint16_t size, uint16_t *pLen)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Entry of the key in the hash index. */
+  uint16_t index;
+
+  /* Physical address of the segment holding the value. */
+  uint8_t  *pSegment;
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+  /* Length of the record. */
+  uint16_t len;
+#endif
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == nvmKv) || (key > NVM_KV_USER_KEY_MAX) || (NULL == pLen))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiKvGet)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  index = NVM_KvFind(key);
+
+  if (NVM_KV_NO_ENTRY == index)
+  {
+    result = nvmResultNoPage;
+  }
+  else
+  {
+    pSegment = (uint8_t *)(nvmConfig->nvmArea) + nvmKvIndex[index].page * NVM_PAGE_SIZE;
+    *pLen    = nvmKvIndex[index].len;
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+    /* The record must still be the one found by NVM_KvInit, holding the key
+     * and a value of the length in the index. */
+    if ((nvmLogRecordValid != NVM_LogRecordCheck(pSegment, nvmKvIndex[index].offset, &len))
+        || (len != (NVM_KV_KEY_SIZE + nvmKvIndex[index].len)))
+    {
+      result = nvmResultDataInvalid;
+    }
+    else
+#endif
+    if (nvmKvIndex[index].len > size)
+    {
+      result = nvmResultInputInvalid;
+    }
+    else
+    {
+      NVMHAL_Read(pSegment + nvmKvIndex[index].offset + NVM_LOG_RECORD_HEADER_SIZE + NVM_KV_KEY_SIZE,
+                  pBuffer,
+                  nvmKvIndex[index].len);
+      NVM_STATS_INC(reads)
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiKvGet)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Delete a key from the key-value page.
+ *
+ * @details
+ *   The deletion is appended as a record, like a new value. It also runs a
+ *   step of the garbage collector, like NVM_KvSet.
+ *
+ * @param[in] key
+ *   The key.
+ *
+ * @return
+ *   Returns nvmResultNoPage if the key has got no value. Otherwise returns
+ *   the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_KvDelete(uint16_t key)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == nvmKv) || (key > NVM_KV_USER_KEY_MAX))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiKvDelete)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  if (NVM_KV_NO_ENTRY == NVM_KvFind(key))
+  {
+    result = nvmResultNoPage;
+  }
+  else
+  {
+    result = NVM_KvRecordWrite(key | NVM_KV_KEY_DELETED, NULL, 0);
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiKvDelete)
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Write bytes to the EEPROM page.
+ *
+ * @details
+ *   Use this function to port code written for an EEPROM, which writes a few
+ *   bytes at an address instead of whole objects. The bytes are appended as
+ *   a record together with their address to the newest physical page of the
+ *   EEPROM page, so a small write costs a few words instead of a rewrite of
+ *   a page.
+ *
+ *   When all the physical pages are full, the whole content is written to a
+ *   new one, and the others are erased.
+ *
+ *   A write is never partly done. If it is interrupted by a power loss, all
+ *   the bytes keep their old value.
+ *
+ * @param[in] address
+ *   Address of the first byte in the EEPROM.
+ *
+ * @param[in] pData
+ *   Pointer to the bytes to write.
+ *
+ * @param[in] len
+ *   The number of bytes. The record must fit in a physical page together
+ *   with the whole content.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_EepromWrite(uint16_t address, void const *pData, uint16_t len)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* The bytes to write. */
+  uint8_t const *pBytes = (uint8_t const *) pData;
+
+  /* Number of attempts to make room for the record. */
+  uint8_t  attempts;
+  uint16_t i;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == nvmEepromLog) || (NULL == pData) || (address > NVM_EEPROM_SIZE)
+      || (len > (NVM_EEPROM_SIZE - address))
+      || (NVM_LOG_RECORD_SIZE(NVM_EEPROM_ADDRESS_SIZE + len) > (NVM_LOG_SEGMENT_SPACE - NVM_EEPROM_IMAGE_SPACE)))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiEepromWrite)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Only the bytes from the first to the last changed one are written. */
+  while ((0 != len) && (nvmEeprom[address] == pBytes[0]))
+  {
+    address++;
+    pBytes++;
+    len--;
+  }
+  while ((0 != len) && (nvmEeprom[address + len - 1] == pBytes[len - 1]))
+  {
+    len--;
+  }
+
+  if (0 == len)
+  {
+    NVM_STATS_INC(writesSkipped)
+
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+    NVM_STATS_TIMER_STOP(nvmStatsApiEepromWrite)
+    return nvmResultOk;
+  }
+#endif
+
+  for (attempts = 0;
+       (nvmResultOk == result)
+       && ((nvmEepromLog->tailOffset + NVM_LOG_RECORD_SIZE(NVM_EEPROM_ADDRESS_SIZE + len)) > NVM_PAGE_SIZE);
+       ++attempts)
+  {
+    if (attempts > 1)
+    {
+      result = nvmResultNoPages;
+    }
+    else if (nvmEepromLog->count < nvmEepromLog->segments)
+    {
+      result = NVM_LogSegmentOpen(nvmEepromLog);
+    }
+    else
+    {
+      result = NVM_EepromCompact();
+    }
+  }
+
+  if (nvmResultOk == result)
+  {
+    result = NVM_LogRecordWrite(nvmEepromLog, (uint8_t const *) &address, NVM_EEPROM_ADDRESS_SIZE, pBytes, len);
+  }
+
+  if (nvmResultOk == result)
+  {
+    for (i = 0; i < len; ++i)
+    {
+      nvmEeprom[address + i] = pBytes[i];
+    }
+    NVM_STATS_INC(eepromWrites)
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiEepromWrite)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read bytes from the EEPROM page.
+ *
+ * @details
+ *   The bytes are read from the copy of the content in RAM. Bytes that have
+ *   never been written read as 0xff, like an erased EEPROM.
+ *
+ * @param[in] address
+ *   Address of the first byte in the EEPROM.
+ *
+ * @param[out] pBuffer
+ *   Pointer to where the bytes should be stored.
+ *
+ * @param[in] len
+ *   The number of bytes.
+ *
+ * @return
+ *   Returns the result of the read operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_EepromRead(uint16_t address, void *pBuffer, uint16_t len)
+{
+  uint16_t i;
+
+  NVM_STATS_TIMER_START
+
+  if ((NULL == nvmEepromLog) || (NULL == pBuffer) || (address > NVM_EEPROM_SIZE)
+      || (len > (NVM_EEPROM_SIZE - address)))
+  {
+    NVM_STATS_TIMER_STOP(nvmStatsApiEepromRead)
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  for (i = 0; i < len; ++i)
+  {
+    ((uint8_t *) pBuffer)[i] = nvmEeprom[address + i];
+  }
+  NVM_STATS_INC(reads)
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiEepromRead)
+  return nvmResultOk;
+}
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Begin a transaction.
+ *
+ * @details
+ *   Use this function before adding pages to a transaction with NVM_TxWrite.
+ *   Pages added to a transaction that was not committed are dropped.
+ *
+ * @return
+ *   Returns the result of the operation using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_TxBegin(void)
+{
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  nvmTxOpen  = true;
+  nvmTxCount = 0;
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiTxBegin)
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Add a page to the transaction.
+ *
+ * @details
+ *   The page is written like by NVM_Write when the transaction is committed,
+ *   so the objects are read from RAM by NVM_TxCommit. Only normal and wear
+ *   pages can be part of a transaction, and each page only once.
+ *
+ * @param[in] pageId
+ *   Identifier of the page you want to write to NVM.
+ *
+ * @param[in] objectId
+ *   Identifier of the object you want to write. May be set to NVM_WRITE_ALL
+ *   to write the entire page to memory.
+ *
+ * @return
+ *   Returns nvmResultInputInvalid if no transaction is open, the page cannot
+ *   be added, or there are NVM_TX_MAX_PAGES pages in the transaction already.
+ ******************************************************************************/
+NVM_Result_t NVM_TxWrite(uint16_t pageId, NVM_Object_Id_t objectId)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Page descriptor used for accessing page type. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  uint8_t i;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  pageDesc = NVM_PageGet(pageId);
+
+  if (!nvmTxOpen || (nvmTxCount >= NVM_TX_MAX_PAGES) || (NULL == pageDesc.page)
+      || ((nvmPageTypeNormal != pageDesc.pageType) && (nvmPageTypeWear != pageDesc.pageType)))
+  {
+    result = nvmResultInputInvalid;
+  }
+
+  for (i = 0; (nvmResultOk == result) && (i < nvmTxCount); ++i)
+  {
+    if (nvmTx[i].pageId == pageId)
+    {
+      result = nvmResultInputInvalid;
+    }
+  }
+
+  if (nvmResultOk == result)
+  {
+    nvmTx[nvmTxCount].pageId   = pageId;
+    nvmTx[nvmTxCount].objectId = objectId;
+    nvmTxCount++;
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiTxWrite)
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Commit the transaction.
+ *
+ * @details
+ *   A new version of every page in the transaction is written to a free
+ *   physical page, while the old versions are left as they are. The new
+ *   version of the last page commits the transaction when it is complete.
+ *   The old versions are then erased, and the new versions replace them.
+ *
+ *   If this is interrupted by a power loss before the transaction is
+ *   committed, NVM_Init erases the new versions and all the pages keep their
+ *   old content. Otherwise NVM_Init finishes replacing the old versions.
+ *
+ * @return
+ *   Returns nvmResultInputInvalid if no transaction is open, or if there are
+ *   fewer free physical pages than pages in the transaction. Otherwise
+ *   returns the result of the write operation using a NVM_Result_t. If it is
+ *   not nvmResultOk, none of the pages were replaced.
+ ******************************************************************************/
+NVM_Result_t NVM_TxCommit(void)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Page descriptor used for accessing page type and page objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Physical address in memory for the old version of the page. */
+  uint8_t *pOldPhysicalAddress;
+
+  /* Set if the transaction was committed. */
+  bool committed = false;
+
+  /* Number of free physical pages. */
+  uint16_t freePages = 0;
+  uint16_t page;
+  uint16_t watermark;
+
+  uint8_t i;
+
+  NVM_STATS_TIMER_START
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  if (!nvmTxOpen)
+  {
+    /* Give up write lock and open for other API operations. */
+    NVM_RELEASE_WRITE_LOCK
+
+    NVM_STATS_TIMER_STOP(nvmStatsApiTxCommit)
+    return nvmResultInputInvalid;
+  }
+
+  nvmTxOpen = false;
+
+  /* Every page is staged in a free physical page while its old version is
+   * kept, and NVM_Init only makes sure that a single page is free. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    NVMHAL_Read((uint8_t *)(nvmConfig->nvmArea) + page * NVM_PAGE_SIZE, &watermark, sizeof(watermark));
+    if (NVM_PAGE_EMPTY_VALUE == watermark)
+    {
+      freePages++;
+    }
+  }
+
+  if (freePages < nvmTxCount)
+  {
+    result = nvmResultInputInvalid;
+  }
+
+#if (NVM_PENDING_ENABLED == true)
+  /* Writes held back are written before the pages are staged. */
+  for (i = 0; (nvmResultOk == result) && (i < nvmTxCount); ++i)
+  {
+    if (NVM_PendingGet(nvmTx[i].pageId))
+    {
+      result = NVM_PendingWrite(nvmTx[i].pageId);
+    }
+  }
+#endif
+
+  for (i = 0; (nvmResultOk == result) && (i < nvmTxCount); ++i)
+  {
+    pOldPhysicalAddress = NVM_PageFind(nvmTx[i].pageId);
+    pageDesc            = NVM_PageGet(nvmTx[i].pageId);
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+    /* Objects not written from RAM are copied from the old page, so it must
+     * be validated before it is used for the first time. */
+    if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+        && (NVM_WRITE_ALL_CMD != nvmTx[i].objectId)
+        && (nvmValidateResultError == NVM_PageValidateDeferred(pOldPhysicalAddress)))
+    {
+      result = nvmResultDataInvalid;
+      break;
+    }
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+    NVM_WriteHistoryAdd(nvmTx[i].pageId);
+#endif
+
+    /* The open bit is cleared in the last page, which commits the
+     * transaction. */
+    result = NVM_PageRelocate(nvmTx[i].pageId, &pageDesc, nvmTx[i].objectId, pOldPhysicalAddress, NULL,
+                              (i == (nvmTxCount - 1))
+                              ? (NVM_VERSION | NVM_TX_VERSION_STAGED)
+                              : (NVM_VERSION | NVM_TX_VERSION_STAGED | NVM_TX_VERSION_OPEN));
+  }
+
+  /* Replace the old versions, or erase the new ones if the transaction was
+   * not committed. */
+  if (0 != nvmTxCount)
+  {
+    if ((nvmResultOk != NVM_TxResolve(&committed)) && (nvmResultOk == result))
+    {
+      result = nvmResultError;
+    }
+
+    if ((nvmResultOk == result) && !committed)
+    {
+      result = nvmResultError;
+    }
+  }
+
+  if (committed)
+  {
+    NVM_STATS_INC(txCommits)
+  }
+
+  nvmTxCount = 0;
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  NVM_STATS_TIMER_STOP(nvmStatsApiTxCommit)
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Count time for the governor.
+ *
+ * @details
+ *   The erase budget grows by the endurance times the number of physical
+ *   pages for each lifetime of the wearPolicy, up to the burst of the policy.
+ *   Call this function regularly with the seconds since the last call. Writes
+ *   held back are written while the budget allows it.
+ *
+ * @param[in] seconds
+ *   Seconds since the last call.
+ *
+ * @return
+ *   Returns the result of the writes using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_GovernorTick(uint32_t seconds)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* The policy of the governor. */
+  NVM_Wear_Policy_t const *pPolicy = nvmConfig->wearPolicy;
+
+  /* Budget added each second, the full budget and what is missing of it. */
+  uint64_t rate;
+  int64_t  full;
+  int64_t  missing;
+
+  uint16_t pageIndex;
+  uint16_t pageId;
+
+  if ((NULL == pPolicy) || (0 == pPolicy->lifetime))
+  {
+    return nvmResultOk;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  rate    = (uint64_t) pPolicy->endurance * nvmConfig->pages;
+  full    = (int64_t) pPolicy->burst * pPolicy->lifetime;
+  missing = full - nvmGovernorCredit;
+
+  /* The budget is filled without working out more than is missing. */
+  if ((0 != rate) && (missing > 0))
+  {
+    if ((uint64_t) seconds >= (((uint64_t) missing + rate - 1) / rate))
+    {
+      nvmGovernorCredit = full;
+    }
+    else
+    {
+      nvmGovernorCredit += (int64_t) (seconds * rate);
+    }
+  }
+
+  /* Write the pages held back while the budget allows it. */
+  for (pageIndex = 0;
+       (pageIndex < nvmConfig->userPages) && (nvmResultOk == result) && !NVM_GovernorThrottled();
+       ++pageIndex)
+  {
+    pageId = (*(nvmConfig->nvmPages))[pageIndex].pageId;
+    if (NVM_PendingGet(pageId))
+    {
+      result = NVM_PendingWrite(pageId);
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the status of the governor.
+ *
+ * @param[out] pStatus
+ *   Pointer to where the status should be stored.
+ *
+ * @return
+ *   Returns nvmResultInputInvalid if pStatus is NULL, and nvmResultOk
+ *   otherwise.
+ ******************************************************************************/
+NVM_Result_t NVM_GovernorStatus(NVM_Governor_Status_t *pStatus)
+{
+  uint16_t pageIndex;
+
+  if (NULL == pStatus)
+  {
+    return nvmResultInputInvalid;
+  }
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  pStatus->throttled      = NVM_GovernorThrottled();
+  pStatus->pendingPages   = 0;
+  pStatus->deferredWrites = nvmGovernorDeferred;
+  pStatus->erases         = nvmGovernorErases;
+
+  for (pageIndex = 0; pageIndex < nvmConfig->userPages; ++pageIndex)
+  {
+    if (NVM_PendingGet((*(nvmConfig->nvmPages))[pageIndex].pageId))
+    {
+      pStatus->pendingPages++;
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  return nvmResultOk;
+}
+#endif
+
+#if (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Count time for the write-behind cache.
+ *
+ * @details
+ *   Call this function regularly with the milliseconds since the last call.
+ *   Once no write has been held back by the cache for
+ *   NVM_WRITE_BEHIND_DELAY milliseconds, the pages with writes held back are
+ *   written. Pages held back by the governor are left to NVM_GovernorTick.
+ *
+ * @param[in] milliseconds
+ *   Milliseconds since the last call.
+ *
+ * @return
+ *   Returns the result of the writes using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_WriteBehindTick(uint32_t milliseconds)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  uint16_t pageIndex;
+  uint16_t pageId;
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  /* Description of the page, used to find page type and flags. */
+  NVM_Page_Descriptor_t pageDesc;
+#endif
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  if (milliseconds < (NVM_HIGHEST_32BIT - nvmWriteBehindIdle))
+  {
+    nvmWriteBehindIdle += milliseconds;
+  }
+  else
+  {
+    nvmWriteBehindIdle = NVM_HIGHEST_32BIT;
+  }
+
+  for (pageIndex = 0;
+       (pageIndex < nvmConfig->userPages) && (nvmResultOk == result) && (nvmWriteBehindIdle >= NVM_WRITE_BEHIND_DELAY);
+       ++pageIndex)
+  {
+    pageId = (*(nvmConfig->nvmPages))[pageIndex].pageId;
+    if (!NVM_PendingGet(pageId))
+    {
+      continue;
+    }
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+    pageDesc = NVM_PageGet(pageId);
+    if (NVM_GovernorDefers(&pageDesc))
+    {
+      continue;
+    }
+#endif
+
+    result = NVM_PendingWrite(pageId);
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  return result;
+}
+#endif
+
+#if (NVM_PENDING_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Write all the pages with writes held back.
+ *
+ * @details
+ *   The pages are written whether the erase budget of the governor allows it
+ *   or not. Use it before the RAM is lost, for example before the device is
+ *   powered down.
+ *
+ * @return
+ *   Returns the result of the writes using a NVM_Result_t.
+ ******************************************************************************/
+NVM_Result_t NVM_Flush(void)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  uint16_t pageIndex;
+  uint16_t pageId;
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  for (pageIndex = 0; (pageIndex < nvmConfig->userPages) && (nvmResultOk == result); ++pageIndex)
+  {
+    pageId = (*(nvmConfig->nvmPages))[pageIndex].pageId;
+    if (NVM_PendingGet(pageId))
+    {
+      result = NVM_PendingWrite(pageId);
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+
+  return result;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Get maximum wear level.
+ *
+ * @details
+ *   This function returns the amount of erase cycles for the most erased page
+ *   in memory. This can be used as a rough measure of health for the device.
+ *
+ * @return
+ *   Returns the wear level as a uint32_t.
+ ******************************************************************************/
+#if (NVM_FEATURE_WEARLEVELGET_ENABLED == true)
+uint32_t NVM_WearLevelGet(void)
+{
+  uint16_t page;
+  /* Used to temporarily store the update id of the current page. */
+  uint32_t updateId;
+  /* Worst (highest) update id. Used as return value. */
+  uint32_t worstUpdateId = 0;
+
+  /* Address of physical page. */
+  uint8_t *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+
+  /* Loop through all pages in memory. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    /* Find and compare erasure count. */
+    NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+    if (updateId > worstUpdateId)
+    {
+      worstUpdateId = updateId;
+    }
+
+    /* Go to the next physical page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  return worstUpdateId;
+}
+#endif
+
+#if (NVM_FEATURE_STATS_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Get run time statistics.
+ *
+ * @details
+ *   This function copies the operation counters and the cycle count statistics
+ *   collected since startup or the last call to NVM_StatsReset. The erase
+ *   count of each physical page is read from the page headers, so it survives
+ *   a reset of the device.
+ *
+ * @param[out] stats
+ *   Pointer to where the statistics should be stored.
+ ******************************************************************************/
+void NVM_StatsGet(NVM_Stats_t *stats)
+{
+  uint16_t page;
+  uint16_t api;
+  /* Address of physical page. */
+  uint8_t  *pPhysicalAddress;
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  *stats = nvmStats;
+
+  /* Calculate the averages from the cycle totals. */
+  for (api = 0; api < nvmStatsApiCount; ++api)
+  {
+    if (nvmStats.timing[api].calls != 0)
+    {
+      stats->timing[api].avg = (uint32_t)(nvmStatsCyclesTotal[api] / nvmStats.timing[api].calls);
+    }
+  }
+
+  /* Read the erasure count of all pages in memory, if initialized. */
+  if (0 != nvmConfig)
+  {
+    pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+    for (page = 0; page < nvmConfig->pages; ++page)
+    {
+      NVMHAL_Read(pPhysicalAddress + 2, &stats->eraseCount[page], sizeof(stats->eraseCount[page]));
+
+      /* Go to the next physical page. */
+      pPhysicalAddress += NVM_PAGE_SIZE;
+    }
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Reset run time statistics.
+ *
+ * @details
+ *   This function clears all the operation counters and cycle count
+ *   statistics. The erase counts stored in the page headers are not affected.
+ ******************************************************************************/
+void NVM_StatsReset(void)
+{
+  uint16_t api;
+  /* Empty statistics used to clear the counters. */
+  static const NVM_Stats_t nullStats = { 0 };
+
+  /* Require write lock to continue. */
+  NVM_ACQUIRE_WRITE_LOCK
+
+  nvmStats = nullStats;
+  for (api = 0; api < nvmStatsApiCount; ++api)
+  {
+    nvmStatsCyclesTotal[api] = 0;
+  }
+
+  /* Give up write lock and open for other API operations. */
+  NVM_RELEASE_WRITE_LOCK
+}
+#endif
+
+/*******************************************************************************
+ ***************************   LOCAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/** @cond DO_NOT_INCLUDE_WITH_DOXYGEN */
+
+/***************************************************************************//**
+ * @brief
+ *   Find the physical address of a page.
+ *
+ * @details
+ *   This function finds the physical address of a page given a page id by
+ *   traversing the flash memory. With NVM_FEATURE_CHECKPOINT_ENABLED the page
+ *   map is tried first, and the flash is only traversed if it has got no
+ *   entry for the page or the entry does not match the page header.
+ *
+ * @param[in] pageId
+ *   NVM_Page_Ids that identifies the page.
+ *
+ * @return
+ *   Returns the resulting address as a uint8_t*. If no page was found
+ *   (uint8_t*)NVM_NO_PAGE_RETURNED is returned.
+ ******************************************************************************/
+static uint8_t* NVM_PageFind(uint16_t pageId)
+{
+  uint16_t page;
+  /* Physical address to return. */
+  uint8_t  *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+  /* Temporary variable used to read and compare logical page address. */
+  uint16_t logicalAddress;
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  /* Index of the page in the page table. */
+  uint16_t pageIndex;
+
+  if (nvmCheckpointValid)
+  {
+    pageIndex = NVM_PageIndexGet(pageId);
+    if ((NVM_CHECKPOINT_NO_PAGE != pageIndex) && (NVM_CHECKPOINT_NO_PAGE != nvmCheckpoint.map[pageIndex]))
+    {
+      pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea) + nvmCheckpoint.map[pageIndex] * NVM_PAGE_SIZE;
+      NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
+      if (((pageId | NVM_FIRST_BIT_ONE) == logicalAddress) || (pageId == logicalAddress))
+      {
+        return pPhysicalAddress;
+      }
+      pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+    }
+  }
+#endif
+
+  /* Loop through memory looking for a matching watermark. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    /* Allow both versions of writing mark, invalid duplicates should already
+     * have been deleted. */
+    NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
+    if (((pageId | NVM_FIRST_BIT_ONE) == logicalAddress) || (pageId == logicalAddress))
+    {
+      return pPhysicalAddress;
+    }
+
+    /* Move lookup point to the next page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  /* No page found. */
+  return (uint8_t *) NVM_NO_PAGE_RETURNED;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Finds the best scratch page.
+ *
+ * @details
+ *   This function returns the least used of all the currently empty pages. This
+ *   can be thought of as the best page to use if one wants the system to
+ *   perform dynamic wear leveling.
+ *
+ * @return
+ *   Address of the page is returned as a uint8_t*.
+ ******************************************************************************/
+static uint8_t* NVM_ScratchPageFindBest(void)
+{
+  uint16_t page;
+  /* Address for physical page to return. */
+  uint8_t  *pPhysicalPage = (uint8_t *) NVM_NO_PAGE_RETURNED;
+
+  /* Variable used to read and compare update id of physical pages. */
+  uint32_t updateId = NVM_HIGHEST_32BIT;
+  /* The best update id found. */
+  uint32_t bestUpdateId = NVM_HIGHEST_32BIT;
+
+  /* Pointer to the current physical page. */
+  uint8_t  *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+  /* Logical address that identifies the page. */
+  uint16_t logicalAddress;
+
+  /* Loop through all pages in memory. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    /* Read and check logical address. */
+    NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
+    if ((uint16_t) NVM_PAGE_EMPTY_VALUE == logicalAddress)
+    {
+      /* Find and compare erasure count. */
+      NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+      if (updateId < bestUpdateId)
+      {
+        bestUpdateId  = updateId;
+        pPhysicalPage = pPhysicalAddress;
+      }
+    }
+
+    /* Move lookup point to the next page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  /* Return a pointer to the best/least used page. */
+  return pPhysicalPage;
+}
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Finds the most worn scratch page.
+ *
+ * @details
+ *   This function returns the most used of all the currently empty pages. A
+ *   page that is seldom written is moved there, so that it is not erased again
+ *   for a long time, and the least used pages are left to the pages written
+ *   often.
+ *
+ * @return
+ *   Address of the page is returned as a uint8_t*.
+ ******************************************************************************/
+static uint8_t* NVM_ScratchPageFindWorn(void)
+{
+  uint16_t page;
+  /* Address for physical page to return. */
+  uint8_t  *pPhysicalPage = (uint8_t *) NVM_NO_PAGE_RETURNED;
+
+  /* Variable used to read and compare update id of physical pages. */
+  uint32_t updateId;
+  /* The highest update id found. */
+  uint32_t wornUpdateId = 0;
+
+  /* Pointer to the current physical page. */
+  uint8_t  *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+  /* Logical address that identifies the page. */
+  uint16_t logicalAddress;
+
+  /* Loop through all pages in memory. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    /* Read and check logical address. */
+    NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
+    if ((uint16_t) NVM_PAGE_EMPTY_VALUE == logicalAddress)
+    {
+      /* Find and compare erasure count. */
+      NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+      if (((uint8_t *) NVM_NO_PAGE_RETURNED == pPhysicalPage) || (updateId > wornUpdateId))
+      {
+        wornUpdateId  = updateId;
+        pPhysicalPage = pPhysicalAddress;
+      }
+    }
+
+    /* Move lookup point to the next page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  /* Return a pointer to the most used page. */
+  return pPhysicalPage;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Resolve a write interrupted by a power loss.
+ *
+ * @details
+ *   The old version of the page is still marked for write, and the new
+ *   version has got the same page ID with the write bit set. The new version
+ *   is kept if it validates, otherwise the old one is kept. The other one is
+ *   erased.
+ *
+ * @param[in] markedPage
+ *   Physical page holding the old version, marked for write.
+ *
+ * @param[in] newPage
+ *   Physical page holding the new version.
+ *
+ * @param[out] pKeptPage
+ *   Physical page of the version that is kept.
+ *
+ * @return
+ *   Returns the result of erasing the other version.
+ ******************************************************************************/
+static NVM_Result_t NVM_InitResolve(uint16_t markedPage, uint16_t newPage, uint16_t *pKeptPage)
+{
+  /* Physical page of the version that is erased. */
+  uint16_t erasedPage;
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  /* The decision depends on the content of the new page, so it must be
+   * fully validated now. */
+  nvmInitValidationResults[newPage] = NVM_PageValidate((uint8_t *)(nvmConfig->nvmArea) + newPage * NVM_PAGE_SIZE);
+#endif
+
+  if (nvmValidateResultOk == nvmInitValidationResults[newPage])
+  {
+    /* The new one validates, delete the old one. */
+    *pKeptPage = newPage;
+    erasedPage = markedPage;
+  }
+  else
+  {
+    /* The new one is broken, delete the new one. */
+    *pKeptPage = markedPage;
+    erasedPage = newPage;
+  }
+
+  nvmInitWatermarks[erasedPage] = NVM_PAGE_EMPTY_VALUE;
+  return NVM_PageErase((uint8_t *)(nvmConfig->nvmArea) + erasedPage * NVM_PAGE_SIZE);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erases a page.
+ *
+ * @details
+ *   This function erases the page at a certain address. All the data is erased
+ *   while the erasure count of the page is retained and updated.
+ *
+ * @param[in] address
+ *   Pointer to the location you want to erase.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PageErase(uint8_t *pPhysicalAddress)
+{
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  /* Logical page address. */
+  uint16_t logicalAddress;
+#endif
+
+  /* Read out the old page update id. */
+  uint32_t updateId;
+  NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  /* Get logical page address. */
+  NVMHAL_Read(pPhysicalAddress, &logicalAddress, sizeof(logicalAddress));
+
+  /* If not empty: mark as erased and check against threshold. */
+  if (logicalAddress != NVM_PAGE_EMPTY_VALUE)
+  {
+    /* Set first bit low. */
+    logicalAddress = logicalAddress & NVM_FIRST_BIT_ZERO;
+    NVM_StaticWearUpdate(logicalAddress);
+  }
+#endif
+
+  /* Erase the page. */
+  NVMHAL_PageErase(pPhysicalAddress);
+  NVM_STATS_INC(pageErases)
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  NVM_ValidationPendingSet(pPhysicalAddress, false);
+#endif
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  NVM_GovernorErase();
+#endif
+
+  /* Update erasure count. */
+  updateId++;
+
+  /* Write increased erasure count. */
+  return NVMHAL_Write(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find a page and check that it can be read.
+ *
+ * @details
+ *   This function finds the physical page, gets the page descriptor and
+ *   validates the page when this is needed before objects are read from it.
+ *   Wear pages are checked object by object when they are read.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @param[out] ppPhysicalAddress
+ *   Pointer to where the physical address of the page should be stored.
+ *
+ * @param[out] pPageDesc
+ *   Pointer to where the page descriptor should be stored.
+ *
+ * @return
+ *   Returns nvmResultNoPage if the page is not in NVM, and
+ *   nvmResultDataInvalid if it failed validation.
+ ******************************************************************************/
+static NVM_Result_t NVM_PageOpen(uint16_t pageId, uint8_t **ppPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc)
+{
+  /* Get page description. */
+  *pPageDesc = NVM_PageGet(pageId);
+
+  /* Find physical page. */
+  *ppPhysicalAddress = NVM_PageFind(pageId);
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+  /* A packed page has got no physical page. Its value is found and checked
+   * when the objects are read. */
+  if (nvmPageTypePacked == pPageDesc->pageType)
+  {
+    return nvmResultOk;
+  }
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+  /* The segments of a spanning page are found and checked when the objects
+   * are read. */
+  if (nvmPageTypeSpan == pPageDesc->pageType)
+  {
+    return nvmResultOk;
+  }
+#endif
+
+  /* If no page was found, we cannot read anything. */
+  if ((uint8_t*) NVM_NO_PAGE_RETURNED == *ppPhysicalAddress)
+  {
+    return nvmResultNoPage;
+  }
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  NVM_HotLayoutGet(*ppPhysicalAddress, pPageDesc);
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Log, key-value and EEPROM pages have got no objects to read. */
+  if (NVM_PAGE_TYPE_SEGMENTED(pPageDesc->pageType))
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  /* Validate the page if this is the first time it is used. */
+  if (nvmValidateResultError == NVM_PageValidateDeferred(*ppPhysicalAddress))
+  {
+    return nvmResultDataInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+  if ((nvmPageTypeWear != pPageDesc->pageType)
+      && (nvmValidateResultError == NVM_PageValidate(*ppPhysicalAddress)))
+  {
+    return nvmResultDataInvalid;
+  }
+#endif
+
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read an object or all the objects of a page to RAM.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page, as returned by NVM_PageOpen.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object, or NVM_READ_ALL.
+ *
+ * @return
+ *   Returns nvmResultDataInvalid if a wear page has got no valid copy of the
+ *   object.
+ ******************************************************************************/
+static NVM_Result_t NVM_ObjectRead(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* Variable used to fetch read index. */
+  uint16_t wearIndex;
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+  /* Value of a counter page. */
+  uint32_t counterValue;
+#endif
+
+  /* Index of object in page. */
+  uint16_t objectIndex;
+  /* Address of read location within a page. */
+  uint16_t offsetAddress;
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+  if (nvmPageTypePacked == pPageDesc->pageType)
+  {
+    return NVM_PackedRead(pPageDesc, objectId);
+  }
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+  if (nvmPageTypeSpan == pPageDesc->pageType)
+  {
+    return NVM_SpanRead(pPageDesc, objectId);
+  }
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+  if (nvmPageTypeCompressed == pPageDesc->pageType)
+  {
+    return NVM_CompressedRead(pPhysicalAddress, pPageDesc, objectId);
+  }
+#endif
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* If this is a wear page, we must find out which object in the page should be
+   * read. */
+  if (nvmPageTypeWear == pPageDesc->pageType)
+  {
+    /* Find valid object in wear page and read it. */
+    if (!NVM_WearReadIndex(pPhysicalAddress, pPageDesc, &wearIndex))
+    {
+      /* No valid object was found in the page. */
+      return nvmResultDataInvalid;
+    }
+
+    NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE +
+                wearIndex * ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH),
+                (*pPageDesc->page)[0].location,
+                (*pPageDesc->page)[0].size);
+  }
+  else
+#endif
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+  if (nvmPageTypeCounter == pPageDesc->pageType)
+  {
+    /* The value is the base value with the increments added. */
+    if (NULL != (*pPageDesc->page)[0].location)
+    {
+      NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE, &counterValue, sizeof(counterValue));
+      counterValue += NVM_CounterSteps(pPhysicalAddress);
+      *(uint32_t *)(*pPageDesc->page)[0].location = counterValue;
+    }
+  }
+  else
+#endif
+  {
+    /* Read normal page. */
+    objectIndex   = 0;
+    offsetAddress = 0;
+
+    /* Loop through and read the objects of a page, as long as the current item
+     * has got a size other than 0. Size 0 is a marker for the NULL object. */
+    while ((*pPageDesc->page)[objectIndex].size != 0)
+    {
+      /* Check if every object should be read or if this is the object to read.
+       * Objects without a RAM location are only read with NVM_ReadInto. */
+      if (((NVM_READ_ALL_CMD == objectId) || ((*pPageDesc->page)[objectIndex].objectId == objectId))
+          && (NULL != (*pPageDesc->page)[objectIndex].location))
+      {
+        NVMHAL_Read(pPhysicalAddress + NVM_OBJECT_OFFSET(pPageDesc->page, objectIndex, offsetAddress) + NVM_HEADER_SIZE,
+                    (*pPageDesc->page)[objectIndex].location,
+                    (*pPageDesc->page)[objectIndex].size);
+      }
+
+      offsetAddress += (*pPageDesc->page)[objectIndex].size;
+      objectIndex++;
+    }
+  }
+
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write an object or a page.
+ *
+ * @details
+ *   This function does the work of NVM_Write, and must be called with the
+ *   write lock held.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to write.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write, NVM_WRITE_ALL, NVM_WRITE_NONE or
+ *   NVM_WRITE_VECTOR.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PageWrite(uint16_t pageId, NVM_Object_Id_t objectId)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result = nvmResultErrorInitial;
+
+  /* Page descriptor used for accessing page type and page objects. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Physical address in memory for the old version of the page. */
+  uint8_t *pOldPhysicalAddress = (uint8_t *) NVM_NO_PAGE_RETURNED;
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Offset address within page. */
+  uint16_t offsetAddress;
+  /* Single byte buffer used when comparing data with an old page.*/
+  uint8_t  copyBuffer;
+  /* Object in page counter. */
+  uint16_t objectIndex;
+  /* Amount of bytes compared. */
+  uint16_t copyLength;
+#endif
+
+  /* Handle wear pages. Should we handle this as an extra write to an existing
+   * page or create a new one. */
+  bool wearWrite = false;
+
+  /* Set if the object was programmed in place in the old page. */
+  bool inPlaceWrite = false;
+
+  /* New data for part of an object that is not written from RAM. */
+  NVM_Write_Range_t const *pRange = NULL;
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+  /* Value of a counter page that is moved. */
+  uint32_t          counterValue;
+  NVM_Write_Range_t counterRange;
+#endif
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Bool used when checking if a write operation is needed. */
+  bool rewriteNeeded;
+#endif
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* Used to hold the checksum of the wear object. */
+  uint16_t wearChecksum;
+  /* Byte size of the wear object. Includes checksum length. */
+  uint16_t wearObjectSize;
+  /* Used to specify the internal index of the wear object in a page. */
+  uint16_t wearIndex;
+
+  #if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+  /* The new wear index the object will be written to. */
+  uint16_t wearIndexNew;
+  #endif
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* Set if the old page is stored like a wear page, and if the page should
+   * be stored like that now. */
+  bool promoted = false;
+  bool hot      = false;
+  /* Set if the object cannot be appended to the old page. */
+  bool hotMove  = false;
+  /* Recent writes to the page, including this one. */
+  uint8_t writes = 0;
+#endif
+
+  /* Find old physical address. */
+  pOldPhysicalAddress = NVM_PageFind(pageId);
+
+  /* Get the page configuration. */
+  pageDesc = NVM_PageGet(pageId);
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Log, key-value and EEPROM pages have got no objects to write. */
+  if (NVM_PAGE_TYPE_SEGMENTED(pageDesc.pageType))
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+  /* Packed pages are written as a value in the key-value page. */
+  if (nvmPageTypePacked == pageDesc.pageType)
+  {
+    return NVM_PackedWrite(&pageDesc, objectId);
+  }
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+  /* Each segment of a spanning page is written on its own. */
+  if (nvmPageTypeSpan == pageDesc.pageType)
+  {
+    return NVM_SpanWrite(&pageDesc, objectId);
+  }
+#endif
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  /* Objects not written from RAM are copied from the old page, so it must be
+   * validated before it is used for the first time. */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+      && (NVM_WRITE_ALL_CMD != objectId)
+      && (nvmValidateResultError == NVM_PageValidateDeferred(pOldPhysicalAddress)))
+  {
+    return nvmResultDataInvalid;
+  }
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+  /* Count the write. Moves by the static wear leveling system are not
+   * counted. */
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  if (!nvmStaticWearWorking)
+#endif
+  {
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+    writes = NVM_WriteHistoryAdd(pageId);
+#else
+    NVM_WriteHistoryAdd(pageId);
+#endif
+  }
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+  /* The objects of a compressed page are encoded before they are written. */
+  if (nvmPageTypeCompressed == pageDesc.pageType)
+  {
+    return NVM_CompressedWrite(pageId, &pageDesc, objectId, pOldPhysicalAddress);
+  }
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* A normal page that is written often is stored like a wear page. It is
+   * written like one while it is stored like that, and only changes layout
+   * when it is moved. Moves by the static wear leveling system keep the
+   * layout. */
+  if (nvmPageTypeNormal == pageDesc.pageType)
+  {
+    promoted = ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+               && NVM_HotPromoted(pOldPhysicalAddress, &pageDesc);
+    hot      = promoted;
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+    if (!nvmStaticWearWorking)
+#endif
+    {
+      hot = NVM_HotPageCheck(&pageDesc, writes, promoted);
+    }
+
+    if (promoted)
+    {
+      pageDesc.pageType = nvmPageTypeWear;
+      hotMove           = !NVM_ObjectSelected(objectId, (*pageDesc.page)[0].objectId);
+    }
+  }
+#endif
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* If there is an old version of the page, it might not be necessary to update
+   * the data. Also check that this is a normal page and that the static wear
+   * leveling system is not working (this system might want to rewrite pages
+   * even if the data is similar to the old version). */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+      && (nvmPageTypeNormal == pageDesc.pageType)
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+      && !nvmStaticWearWorking
+#endif
+      )
+  {
+    rewriteNeeded = false;
+    objectIndex   = 0;
+    offsetAddress = 0;
+
+    /* Loop over items as long as no rewrite is needed and the current item has
+    * got a size other than 0. Size 0 is used as a marker for a NULL object. */
+    while (((*pageDesc.page)[objectIndex].size != 0) && !rewriteNeeded)
+    {
+      /* Check if every object should be written or if this is the object to
+       * write. */
+      if (NVM_ObjectSelected(objectId, (*pageDesc.page)[objectIndex].objectId)
+          && (NULL != (*pageDesc.page)[objectIndex].location))
+      {
+        /* Compare object to RAM. */
+
+        /* Loop over each byte of the object and compare with RAM. The
+         * copy length counts the bytes of the object already compared. */
+        for (copyLength = 0; copyLength < (*pageDesc.page)[objectIndex].size; copyLength += sizeof(copyBuffer))
+        {
+          /* Get byte from NVM. */
+          NVMHAL_Read(pOldPhysicalAddress + NVM_OBJECT_OFFSET(pageDesc.page, objectIndex, offsetAddress) + copyLength + NVM_HEADER_SIZE,
+                      &copyBuffer,
+                      sizeof(copyBuffer));
+
+          /* Check byte in NVM with the corresponding byte in RAM. */
+          if (*(uint8_t *)((*pageDesc.page)[objectIndex].location + copyLength) != copyBuffer)
+          {
+            rewriteNeeded = true;
+            break;
+          }
+        }
+
+        /* Move offset past the object. */
+        offsetAddress += (*pageDesc.page)[objectIndex].size;
+      }
+      else
+      {
+        /* Move offset past the object. */
+        offsetAddress += (*pageDesc.page)[objectIndex].size;
+      }
+
+      /* Check next object. */
+      objectIndex++;
+    }
+
+    if (!rewriteNeeded)
+    {
+      NVM_STATS_INC(writesSkipped)
+      return nvmResultOk;
+    }
+  }
+#endif
+
+
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* If this is a wear page then we can check if we can possibly squeeze another
+   * version of the object inside the already existing page. If this is possible
+   * we set the wearWrite boolean. This will then make us ignore the normal
+   * write operation. */
+  if ((nvmPageTypeWear == pageDesc.pageType)
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+      && !hotMove
+#endif
+      )
+  {
+    /* Calculate checksum. The wear page checksum is only stored in 15 bits,
+     * because we need one bit to mark that the object is written. This bit is
+     * always set to 0. */
+
+    wearChecksum = NVM_CHECKSUM_INITIAL;
+    NVM_ChecksumAdditive(&wearChecksum, (*pageDesc.page)[0].location, (*pageDesc.page)[0].size);
+    wearChecksum &= NVM_LAST_BIT_ZERO;
+
+    /* If there was an old page. */
+    if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+    {
+      /* Find location in old page. */
+      wearIndex      = NVM_WearIndex(pOldPhysicalAddress, &pageDesc);
+      wearObjectSize = (*pageDesc.page)[0].size + NVM_CHECKSUM_LENGTH;
+
+      /* Check that the wearIndex returned is within the length of the page. */
+      if (wearIndex < ((uint16_t) NVM_WEAR_CONTENT_SIZE) / wearObjectSize)
+      {
+        result = NVMHAL_Write(pOldPhysicalAddress + NVM_HEADER_SIZE + wearIndex * wearObjectSize,
+                              (*pageDesc.page)[0].location,
+                              (*pageDesc.page)[0].size);
+        result = NVMHAL_Write(pOldPhysicalAddress + NVM_HEADER_SIZE + wearIndex * wearObjectSize + (*pageDesc.page)[0].size,
+                              &wearChecksum,
+                              sizeof(wearChecksum));
+
+        /* Register that we have now written to the old page. */
+        wearWrite = true;
+        NVM_STATS_INC(wearSlotAppends)
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+        /* Check if the newest one that is valid is the same as the one we just
+         * wrote to the NVM. */
+        if ((!NVM_WearReadIndex(pOldPhysicalAddress, &pageDesc, &wearIndexNew)) ||
+            (wearIndexNew != wearIndex))
+        {
+          result = nvmResultError;
+        }
+#endif
+      }
+    } /* End of old page if. */
+  }   /* End of wear page if. */
+#endif
+
+#if (NVM_FEATURE_WRITE_IN_PLACE_ENABLED == true)
+  /* A single object that only clears bits in the old page is programmed in
+   * place. The static wear leveling system must always move the page. */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+      && (nvmPageTypeNormal == pageDesc.pageType)
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+      && !nvmStaticWearWorking
+#endif
+      && (nvmResultOk == NVM_ObjectPatch(pOldPhysicalAddress, &pageDesc, objectId)))
+  {
+    inPlaceWrite = true;
+    result       = nvmResultOk;
+  }
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+  /* The increments of a counter page are added to the base value when the
+   * page is moved without a new value from RAM. */
+  if ((nvmPageTypeCounter == pageDesc.pageType)
+      && ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+      && ((NULL == (*pageDesc.page)[0].location)
+          || !NVM_ObjectSelected(objectId, (*pageDesc.page)[0].objectId)))
+  {
+    NVMHAL_Read(pOldPhysicalAddress + NVM_HEADER_SIZE, &counterValue, sizeof(counterValue));
+    counterValue += NVM_CounterSteps(pOldPhysicalAddress);
+
+    counterRange.objectId = (*pageDesc.page)[0].objectId;
+    counterRange.offset   = 0;
+    counterRange.length   = sizeof(counterValue);
+    counterRange.pData    = (uint8_t const *) &counterValue;
+    pRange                = &counterRange;
+  }
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* The new page gets the layout for how often the page is written. */
+  if (promoted || hot)
+  {
+    pageDesc.pageType = hot ? nvmPageTypeWear : nvmPageTypeNormal;
+  }
+#endif
+
+  /* Do not create a new page if we have already done an in-page wear write. */
+  if (!wearWrite && !inPlaceWrite)
+  {
+    result = NVM_PageRelocate(pageId, &pageDesc, objectId, pOldPhysicalAddress, pRange, NVM_VERSION);
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check if an object is written from RAM.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write, NVM_WRITE_ALL, NVM_WRITE_NONE or
+ *   NVM_WRITE_VECTOR.
+ *
+ * @param[in] pageObjectId
+ *   Identifier of an object in the page being written.
+ *
+ * @return
+ *   Returns true if the object in the page is selected by objectId.
+ ******************************************************************************/
+static bool NVM_ObjectSelected(NVM_Object_Id_t objectId, NVM_Object_Id_t pageObjectId)
+{
+#if (NVM_FEATURE_VECTORED_ENABLED == true)
+  /* Index in the list given to NVM_WriteV. */
+  uint16_t i;
+
+  /* The objects are listed for the page written by NVM_WriteV. */
+  if (NVM_WRITE_VECTOR_CMD == objectId)
+  {
+    for (i = 0; i < nvmVectorCount; i++)
+    {
+      if ((nvmVectorRefs[i].pageId == nvmVectorPageId)
+          && (nvmVectorRefs[i].objectId == pageObjectId))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+#endif
+
+  return (NVM_WRITE_ALL_CMD == objectId) || (pageObjectId == objectId);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write a page to a new physical page.
+ *
+ * @details
+ *   This function marks the old version of the page, writes a new version to
+ *   the best scratch page and erases the old version when the new one is
+ *   complete. The objects selected by the object id are written from RAM, and
+ *   the others are copied from the old version. If a range is given, its data
+ *   replaces the corresponding bytes of the copied object.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to write.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write from RAM, NVM_WRITE_ALL, NVM_WRITE_NONE
+ *   or NVM_WRITE_VECTOR.
+ *
+ * @param[in] pOldPhysicalAddress
+ *   Pointer to the old version of the page, or NVM_NO_PAGE_RETURNED.
+ *
+ * @param[in] pRange
+ *   Pointer to a range of new data for a copied object, or NULL.
+ *
+ * @param[in] version
+ *   Version to write in the header, normally NVM_VERSION. With the staged bit
+ *   of a transaction set, the old version is neither marked nor erased.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PageRelocate(uint16_t pageId, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId, uint8_t *pOldPhysicalAddress, NVM_Write_Range_t const *pRange, uint16_t version)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Watermark to look for when finding page. First bit true. */
+  uint16_t       watermark     = pageId | NVM_FIRST_BIT_ONE;
+  /* Watermark used when flipping the duplication bit of a page. */
+  const uint32_t flipWatermark = NVM_FLIP_FIRST_BIT_OF_32_WHEN_WRITE;
+
+  /* Page header. Used to easily write the new version. */
+  NVM_Page_Header_t header;
+
+  /* Variable used for checksum calculation. Starts at defined initial value. */
+  uint16_t checksum = NVM_CHECKSUM_INITIAL;
+
+  /* Physical address in memory for the new version of the page. */
+  uint8_t  *pNewPhysicalAddress;
+  /* Address of the object in the old page, or NVM_NO_PAGE_RETURNED. */
+  uint8_t  *pCopyAddress;
+
+  /* Offset address within page. */
+  uint16_t offsetAddress;
+  /* Object in page counter. */
+  uint16_t objectIndex;
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* Used to hold the checksum of the wear object. */
+  uint16_t wearChecksum;
+#endif
+
+  /* Offset of the newest version of the objects in the old page. */
+  uint16_t copyOffset = 0;
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* Descriptor of the page in the page table. */
+  NVM_Page_Descriptor_t tableDesc = NVM_PageGet(pageId);
+  /* Set if the old and the new page are stored like wear pages. */
+  bool promoted    = false;
+  bool promotedNew = (nvmPageTypeWear == pPageDesc->pageType)
+                     && (nvmPageTypeNormal == tableDesc.pageType);
+  /* Index of the newest copy in the old page. */
+  uint16_t wearIndex;
+#endif
+
+  /* Set if the page is staged by a transaction. */
+  bool staged = (NVM_VERSION != version);
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+  /* Set if the page is seldom written, or moved by the static wear leveling
+   * system. */
+  bool cold = nvmHotWindowDone && (NVM_WriteHistoryGet(pageId) <= NVM_COLD_PAGE_THRESHOLD);
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* The objects of a page stored like a wear page are copied from its newest
+   * copy. */
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+  {
+    promoted = NVM_HotPromoted(pOldPhysicalAddress, &tableDesc);
+    if (promoted && NVM_WearReadIndex(pOldPhysicalAddress, pPageDesc, &wearIndex))
+    {
+      copyOffset = wearIndex * ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH);
+    }
+  }
+#endif
+
+  /* Mark any old page before creating a new one. */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress) && !staged)
+  {
+    result = NVMHAL_Write(pOldPhysicalAddress, &flipWatermark, 4);
+
+    if (nvmResultOk != result)
+    {
+      return result;
+    }
+  }
+
+  /* Find new physical address to write to. */
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  cold = cold || nvmStaticWearWorking;
+#endif
+
+  /* A page that is seldom written is parked on the most worn empty page,
+   * which leaves the least worn ones to the pages written often. */
+  if (cold)
+  {
+    pNewPhysicalAddress = NVM_ScratchPageFindWorn();
+  }
+  else
+#endif
+  {
+    pNewPhysicalAddress = NVM_ScratchPageFindBest();
+  }
+
+  if ((uint8_t*) NVM_NO_PAGE_RETURNED == pNewPhysicalAddress)
+  {
+    return nvmResultError;
+  }
+
+  /* The version is written before the watermark, so a write cut short in
+   * between leaves a page that is found as empty. Its version is not erased,
+   * and cannot be written again before the page is erased. */
+  NVMHAL_Read(pNewPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+  if (NVM_NO_WRITE_16BIT != header.version)
+  {
+    result = NVM_PageErase(pNewPhysicalAddress);
+    if (nvmResultOk != result)
+    {
+      return result;
+    }
+  }
+
+  NVM_STATS_INC(pageRelocations)
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+  if (cold)
+  {
+    NVM_STATS_INC(coldAllocations)
+  }
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  /* Record the write before the new page is touched, so that startup knows
+   * which page to check if it is interrupted. A transaction records its
+   * pages when it is committed. */
+  if (!staged)
+  {
+    NVM_CheckpointRecord(nvmCheckpointRecordStart, pageId, pNewPhysicalAddress);
+  }
+#endif
+
+  /* Generate and write header */
+  header.watermark = watermark;
+  header.updateId  = NVM_NO_WRITE_32BIT;
+  header.version   = version;
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  if (promotedNew)
+  {
+    header.version = NVM_HOT_VERSION;
+  }
+
+  if (promotedNew && !promoted)
+  {
+    NVM_STATS_INC(hotPromotions)
+  }
+  else if (promoted && !promotedNew)
+  {
+    NVM_STATS_INC(hotDemotions)
+  }
+#endif
+
+  /* store header at beginning of page. The version goes first, so that a
+   * page staged by a transaction is known as staged once it has got a
+   * watermark. */
+  result = NVMHAL_Write(pNewPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+  result = NVMHAL_Write(pNewPhysicalAddress, &header.watermark, sizeof(header.watermark));
+  result = NVMHAL_Write(pNewPhysicalAddress + sizeof(header.watermark), &header.updateId, sizeof(header.updateId));
+
+  /* Reset address index within page. */
+  offsetAddress = 0;
+  /* Reset object in page counter. */
+  objectIndex = 0;
+
+  /* Loop over items as long as everything is OK, and the current item has got
+   * a size other than 0. Size 0 is used as a marker for a NULL object. */
+  while (((*pPageDesc->page)[objectIndex].size != 0) && (nvmResultOk == result))
+  {
+    /* Check if every object should be written or if this is the object to
+     * write. Objects without a RAM location are always copied. */
+    if (NVM_ObjectSelected(objectId, (*pPageDesc->page)[objectIndex].objectId)
+        && (NULL != (*pPageDesc->page)[objectIndex].location))
+    {
+      /* Write object from RAM. */
+      result = NVMHAL_Write(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
+                            (*pPageDesc->page)[objectIndex].location,
+                            (*pPageDesc->page)[objectIndex].size);
+
+      NVM_ChecksumAdditive(&checksum, (*pPageDesc->page)[objectIndex].location, (*pPageDesc->page)[objectIndex].size);
+    }
+    else
+    {
+      /* Get version from old page. If there is no old version, the object is
+       * left erased. */
+      pCopyAddress = pOldPhysicalAddress;
+      if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+      {
+        pCopyAddress = pOldPhysicalAddress + copyOffset + offsetAddress + NVM_HEADER_SIZE;
+      }
+
+      if ((NULL != pRange) && (pRange->objectId == (*pPageDesc->page)[objectIndex].objectId))
+      {
+        /* Copy the bytes before the range, write the range and copy the rest. */
+        result = NVM_PageCopy(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
+                              pCopyAddress,
+                              pRange->offset,
+                              &checksum);
+        if (nvmResultOk == result)
+        {
+          result = NVMHAL_Write(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE + pRange->offset,
+                                pRange->pData,
+                                pRange->length);
+          NVM_ChecksumAdditive(&checksum, (void *) pRange->pData, pRange->length);
+        }
+        if ((nvmResultOk == result) && ((uint8_t *) NVM_NO_PAGE_RETURNED != pCopyAddress))
+        {
+          pCopyAddress += pRange->offset + pRange->length;
+        }
+        if (nvmResultOk == result)
+        {
+          result = NVM_PageCopy(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE + pRange->offset + pRange->length,
+                                pCopyAddress,
+                                (*pPageDesc->page)[objectIndex].size - pRange->offset - pRange->length,
+                                &checksum);
+        }
+      }
+      else
+      {
+        result = NVM_PageCopy(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
+                              pCopyAddress,
+                              (*pPageDesc->page)[objectIndex].size,
+                              &checksum);
+      }
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  /* If we are creating a wear page, add the checksum directly after the data. */
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  if (nvmPageTypeWear == pPageDesc->pageType)
+  {
+    /* The wear page checksum is only stored in 15 bits, because we need one
+     * bit to mark that the object is written. This bit is always set to 0.
+     * The page has got a single object, so it is the checksum of the page,
+     * which also covers an object copied from the old page. */
+    wearChecksum = checksum & NVM_LAST_BIT_ZERO;
+
+    result = NVMHAL_Write(pNewPhysicalAddress + offsetAddress + NVM_HEADER_SIZE,
+                          &wearChecksum,
+                          sizeof(wearChecksum));
+  }
+  /* Generate and write footer on normal pages. */
+  else
+  {
+#endif
+  if (nvmResultOk == result)
+  {
+    /* write checksum at end of page */
+    result = NVMHAL_Write(pNewPhysicalAddress + (NVM_PAGE_SIZE - NVM_FOOTER_SIZE), &checksum, sizeof(checksum));
+    /* write watermark just after checksum at end of page */
+    result = NVMHAL_Write(pNewPhysicalAddress + (NVM_PAGE_SIZE + sizeof(checksum) - NVM_FOOTER_SIZE), &watermark, sizeof(watermark));
+  }
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+}     /* End of else from page type. */
+#endif
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+  /* Validate that the correct data was written. */
+  if (nvmValidateResultOk != NVM_PageValidate(pNewPhysicalAddress))
+  {
+    result = nvmResultError;
+  }
+#endif
+
+  if (staged)
+  {
+    /* The old version is replaced when the transaction is committed. */
+    if (nvmResultOk != result)
+    {
+      NVM_PageErase(pNewPhysicalAddress);
+    }
+  }
+  /* Erase old if there was an old one and everything else have gone OK. */
+  else if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+  {
+    if (nvmResultOk == result)
+    {
+      result = NVM_PageErase(pOldPhysicalAddress);
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+      NVM_CheckpointRecord(nvmCheckpointRecordDone, pageId, pNewPhysicalAddress);
+#endif
+    }
+    else
+    {
+      NVM_PageErase(pNewPhysicalAddress);
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+      NVM_CheckpointRecord(nvmCheckpointRecordDone, pageId, pOldPhysicalAddress);
+#endif
+    }
+  }
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+  else
+  {
+    /* First write of the page. */
+    NVM_CheckpointRecord(nvmCheckpointRecordDone, pageId, pNewPhysicalAddress);
+  }
+#endif
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Copy data to a new page.
+ *
+ * @details
+ *   This function copies data from an old page to a new page through a buffer
+ *   in RAM, and adds it to a checksum. If there is no old page to copy from,
+ *   the data in the new page is left erased, and the erased value is added to
+ *   the checksum.
+ *
+ * @param[in] pDestination
+ *   Pointer to where in the new page the data should be written.
+ *
+ * @param[in] pSource
+ *   Pointer to the data in the old page, or NVM_NO_PAGE_RETURNED.
+ *
+ * @param[in] len
+ *   The length of the data.
+ *
+ * @param[in] pChecksum
+ *   Pointer to the checksum to add the data to.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PageCopy(uint8_t *pDestination, uint8_t *pSource, uint16_t len, uint16_t *pChecksum)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Buffer used when copying. One extra word, since the HAL reads whole words
+   * from the buffer when writing the end of an unaligned block. */
+  uint32_t copyBuffer[(NVM_COPY_BUFFER_SIZE / sizeof(uint32_t)) + 1];
+  /* Amount of bytes to copy in this step. */
+  uint16_t copyLength;
+  uint16_t i;
+
+  while ((len != 0) && (nvmResultOk == result))
+  {
+    /* Align the steps to words in the new page, so that no word is written
+     * more than necessary. */
+    copyLength = NVM_COPY_BUFFER_SIZE - ((uintptr_t) pDestination % sizeof(uint32_t));
+    if (copyLength > len)
+    {
+      copyLength = len;
+    }
+
+    if ((uint8_t *) NVM_NO_PAGE_RETURNED == pSource)
+    {
+      for (i = 0; i < copyLength; ++i)
+      {
+        ((uint8_t *) copyBuffer)[i] = NVM_NO_WRITE_8BIT;
+      }
+    }
+    else
+    {
+      NVMHAL_Read(pSource, copyBuffer, copyLength);
+      result = NVMHAL_Write(pDestination, copyBuffer, copyLength);
+      pSource += copyLength;
+    }
+
+    NVM_ChecksumAdditive(pChecksum, copyBuffer, copyLength);
+
+    pDestination += copyLength;
+    len          -= copyLength;
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the description of a page.
+ *
+ * @details
+ *   This function returns the NVM_Page_Descriptor_t corresponding to a
+ *   given NVM_Page_Ids.
+ *
+ * @note
+ *   This function returns a struct instead of a pointer since the packed struct
+ *   is as small as a pointer, and using a pointer might add more instruction
+ *   overhead.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns the page description as a NVM_Page_Descriptor_t.
+ ******************************************************************************/
+static NVM_Page_Descriptor_t NVM_PageGet(uint16_t pageId)
+{
+  uint16_t                           pageIndex;
+  static const NVM_Page_Descriptor_t nullPage = { (NVM_Page_Id_t) 0, 0, (NVM_Page_Type_t) 0
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+                                                  , 0
+#endif
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true) || (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+                                                  , 0
+#endif
+                                                };
+
+  /* Step through all configured pages. */
+  for (pageIndex = 0; pageIndex < nvmConfig->userPages; ++pageIndex)
+  {
+    /* If this is the page we want, return it. */
+    if ( (*(nvmConfig->nvmPages))[pageIndex].pageId == pageId)
+    {
+      return (*(nvmConfig->nvmPages))[pageIndex];
+    }
+  }
+
+  /* No page matched the ID, return a NULL page to mark the error. */
+  return nullPage;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Validate the header and footer of a certain address.
+ *
+ * @details
+ *   This function checks if the page at the supplied address looks valid
+ *   without reading its content.
+ *
+ *   For normal pages the watermark in the header and footer are compared.
+ *   For wear pages only the header is checked, since they have got no footer.
+ *   Results are returned based on the write mark of the page.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the location you want to check.
+ *
+ * @return
+ *   Returns the validation status of the address as a NVM_ValidateResult_t.
+ ******************************************************************************/
+static NVM_ValidateResult_t NVM_PageValidateHeader(uint8_t *pPhysicalAddress)
+{
+  /* Result used as return value from the function. */
+  NVM_ValidateResult_t result;
+
+  /* Objects used to read out the page header and footer. */
+  NVM_Page_Header_t header;
+  NVM_Page_Footer_t footer;
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* Descriptor of the page, used to tell wear pages from normal pages. */
+  NVM_Page_Descriptor_t pageDesc;
+#endif
+
+  /* Read page header data */
+  NVMHAL_Read(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+  NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Log segments have got no footer. The version is written after the
+   * watermark, and a segment that was not completed is erased by
+   * NVM_LogInit. */
+  if (NVM_PAGE_TYPE_SEGMENTED(NVM_PageGet((header.watermark & NVM_FIRST_BIT_ZERO)).pageType))
+  {
+    if ((NVM_VERSION != header.version) && (NVM_NO_WRITE_16BIT != header.version))
+    {
+      return nvmValidateResultOld;
+    }
+    return nvmValidateResultOk;
+  }
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+  /* Pages staged by a transaction are checked like the page they replace.
+   * NVM_Init finishes or undoes an interrupted transaction before any page is
+   * looked up, so they are only seen while the transaction is written. */
+  header.version &= NVM_TX_VERSION_MASK;
+#endif
+
+  /* Stop immediately if data is from another version of the API. */
+  if ((NVM_VERSION != header.version)
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+      && (NVM_HOT_VERSION != header.version)
+#endif
+      )
+  {
+    return nvmValidateResultOld;
+  }
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  pageDesc = NVM_PageGet((header.watermark & NVM_FIRST_BIT_ZERO));
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  /* A page with the version of a promoted page that cannot be promoted is
+   * checked like a normal page, and its missing footer makes it invalid. */
+  NVM_HotLayoutGet(pPhysicalAddress, &pageDesc);
+#endif
+
+  if (nvmPageTypeWear == pageDesc.pageType)
+  {
+    /* Wear page. */
+
+    /* If first bit is already zero the page is marked as a duplicate. */
+    if ((header.watermark & NVM_FIRST_BIT_ZERO) == header.watermark)
+    {
+      result = nvmValidateResultOkMarked;
+    }
+    else
+    {
+      /* Page is not marked as a duplicate. */
+      result = nvmValidateResultOk;
+    }
+  }
+  else
+#endif
+  {
+    /* Normal page. */
+    NVMHAL_Read(pPhysicalAddress + (NVM_PAGE_SIZE + sizeof(footer.checksum) - NVM_FOOTER_SIZE), &footer.watermark, sizeof(footer.watermark));
+    /* Check if watermark or watermark with flipped write bit matches. */
+    if (header.watermark == footer.watermark)
+    {
+      result = nvmValidateResultOk;
+    }
+    else if ((header.watermark | NVM_FIRST_BIT_ONE) == footer.watermark)
+    {
+      result = nvmValidateResultOkMarked;
+    }
+    else
+    {
+      result = nvmValidateResultError;
+      NVM_STATS_INC(validationFailures)
+    }
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Validate a certain address.
+ *
+ * @details
+ *   This function checks if there is a valid page at the supplied address.
+ *
+ *   For normal pages the checksum is calculated and compared against the one
+ *   stored in NVM, and the watermark in the header and footer are compared.
+ *   Results are returned based on the write mark of the page.
+ *
+ *   For wear pages we check that there are any readable objects in the page
+ *   using the lookup function used by the read command. Here we are dependent
+ *   on user settings to control the checksum.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the location you want to check.
+ *
+ * @return
+ *   Returns the validation status of the address as a NVM_ValidateResult_t.
+ ******************************************************************************/
+static NVM_ValidateResult_t NVM_PageValidate(uint8_t *pPhysicalAddress)
+{
+  /* Result used as return value from the function. */
+  NVM_ValidateResult_t result;
+
+  /* Watermark of the page, used to find the page configuration. */
+  uint16_t watermark;
+  /* Checksum stored in the page footer. */
+  uint16_t footerChecksum;
+
+  /* Descriptor for the current page. */
+  NVM_Page_Descriptor_t pageDesc;
+
+  /* Variable used for calculating checksums. */
+  uint16_t checksum;
+
+  /* Offset of object in page. */
+  uint16_t objectIndex;
+  /* Address of read location within a page. */
+  uint16_t offsetAddress;
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* Variable used to fetch read index. */
+  uint16_t index;
+#endif
+
+  /* Check the header and footer before the content. */
+  result = NVM_PageValidateHeader(pPhysicalAddress);
+  if ((nvmValidateResultOk != result) && (nvmValidateResultOkMarked != result))
+  {
+    return result;
+  }
+
+  /* Get the page configuration. */
+  NVMHAL_Read(pPhysicalAddress, &watermark, sizeof(watermark));
+  pageDesc = NVM_PageGet((watermark & NVM_FIRST_BIT_ZERO));
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+  /* A segment of a spanning page holds parts of its objects. */
+  if (nvmPageTypeSpan == NVM_PageGet(NVM_SPAN_PAGE_ID(watermark)).pageType)
+  {
+    pageDesc = NVM_PageGet(NVM_SPAN_PAGE_ID(watermark));
+    pageDesc = NVM_SpanSegmentGet(&pageDesc, NVM_SPAN_SEGMENT(watermark & NVM_FIRST_BIT_ZERO));
+  }
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+  NVM_HotLayoutGet(pPhysicalAddress, &pageDesc);
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+  /* The checksum of a compressed page covers the encoded objects. */
+  if (nvmPageTypeCompressed == pageDesc.pageType)
+  {
+    pageDesc = NVM_CompressedContentGet(pPhysicalAddress, &pageDesc);
+  }
+#endif
+
+  /* The objects of a page that is not in the page table are not known, for
+   * instance after a power loss in the middle of writing its watermark. Log
+   * segments have got no objects. */
+  if ((NULL == pageDesc.page)
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+      && !NVM_PAGE_TYPE_SEGMENTED(pageDesc.pageType)
+#endif
+      )
+  {
+    return nvmValidateResultError;
+  }
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  if (nvmPageTypeWear == pageDesc.pageType)
+  {
+    /* Wear page. If we do not have any valid objects in the page it is
+     * invalid. */
+    if (!NVM_WearReadIndex(pPhysicalAddress, &pageDesc, &index))
+    {
+      result = nvmValidateResultError;
+    }
+  }
+  else
+#endif
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  if (NVM_PAGE_TYPE_SEGMENTED(pageDesc.pageType))
+  {
+    /* Log segment. Each record is checked when it is read. */
+  }
+  else
+#endif
+  {
+    /* Normal page. Calculate checksum and compare with the one stored. */
+    NVMHAL_Read(pPhysicalAddress + (NVM_PAGE_SIZE - NVM_FOOTER_SIZE), &footerChecksum, sizeof(footerChecksum));
+
+    objectIndex   = 0;
+    offsetAddress = 0;
+    checksum      = NVM_CHECKSUM_INITIAL;
+
+    /* Calculate per object using the HAL. Loop over items as long as the
+     * current object has got a size other than 0. Size 0 is used as a marker
+     * for a NULL object. */
+    while ((*pageDesc.page)[objectIndex].size != 0)
+    {
+      NVMHAL_Checksum(&checksum, (uint8_t *) pPhysicalAddress + NVM_HEADER_SIZE + offsetAddress, (*pageDesc.page)[objectIndex].size);
+      offsetAddress += (*pageDesc.page)[objectIndex].size;
+      objectIndex++;
+    }
+
+#if (NVM_PATCH_ENABLED == true)
+    /* Patches programmed in place are checked against the patch journal. */
+    if (nvmPageTypeNormal == pageDesc.pageType)
+    {
+      if (!NVM_PatchCheck(pPhysicalAddress, offsetAddress, checksum, footerChecksum))
+      {
+        result = nvmValidateResultError;
+      }
+    }
+    else
+#endif
+    if (checksum != footerChecksum)
+    {
+      result = nvmValidateResultError;
+    }
+  }
+
+#if (NVM_FEATURE_STATS_ENABLED == true)
+  if (nvmValidateResultError == result)
+  {
+    NVM_STATS_INC(validationFailures)
+  }
+#endif
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+  /* The page has now been checked, so it does not need to be checked again
+   * before it is used. A page that failed stays pending, so that every use of
+   * it keeps reporting the error. */
+  if (nvmValidateResultError != result)
+  {
+    NVM_ValidationPendingSet(pPhysicalAddress, false);
+  }
+#endif
+
+  return result;
+}
+
+#if (NVM_FEATURE_READ_POINTER_ENABLED == true) || (NVM_FEATURE_READ_INTO_ENABLED == true) \
+  || (NVM_FEATURE_WRITE_RANGE_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Find an object in a page.
+ *
+ * @details
+ *   This function finds the offset from the start of the physical page and
+ *   the size of an object. For NVM_READ_ALL on a normal page the offset of the
+ *   first object and the size of all the objects is returned, since they are
+ *   stored after each other. For wear pages the newest valid copy of the
+ *   object is found.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object, or NVM_READ_ALL.
+ *
+ * @param[out] pOffset
+ *   Pointer to where the offset of the object should be stored.
+ *
+ * @param[out] pSize
+ *   Pointer to where the size of the object should be stored.
+ *
+ * @return
+ *   Returns nvmResultInputInvalid if the object is not in the page, and
+ *   nvmResultDataInvalid if a wear page has got no valid copy of it.
+ ******************************************************************************/
+static NVM_Result_t NVM_ObjectLocate(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId, uint16_t *pOffset, uint16_t *pSize)
+{
+  /* Index of object in page. */
+  uint16_t objectIndex = 0;
+  /* Address of the object within the page. */
+  uint16_t offsetAddress = 0;
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+  /* Variable used to fetch read index. */
+  uint16_t wearIndex;
+
+  if (nvmPageTypeWear == pPageDesc->pageType)
+  {
+    if ((NVM_READ_ALL_CMD != objectId) && ((*pPageDesc->page)[0].objectId != objectId))
+    {
+      return nvmResultInputInvalid;
+    }
+
+    /* Find the newest valid object in the wear page. */
+    if (!NVM_WearReadIndex(pPhysicalAddress, pPageDesc, &wearIndex))
+    {
+      return nvmResultDataInvalid;
+    }
+
+    *pOffset = NVM_HEADER_SIZE + wearIndex * ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH);
+    *pSize   = (*pPageDesc->page)[0].size;
+    return nvmResultOk;
+  }
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+  /* The value of a counter is not stored as a whole in the page. */
+  if (nvmPageTypeCounter == pPageDesc->pageType)
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+  /* The objects of a spanning page are split over its segments. */
+  if (nvmPageTypeSpan == pPageDesc->pageType)
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+  /* The objects of a packed page are stored in the key-value page. */
+  if (nvmPageTypePacked == pPageDesc->pageType)
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+  /* The objects of a compressed page are only stored encoded. */
+  if (nvmPageTypeCompressed == pPageDesc->pageType)
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+  /* Log, key-value and EEPROM pages have got no objects. */
+  if (NVM_PAGE_TYPE_SEGMENTED(pPageDesc->pageType))
+  {
+    return nvmResultInputInvalid;
+  }
+#endif
+
+  /* Loop through the objects of the page, as long as the current item has got
+   * a size other than 0. Size 0 is a marker for the NULL object. */
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    if ((*pPageDesc->page)[objectIndex].objectId == objectId)
+    {
+      *pOffset = NVM_HEADER_SIZE + NVM_OBJECT_OFFSET(pPageDesc->page, objectIndex, offsetAddress);
+      *pSize   = (*pPageDesc->page)[objectIndex].size;
+      return nvmResultOk;
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  if ((NVM_READ_ALL_CMD == objectId) && (0 != offsetAddress))
+  {
+    *pOffset = NVM_HEADER_SIZE;
+    *pSize   = offsetAddress;
+    return nvmResultOk;
+  }
+
+  return nvmResultInputInvalid;
+}
+#endif
+
+#if (NVM_PATCH_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Scan the patch journal of a normal page.
+ *
+ * @details
+ *   This function steps through the records of the patch journal, and finds
+ *   the newest record that has been completely written. The scan stops at the
+ *   first erased record, or at the first record that is not complete. No more
+ *   records may be added after a record that is not complete, so the journal
+ *   is then reported as full.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] contentSize
+ *   Size of the objects in the page.
+ *
+ * @param[out] pNewest
+ *   Pointer to where the newest complete record should be stored.
+ *
+ * @param[out] pNewestOffset
+ *   Pointer to where the offset of the newest complete record should be
+ *   stored. Set to 0 if there are no complete records.
+ *
+ * @return
+ *   Returns the offset of the first free record in the page, or NVM_PAGE_SIZE
+ *   if no more records can be added.
+ ******************************************************************************/
+static uint16_t NVM_PatchScan(uint8_t *pPhysicalAddress, uint16_t contentSize, NVM_Patch_Header_t *pNewest, uint16_t *pNewestOffset)
+{
+  /* Offset of the current record. */
+  uint16_t offset = NVM_PATCH_JOURNAL_START(contentSize);
+  /* The current record. */
+  NVM_Patch_Header_t record;
+  /* Variable used for calculating the check of a record. */
+  uint16_t check;
+
+  *pNewestOffset = 0;
+
+  while ((offset + NVM_PATCH_HEADER_SIZE) <= (NVM_PAGE_SIZE - NVM_FOOTER_SIZE))
+  {
+    NVMHAL_Read(pPhysicalAddress + offset, &record, sizeof(record));
+
+    /* An erased record marks the end of the journal. */
+    if ((NVM_NO_WRITE_16BIT == record.offset) && (NVM_NO_WRITE_16BIT == record.length)
+        && (NVM_NO_WRITE_16BIT == record.checksum) && (NVM_NO_WRITE_16BIT == record.check))
+    {
+      return offset;
+    }
+
+    /* The patched bytes must be within the objects, and the data within the
+     * journal. */
+    if ((0 == record.length)
+        || (record.offset < NVM_HEADER_SIZE)
+        || ((record.offset + record.length) > (NVM_HEADER_SIZE + contentSize))
+        || ((offset + NVM_PATCH_HEADER_SIZE + NVM_PATCH_DATA_SIZE(record.length)) > (NVM_PAGE_SIZE - NVM_FOOTER_SIZE)))
+    {
+      return NVM_PAGE_SIZE;
+    }
+
+    check = NVM_CHECKSUM_INITIAL;
+    NVM_ChecksumAdditive(&check, &record, sizeof(record) - sizeof(record.check));
+    NVMHAL_Checksum(&check, pPhysicalAddress + offset + NVM_PATCH_HEADER_SIZE, record.length);
+    check &= NVM_LAST_BIT_ZERO;
+
+    if (check != record.check)
+    {
+      return NVM_PAGE_SIZE;
+    }
+
+    *pNewest       = record;
+    *pNewestOffset = offset;
+
+    offset += NVM_PATCH_HEADER_SIZE + NVM_PATCH_DATA_SIZE(record.length);
+  }
+
+  return NVM_PAGE_SIZE;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Program a range of a normal page in place.
+ *
+ * @details
+ *   A range can only be programmed in place when the new data does not set any
+ *   bits that are cleared in the page. The new data and the checksum of the
+ *   page content after the change are first added to the patch journal, and
+ *   the range is then programmed. If the programming is interrupted, the
+ *   journal is used to finish it when the page is validated.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] contentSize
+ *   Size of the objects in the page.
+ *
+ * @param[in] pageOffset
+ *   Offset of the range from the start of the page.
+ *
+ * @param[in] len
+ *   Number of bytes in the range.
+ *
+ * @param[in] pData
+ *   Pointer to the new data of the range.
+ *
+ * @return
+ *   Returns nvmResultInputInvalid if the range cannot be programmed in place,
+ *   and the page must be written to a new physical page instead.
+ ******************************************************************************/
+static NVM_Result_t NVM_PagePatch(uint8_t *pPhysicalAddress, uint16_t contentSize, uint16_t pageOffset, uint16_t len, uint8_t const *pData)
+{
+  /* Result variable used as return value from the function. */
+  NVM_Result_t result;
+
+  /* The new record, and the newest record already in the journal. */
+  NVM_Patch_Header_t record;
+  NVM_Patch_Header_t newest;
+  uint16_t           newestOffset;
+  /* Offset of the new record. */
+  uint16_t           recordOffset;
+
+  /* Buffer used when comparing with the data in the page. */
+  uint8_t  compareBuffer[NVM_COPY_BUFFER_SIZE];
+  /* Amount of bytes to compare in this step. */
+  uint16_t compareLength;
+  /* True if any byte is changed. */
+  bool     changed = false;
+  uint16_t i;
+  uint16_t j;
+
+  /* Check that the new data only clears bits. */
+  for (i = 0; i < len; i += compareLength)
+  {
+    compareLength = len - i;
+    if (compareLength > NVM_COPY_BUFFER_SIZE)
+    {
+      compareLength = NVM_COPY_BUFFER_SIZE;
+    }
+
+    NVMHAL_Read(pPhysicalAddress + pageOffset + i, compareBuffer, compareLength);
+
+    for (j = 0; j < compareLength; ++j)
+    {
+      if ((compareBuffer[j] & pData[i + j]) != pData[i + j])
+      {
+        return nvmResultInputInvalid;
+      }
+      if (compareBuffer[j] != pData[i + j])
+      {
+        changed = true;
+      }
+    }
+  }
+
+  if (!changed)
+  {
+    NVM_STATS_INC(writesSkipped)
+    return nvmResultOk;
+  }
+
+  /* Find room for the new record. */
+  recordOffset = NVM_PatchScan(pPhysicalAddress, contentSize, &newest, &newestOffset);
+
+  if ((recordOffset + NVM_PATCH_HEADER_SIZE + NVM_PATCH_DATA_SIZE(len)) > (NVM_PAGE_SIZE - NVM_FOOTER_SIZE))
+  {
+    return nvmResultInputInvalid;
+  }
+
+  /* Checksum of the page content as it will be after the patch. */
+  record.offset   = pageOffset;
+  record.length   = len;
+  record.checksum = NVM_CHECKSUM_INITIAL;
+  NVMHAL_Checksum(&record.checksum, pPhysicalAddress + NVM_HEADER_SIZE, pageOffset - NVM_HEADER_SIZE);
+  NVM_ChecksumAdditive(&record.checksum, (void *) pData, len);
+  NVMHAL_Checksum(&record.checksum, pPhysicalAddress + pageOffset + len, (NVM_HEADER_SIZE + contentSize) - (pageOffset + len));
+
+  record.check = NVM_CHECKSUM_INITIAL;
+  NVM_ChecksumAdditive(&record.check, &record, sizeof(record) - sizeof(record.check));
+  NVM_ChecksumAdditive(&record.check, (void *) pData, len);
+  record.check &= NVM_LAST_BIT_ZERO;
+
+  /* Write the record, with the check written last to complete it. */
+  result = NVMHAL_Write(pPhysicalAddress + recordOffset, &record.offset, 2 * sizeof(uint16_t));
+  if (nvmResultOk == result)
+  {
+    result = NVMHAL_Write(pPhysicalAddress + recordOffset + NVM_PATCH_HEADER_SIZE, pData, len);
+  }
+  if (nvmResultOk == result)
+  {
+    result = NVMHAL_Write(pPhysicalAddress + recordOffset + 2 * sizeof(uint16_t), &record.checksum, 2 * sizeof(uint16_t));
+  }
+
+  /* Program the range. */
+  if (nvmResultOk == result)
+  {
+    result = NVMHAL_Write(pPhysicalAddress + pageOffset, pData, len);
+  }
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+  /* Validate that the correct data was written. */
+  if ((nvmResultOk == result)
+      && (nvmValidateResultOk != NVM_PageValidate(pPhysicalAddress)))
+  {
+    result = nvmResultError;
+  }
+#endif
+
+  if (nvmResultOk == result)
+  {
+    NVM_STATS_INC(inPlaceWrites)
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check the checksum of a normal page against the patch journal.
+ *
+ * @details
+ *   The checksum of a page that has been patched in place is found in the
+ *   newest complete record of the patch journal, instead of the footer. If
+ *   the page does not match it, the programming of the newest patch might have
+ *   been interrupted. The patch is then programmed again from the journal,
+ *   and the page is checked once more.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] contentSize
+ *   Size of the objects in the page.
+ *
+ * @param[in] checksum
+ *   Checksum calculated from the objects in the page.
+ *
+ * @param[in] footerChecksum
+ *   Checksum stored in the page footer.
+ *
+ * @return
+ *   Returns true if the page matches the expected checksum.
+ ******************************************************************************/
+static bool NVM_PatchCheck(uint8_t *pPhysicalAddress, uint16_t contentSize, uint16_t checksum, uint16_t footerChecksum)
+{
+  /* The newest complete record in the journal. */
+  NVM_Patch_Header_t newest;
+  uint16_t           newestOffset;
+  /* Checksum of the data copied from the journal. Not used. */
+  uint16_t           copyChecksum = NVM_CHECKSUM_INITIAL;
+
+  NVM_PatchScan(pPhysicalAddress, contentSize, &newest, &newestOffset);
+
+  if (0 == newestOffset)
+  {
+    return (checksum == footerChecksum);
+  }
+
+  if (checksum == newest.checksum)
+  {
+    return true;
+  }
+
+  /* Program the newest patch again, and check the result. */
+  NVM_PageCopy(pPhysicalAddress + newest.offset,
+               pPhysicalAddress + newestOffset + NVM_PATCH_HEADER_SIZE,
+               newest.length,
+               &copyChecksum);
+
+  checksum = NVM_CHECKSUM_INITIAL;
+  NVMHAL_Checksum(&checksum, pPhysicalAddress + NVM_HEADER_SIZE, contentSize);
+
+  return (checksum == newest.checksum);
+}
+#endif
+
+#if (NVM_FEATURE_WRITE_IN_PLACE_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Program a single object from RAM in place.
+ *
+ * @details
+ *   Only a single object is programmed in place, since every patch is
+ *   committed on its own, and writing several objects must be all or
+ *   nothing.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write.
+ *
+ * @return
+ *   Returns nvmResultInputInvalid if the object cannot be programmed in place,
+ *   and the page must be written to a new physical page instead.
+ ******************************************************************************/
+static NVM_Result_t NVM_ObjectPatch(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+  /* Index of object in page. */
+  uint16_t objectIndex = 0;
+  /* Address of the object within the page, and size of the page content. */
+  uint16_t offsetAddress = 0;
+  uint16_t contentSize   = 0;
+  /* Index of the object to write. */
+  uint16_t writeIndex    = NVM_NO_WRITE_16BIT;
+
+  if ((NVM_WRITE_ALL_CMD == objectId) || (NVM_WRITE_NONE_CMD == objectId)
+      || (NVM_WRITE_VECTOR_CMD == objectId))
+  {
+    return nvmResultInputInvalid;
+  }
+
+  /* Loop through the objects of the page, as long as the current item has got
+   * a size other than 0. Size 0 is a marker for the NULL object. */
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    if ((*pPageDesc->page)[objectIndex].objectId == objectId)
+    {
+      writeIndex    = objectIndex;
+      offsetAddress = NVM_OBJECT_OFFSET(pPageDesc->page, objectIndex, contentSize);
+    }
+
+    contentSize += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  if ((NVM_NO_WRITE_16BIT == writeIndex) || (NULL == (*pPageDesc->page)[writeIndex].location))
+  {
+    return nvmResultInputInvalid;
+  }
+
+  return NVM_PagePatch(pPhysicalAddress,
+                       contentSize,
+                       NVM_HEADER_SIZE + offsetAddress,
+                       (*pPageDesc->page)[writeIndex].size,
+                       (*pPageDesc->page)[writeIndex].location);
+}
+#endif
+
+#if (NVM_FEATURE_COUNTER_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Count the increments recorded in a counter page.
+ *
+ * @details
+ *   The increments are recorded by clearing the groups of bits in a word from
+ *   the lowest, and the words are used in order. Counting stops at the first
+ *   word that is not completely cleared. An increment is counted if any bit in
+ *   its group is cleared, so that an interrupted increment is counted as well
+ *   as the ones before it.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @return
+ *   Returns the number of increments recorded in the page.
+ ******************************************************************************/
+static uint32_t NVM_CounterSteps(uint8_t *pPhysicalAddress)
+{
+  /* Number of increments found. */
+  uint32_t steps = 0;
+  /* Index of the current word in the field. */
+  uint16_t wordIndex;
+  /* The current word, and the number of increments recorded in it. */
+  uint32_t word;
+  uint8_t  stepIndex;
+  /* Mask for the group of bits of a single increment. */
+  const uint32_t stepMask = NVM_NO_WRITE_32BIT >> (32U - NVM_COUNTER_STEP_BITS);
+
+  for (wordIndex = 0; wordIndex < NVM_COUNTER_FIELD_WORDS; ++wordIndex)
+  {
+    NVMHAL_Read(pPhysicalAddress + NVM_COUNTER_FIELD_START + wordIndex * sizeof(uint32_t), &word, sizeof(word));
+
+    if (0 == word)
+    {
+      steps += NVM_COUNTER_WRITES_PER_WORD;
+      continue;
+    }
+
+    /* Find the last group with any bit cleared. */
+    stepIndex = NVM_COUNTER_WRITES_PER_WORD;
+    while ((stepIndex > 0)
+           && (((word >> ((stepIndex - 1) * NVM_COUNTER_STEP_BITS)) & stepMask) == stepMask))
+    {
+      stepIndex--;
+    }
+
+    steps += stepIndex;
+    break;
+  }
+
+  return steps;
+}
+#endif
+
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Build the index of the log pages.
+ *
+ * @details
+ *   This function finds the segments of every log page from the page
+ *   headers, and sorts them by the sequence number of their first record.
+ *   Segments that were not completed are erased, and so are the oldest ones
+ *   if a log has got more segments than it may use. Only the records of the
+ *   newest segment are read, to find where the next record goes.
+ *
+ * @return
+ *   Returns nvmResultNoPages if no segments were found, and nvmResultError if
+ *   a page could not be erased.
+ ******************************************************************************/
+static NVM_Result_t NVM_LogInit(void)
+{
+  uint16_t page;
+  uint8_t  i;
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultNoPages;
+
+  /* Physical address of the current page. */
+  uint8_t  *pPhysicalAddress;
+  /* Page header and sequence number of the current page. */
+  NVM_Page_Header_t header;
+  uint32_t          firstSequence;
+
+  /* Index of the log page of the current page. */
+  NVM_Log_t *pLog;
+
+  /* Length of a record, and the result of reading it. */
+  uint16_t                len;
+  NVM_Log_Record_Result_t recordResult;
+
+  /* Register the log pages. */
+  for (i = 0; i < NVM_LOG_MAX_PAGES; ++i)
+  {
+    nvmLogs[i].pageId = NVM_PAGE_EMPTY_VALUE;
+  }
+
+  i = 0;
+  for (page = 0; page < nvmConfig->userPages; ++page)
+  {
+    if (NVM_PAGE_TYPE_SEGMENTED((*(nvmConfig->nvmPages))[page].pageType))
+    {
+      nvmLogs[i].pageId   = (*(nvmConfig->nvmPages))[page].pageId;
+      nvmLogs[i].pageType = (*(nvmConfig->nvmPages))[page].pageType;
+      nvmLogs[i].segments = (*(nvmConfig->nvmPages))[page].segments;
+      nvmLogs[i].count    = 0;
+      i++;
+    }
+  }
+
+  /* Find the segments. */
+  pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+  for (page = 0; page < nvmConfig->pages; ++page, pPhysicalAddress += NVM_PAGE_SIZE)
+  {
+    NVMHAL_Read(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+    if (NVM_PAGE_EMPTY_VALUE == header.watermark)
+    {
+      continue;
+    }
+
+    pLog = NVM_LogGet(header.watermark & NVM_FIRST_BIT_ZERO);
+    if (NULL == pLog)
+    {
+      continue;
+    }
+
+    NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+    NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE, &firstSequence, sizeof(firstSequence));
+
+    /* The sequence number is written last when a segment is opened. A
+     * segment older than all the others is not kept if the log is full. */
+    if ((NVM_VERSION != header.version) || (NVM_LOG_SEQUENCE_NONE == firstSequence)
+        || ((NVM_LOG_MAX_SEGMENTS == pLog->count) && (firstSequence < pLog->firstSequence[0])))
+    {
+      if (nvmResultOk != NVM_PageErase(pPhysicalAddress))
+      {
+        result = nvmResultError;
+      }
+      continue;
+    }
+
+    if ((NVM_LOG_MAX_SEGMENTS == pLog->count) && (nvmResultOk != NVM_LogSegmentDrop(pLog)))
+    {
+      result = nvmResultError;
+    }
+
+    /* Insert the segment in order. */
+    for (i = pLog->count; (i > 0) && (pLog->firstSequence[i - 1] > firstSequence); --i)
+    {
+      pLog->page[i]          = pLog->page[i - 1];
+      pLog->firstSequence[i] = pLog->firstSequence[i - 1];
+    }
+    pLog->page[i]          = page;
+    pLog->firstSequence[i] = firstSequence;
+    pLog->count++;
+  }
+
+  for (i = 0; (i < NVM_LOG_MAX_PAGES) && (NVM_PAGE_EMPTY_VALUE != nvmLogs[i].pageId); ++i)
+  {
+    pLog = &nvmLogs[i];
+
+    /* Key-value and EEPROM pages use one more segment while they reclaim
+     * space. */
+    while ((pLog->count > pLog->segments)
+           && (!NVM_PAGE_TYPE_RECLAIMED(pLog->pageType) || (pLog->count > (pLog->segments + 1))))
+    {
+      if (nvmResultOk != NVM_LogSegmentDrop(pLog))
+      {
+        result = nvmResultError;
+      }
+    }
+
+    if (0 == pLog->count)
+    {
+      /* No segment is open. */
+      pLog->nextSequence = 0;
+      pLog->tailOffset   = NVM_PAGE_SIZE;
+      continue;
+    }
+
+    if (nvmResultNoPages == result)
+    {
+      result = nvmResultOk;
+    }
+
+    /* Walk the records of the newest segment. A segment that ends in a
+     * broken record is not appended to. */
+    pPhysicalAddress   = (uint8_t *)(nvmConfig->nvmArea) + pLog->page[pLog->count - 1] * NVM_PAGE_SIZE;
+    pLog->tailOffset   = NVM_LOG_RECORDS_START;
+    pLog->nextSequence = pLog->firstSequence[pLog->count - 1];
+
+    while (nvmLogRecordValid == (recordResult = NVM_LogRecordCheck(pPhysicalAddress, pLog->tailOffset, &len)))
+    {
+      pLog->tailOffset += NVM_LOG_RECORD_SIZE(len);
+      pLog->nextSequence++;
+    }
+
+    if (nvmLogRecordBroken == recordResult)
+    {
+      pLog->tailOffset = NVM_PAGE_SIZE;
+    }
+  }
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+  /* Build the hash index of the key-value page. */
+  if (nvmResultOk != NVM_KvInit())
+  {
+    result = nvmResultError;
+  }
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+  if (nvmResultOk != NVM_EepromInit())
+  {
+    result = nvmResultError;
+  }
+#endif
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the index of a log page.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns a pointer to the index, or NULL if the page is not a log or
+ *   key-value page.
+ ******************************************************************************/
+static NVM_Log_t* NVM_LogGet(uint16_t pageId)
+{
+  uint8_t i;
+
+  for (i = 0; i < NVM_LOG_MAX_PAGES; ++i)
+  {
+    if (nvmLogs[i].pageId == pageId)
+    {
+      return &nvmLogs[i];
+    }
+  }
+
+  return NULL;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check a record in a log segment.
+ *
+ * @param[in] pSegment
+ *   Pointer to the start of the segment.
+ *
+ * @param[in] offset
+ *   Offset of the record in the segment.
+ *
+ * @param[out] pLen
+ *   Pointer to where the length of a valid record should be stored.
+ *
+ * @return
+ *   Returns nvmLogRecordEnd if the record header is erased or there is no
+ *   room for it, and nvmLogRecordBroken if the record does not fit in the
+ *   segment or fails its checksum.
+ ******************************************************************************/
+static NVM_Log_Record_Result_t NVM_LogRecordCheck(uint8_t *pSegment, uint16_t offset, uint16_t *pLen)
+{
+  /* Length and checksum of the record. */
+  uint16_t recordHeader[2];
+  /* Checksum calculated from the record. */
+  uint16_t checksum = NVM_CHECKSUM_INITIAL;
+
+  if ((offset + NVM_LOG_RECORD_HEADER_SIZE) > NVM_PAGE_SIZE)
+  {
+    return nvmLogRecordEnd;
+  }
+
+  NVMHAL_Read(pSegment + offset, recordHeader, sizeof(recordHeader));
+
+  if ((NVM_NO_WRITE_16BIT == recordHeader[0]) && (NVM_NO_WRITE_16BIT == recordHeader[1]))
+  {
+    return nvmLogRecordEnd;
+  }
+
+  if ((recordHeader[0] > NVM_LOG_RECORD_MAX)
+      || ((offset + NVM_LOG_RECORD_SIZE(recordHeader[0])) > NVM_PAGE_SIZE))
+  {
+    return nvmLogRecordBroken;
+  }
+
+  NVM_ChecksumAdditive(&checksum, &recordHeader[0], sizeof(recordHeader[0]));
+  NVMHAL_Checksum(&checksum, pSegment + offset + NVM_LOG_RECORD_HEADER_SIZE, recordHeader[0]);
+
+  if (checksum != recordHeader[1])
+  {
+    NVM_STATS_INC(validationFailures)
+    return nvmLogRecordBroken;
+  }
+
+  *pLen = recordHeader[0];
+  return nvmLogRecordValid;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write a record at the end of a log page.
+ *
+ * @details
+ *   The record is assembled in a buffer in RAM from the record header, a
+ *   prefix and the data, and written to the newest segment in word aligned
+ *   steps. The header is in the first word written, so that a record that is
+ *   not completed fails its checksum instead of looking like free space. The
+ *   segment is closed if the write fails. The caller must make sure that
+ *   there is room for the record.
+ *
+ * @param[in] pLog
+ *   Pointer to the index of the log page.
+ *
+ * @param[in] pPrefix
+ *   Pointer to data stored before the data of the record, or NULL.
+ *
+ * @param[in] prefixLen
+ *   The length of the prefix.
+ *
+ * @param[in] pData
+ *   Pointer to the data of the record.
+ *
+ * @param[in] len
+ *   The length of the data.
+ *
+ * @return
+ *   Returns the result of the write operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_LogRecordWrite(NVM_Log_t *pLog, uint8_t const *pPrefix, uint16_t prefixLen, uint8_t const *pData, uint16_t len)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical address of the record. */
+  uint8_t  *pRecord;
+  /* Length and checksum of the record. */
+  uint16_t recordHeader[2];
+
+  /* Buffer used when writing. */
+  uint32_t copyBuffer[NVM_COPY_BUFFER_SIZE / sizeof(uint32_t)];
+  /* Amount of bytes written, and to write in this step. */
+  uint16_t done;
+  uint16_t copyLength;
+  /* Index of a byte in the step, and in the record. */
+  uint16_t i;
+  uint16_t index;
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+  /* Length of the record read back. */
+  uint16_t checkLen;
+#endif
+
+  pRecord = (uint8_t *)(nvmConfig->nvmArea) + pLog->page[pLog->count - 1] * NVM_PAGE_SIZE + pLog->tailOffset;
+
+  recordHeader[0] = prefixLen + len;
+  recordHeader[1] = NVM_CHECKSUM_INITIAL;
+  NVM_ChecksumAdditive(&recordHeader[1], &recordHeader[0], sizeof(recordHeader[0]));
+  NVM_ChecksumAdditive(&recordHeader[1], (void *) pPrefix, prefixLen);
+  NVM_ChecksumAdditive(&recordHeader[1], (void *) pData, len);
+
+  for (done = 0;
+       (done < (NVM_LOG_RECORD_HEADER_SIZE + prefixLen + len)) && (nvmResultOk == result);
+       done += copyLength)
+  {
+    copyLength = NVM_LOG_RECORD_HEADER_SIZE + prefixLen + len - done;
+    if (copyLength > NVM_COPY_BUFFER_SIZE)
+    {
+      copyLength = NVM_COPY_BUFFER_SIZE;
+    }
+
+    for (i = 0; i < copyLength; ++i)
+    {
+      index = done + i;
+      if (index < NVM_LOG_RECORD_HEADER_SIZE)
+      {
+        ((uint8_t *) copyBuffer)[i] = ((uint8_t *) recordHeader)[index];
+      }
+      else if ((index - NVM_LOG_RECORD_HEADER_SIZE) < prefixLen)
+      {
+        ((uint8_t *) copyBuffer)[i] = pPrefix[index - NVM_LOG_RECORD_HEADER_SIZE];
+      }
+      else
+      {
+        ((uint8_t *) copyBuffer)[i] = pData[index - NVM_LOG_RECORD_HEADER_SIZE - prefixLen];
+      }
+    }
+
+    result = NVMHAL_Write(pRecord + done, copyBuffer, copyLength);
+  }
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+  /* Validate that the correct data was written. */
+  if ((nvmResultOk == result)
+      && (nvmLogRecordValid != NVM_LogRecordCheck(pRecord - pLog->tailOffset, pLog->tailOffset, &checkLen)))
+  {
+    result = nvmResultError;
+  }
+#endif
+
+  if (nvmResultOk == result)
+  {
+    pLog->tailOffset += NVM_LOG_RECORD_SIZE(prefixLen + len);
+    pLog->nextSequence++;
+  }
+  else
+  {
+    /* The segment ends at the failed record. */
+    pLog->tailOffset = NVM_PAGE_SIZE;
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Open a new segment in a log page.
+ *
+ * @details
+ *   The new segment is taken from the scratch pages. If the log already uses
+ *   all its segments, the oldest one is erased first. A key-value page is
+ *   instead allowed one more segment for its garbage collector. A newest
+ *   segment that has got no records is erased as well, so that no two
+ *   segments start at the same sequence number.
+ *
+ * @param[in] pLog
+ *   Pointer to the index of the log page.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_LogSegmentOpen(NVM_Log_t *pLog)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical address of the new segment. */
+  uint8_t *pPhysicalAddress;
+
+  /* Page header, used to write the new segment. */
+  NVM_Page_Header_t header;
+
+  /* The log is full until a new segment is open. */
+  pLog->tailOffset = NVM_PAGE_SIZE;
+
+  if ((0 != pLog->count) && (pLog->firstSequence[pLog->count - 1] == pLog->nextSequence))
+  {
+    result = NVM_PageErase((uint8_t *)(nvmConfig->nvmArea) + pLog->page[pLog->count - 1] * NVM_PAGE_SIZE);
+    pLog->count--;
+  }
+
+  if ((nvmResultOk == result) && (pLog->count >= pLog->segments))
+  {
+    /* The segments of key-value and EEPROM pages are reclaimed by the page
+     * itself, which may use one more segment while it works. */
+    if (NVM_PAGE_TYPE_RECLAIMED(pLog->pageType))
+    {
+      if (pLog->count > pLog->segments)
+      {
+        return nvmResultNoPages;
+      }
+    }
+    else
+    {
+      result = NVM_LogSegmentDrop(pLog);
+    }
+  }
+
+  if (nvmResultOk != result)
+  {
+    return result;
+  }
+
+  pPhysicalAddress = NVM_ScratchPageFindBest();
+
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED == pPhysicalAddress)
+  {
+    return nvmResultError;
+  }
+
+  /* Log segments are never marked for copying. The sequence number is
+   * written last, and completes the segment. */
+  header.watermark = pLog->pageId | NVM_FIRST_BIT_ONE;
+  header.version   = NVM_VERSION;
+
+  result = NVMHAL_Write(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+  if (nvmResultOk == result)
+  {
+    result = NVMHAL_Write(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+  }
+  if (nvmResultOk == result)
+  {
+    result = NVMHAL_Write(pPhysicalAddress + NVM_HEADER_SIZE, &pLog->nextSequence, sizeof(pLog->nextSequence));
+  }
+
+  if (nvmResultOk != result)
+  {
+    NVM_PageErase(pPhysicalAddress);
+    return result;
+  }
+
+  pLog->page[pLog->count]          = (pPhysicalAddress - (uint8_t *)(nvmConfig->nvmArea)) / NVM_PAGE_SIZE;
+  pLog->firstSequence[pLog->count] = pLog->nextSequence;
+  pLog->count++;
+  pLog->tailOffset = NVM_LOG_RECORDS_START;
+
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erase the oldest segment of a log page.
+ *
+ * @param[in] pLog
+ *   Pointer to the index of the log page.
+ *
+ * @return
+ *   Returns the result of the erase operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_LogSegmentDrop(NVM_Log_t *pLog)
+{
+  uint8_t i;
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  result = NVM_PageErase((uint8_t *)(nvmConfig->nvmArea) + pLog->page[0] * NVM_PAGE_SIZE);
+
+  pLog->count--;
+  for (i = 0; i < pLog->count; ++i)
+  {
+    pLog->page[i]          = pLog->page[i + 1];
+    pLog->firstSequence[i] = pLog->firstSequence[i + 1];
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find a record in a log page.
+ *
+ * @details
+ *   The segment holding the record is found by a binary search on the first
+ *   sequence number of the segments, and the record by walking the records
+ *   of that segment. The sequence number is moved to the oldest record if it
+ *   is older, and to the end of the log if it is newer than the newest.
+ *
+ * @param[in] pLog
+ *   Pointer to the index of the log page.
+ *
+ * @param[in] sequence
+ *   Sequence number of the record.
+ *
+ * @param[out] pIterator
+ *   Pointer to the iterator to set to the record.
+ ******************************************************************************/
+static void NVM_LogLocate(NVM_Log_t *pLog, uint32_t sequence, NVM_Log_Iterator_t *pIterator)
+{
+  /* Bounds of the binary search. */
+  uint8_t  low;
+  uint8_t  high;
+  uint8_t  middle;
+  /* Physical address of the segment. */
+  uint8_t  *pSegment;
+  /* Sequence number of the current record, and its length. */
+  uint32_t current;
+  uint16_t len;
+
+  pIterator->pageId = pLog->pageId;
+
+  if ((0 == pLog->count) || (sequence >= pLog->nextSequence))
+  {
+    pIterator->sequence = pLog->nextSequence;
+    pIterator->page     = NVM_LOG_NO_SEGMENT;
+    pIterator->offset   = 0;
+    return;
+  }
+
+  if (sequence < pLog->firstSequence[0])
+  {
+    sequence = pLog->firstSequence[0];
+  }
+
+  /* Find the newest segment starting at or before the record. */
+  low  = 0;
+  high = pLog->count - 1;
+  while (low < high)
+  {
+    middle = (low + high + 1) / 2;
+    if (pLog->firstSequence[middle] <= sequence)
+    {
+      low = middle;
+    }
+    else
+    {
+      high = middle - 1;
+    }
+  }
+
+  pSegment          = (uint8_t *)(nvmConfig->nvmArea) + pLog->page[low] * NVM_PAGE_SIZE;
+  pIterator->page   = pLog->page[low];
+  pIterator->offset = NVM_LOG_RECORDS_START;
+
+  /* Walk to the record. If the segment ends before it, the iterator is left
+   * at the end, and NVM_LogNext moves on from there. */
+  for (current = pLog->firstSequence[low];
+       (current < sequence) && (nvmLogRecordValid == NVM_LogRecordCheck(pSegment, pIterator->offset, &len));
+       ++current)
+  {
+    pIterator->offset += NVM_LOG_RECORD_SIZE(len);
+  }
+
+  pIterator->sequence = sequence;
+}
+#endif
+
+#if (NVM_FEATURE_KV_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Build the hash index of the key-value page.
+ *
+ * @details
+ *   The records of all the segments of the key-value page are read from the
+ *   oldest to the newest, so that the newest record of each key ends up in
+ *   the index. Must be run after the segments have been found.
+ *
+ * @return
+ *   Returns nvmResultError if there are more keys than NVM_KV_MAX_KEYS, or a
+ *   page could not be erased.
+ ******************************************************************************/
+static NVM_Result_t NVM_KvInit(void)
+{
+  uint16_t i;
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical address of the current segment. */
+  uint8_t  *pSegment;
+  /* Index of the current segment, and offset of the record in it. */
+  uint8_t  segment;
+  uint16_t offset;
+  /* Length and key of the record. */
+  uint16_t len;
+  uint16_t key;
+  /* Entry of the key in the hash index. */
+  uint16_t index;
+
+  for (i = 0; i < NVM_KV_INDEX_SIZE; ++i)
+  {
+    nvmKvIndex[i].key = NVM_KV_KEY_NONE;
+  }
+
+  nvmKv              = NULL;
+  nvmKvKeys          = 0;
+  nvmKvLiveSize      = 0;
+  nvmKvCollectPage   = NVM_LOG_NO_SEGMENT;
+  nvmKvCollectOffset = NVM_LOG_RECORDS_START;
+
+  for (i = 0; i < NVM_LOG_MAX_PAGES; ++i)
+  {
+    if ((NVM_PAGE_EMPTY_VALUE != nvmLogs[i].pageId) && (nvmPageTypeKv == nvmLogs[i].pageType))
+    {
+      nvmKv = &nvmLogs[i];
+    }
+  }
+
+  if (NULL == nvmKv)
+  {
+    return nvmResultOk;
+  }
+
+  /* The garbage collector only uses one more segment for the records it
+   * moves, which are all still in the oldest segment. The collection is
+   * started over. */
+  if (nvmKv->count > nvmKv->segments)
+  {
+    if (nvmResultOk != NVM_PageErase((uint8_t *)(nvmConfig->nvmArea) + nvmKv->page[nvmKv->count - 1] * NVM_PAGE_SIZE))
+    {
+      result = nvmResultError;
+    }
+    nvmKv->count--;
+    nvmKv->tailOffset = NVM_PAGE_SIZE;
+  }
+
+  for (segment = 0; segment < nvmKv->count; ++segment)
+  {
+    pSegment = (uint8_t *)(nvmConfig->nvmArea) + nvmKv->page[segment] * NVM_PAGE_SIZE;
+
+    for (offset = NVM_LOG_RECORDS_START;
+         nvmLogRecordValid == NVM_LogRecordCheck(pSegment, offset, &len);
+         offset += NVM_LOG_RECORD_SIZE(len))
+    {
+      if (len < NVM_KV_KEY_SIZE)
+      {
+        continue;
+      }
+
+      NVMHAL_Read(pSegment + offset + NVM_LOG_RECORD_HEADER_SIZE, &key, sizeof(key));
+
+      if (0 != (key & NVM_KV_KEY_DELETED))
+      {
+        index = NVM_KvFind(key & NVM_KV_KEY_MAX);
+        if (NVM_KV_NO_ENTRY != index)
+        {
+          NVM_KvRemove(index);
+        }
+      }
+      else if (!NVM_KvInsert(key, nvmKv->page[segment], offset, len - NVM_KV_KEY_SIZE))
+      {
+        result = nvmResultError;
+      }
+    }
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find a key in the hash index of the key-value page.
+ *
+ * @param[in] key
+ *   The key.
+ *
+ * @return
+ *   Returns the index of the entry of the key, or NVM_KV_NO_ENTRY.
+ ******************************************************************************/
+static uint16_t NVM_KvFind(uint16_t key)
+{
+  uint16_t index;
+
+  /* The index is never more than half full, so there is always a free
+   * entry to stop at. */
+  for (index = key % NVM_KV_INDEX_SIZE;
+       NVM_KV_KEY_NONE != nvmKvIndex[index].key;
+       index = (index + 1) % NVM_KV_INDEX_SIZE)
+  {
+    if (nvmKvIndex[index].key == key)
+    {
+      return index;
+    }
+  }
+
+  return NVM_KV_NO_ENTRY;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the record of a key in the hash index of the key-value page.
+ *
+ * @param[in] key
+ *   The key.
+ *
+ * @param[in] page
+ *   Physical page of the record.
+ *
+ * @param[in] offset
+ *   Offset of the record in the physical page.
+ *
+ * @param[in] len
+ *   Length of the value.
+ *
+ * @return
+ *   Returns false if the key is new, and there are NVM_KV_MAX_KEYS keys
+ *   already.
+ ******************************************************************************/
+static bool NVM_KvInsert(uint16_t key, uint16_t page, uint16_t offset, uint16_t len)
+{
+  /* Entry of the key in the hash index. */
+  uint16_t index = NVM_KvFind(key);
+
+  if (NVM_KV_NO_ENTRY == index)
+  {
+    if (nvmKvKeys >= NVM_KV_MAX_KEYS)
+    {
+      return false;
+    }
+
+    for (index = key % NVM_KV_INDEX_SIZE;
+         NVM_KV_KEY_NONE != nvmKvIndex[index].key;
+         index = (index + 1) % NVM_KV_INDEX_SIZE)
+    {
+    }
+
+    nvmKvIndex[index].key = key;
+    nvmKvKeys++;
+  }
+  else
+  {
+    nvmKvLiveSize -= NVM_LOG_RECORD_SIZE(NVM_KV_KEY_SIZE + nvmKvIndex[index].len);
+  }
+
+  nvmKvIndex[index].page   = page;
+  nvmKvIndex[index].offset = offset;
+  nvmKvIndex[index].len    = len;
+  nvmKvLiveSize += NVM_LOG_RECORD_SIZE(NVM_KV_KEY_SIZE + len);
+
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Remove an entry from the hash index of the key-value page.
+ *
+ * @details
+ *   The entries after it that would no longer be found from the position
+ *   of their key are moved back into the free entry.
+ *
+ * @param[in] index
+ *   Index of the entry.
+ ******************************************************************************/
+static void NVM_KvRemove(uint16_t index)
+{
+  /* Index of the entry checked, and the position of its key. */
+  uint16_t next = index;
+  uint16_t home;
+
+  nvmKvLiveSize -= NVM_LOG_RECORD_SIZE(NVM_KV_KEY_SIZE + nvmKvIndex[index].len);
+  nvmKvKeys--;
+  nvmKvIndex[index].key = NVM_KV_KEY_NONE;
+
+  for (;;)
+  {
+    next = (next + 1) % NVM_KV_INDEX_SIZE;
+    if (NVM_KV_KEY_NONE == nvmKvIndex[next].key)
+    {
+      break;
+    }
+
+    /* Move the entry unless its position is after the free entry. */
+    home = nvmKvIndex[next].key % NVM_KV_INDEX_SIZE;
+    if ((index <= next) ? ((home <= index) || (home > next)) : ((home <= index) && (home > next)))
+    {
+      nvmKvIndex[index]     = nvmKvIndex[next];
+      nvmKvIndex[next].key  = NVM_KV_KEY_NONE;
+      index                 = next;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Append a record to the key-value page.
+ *
+ * @details
+ *   This function makes room for the record, writes it and updates the hash
+ *   index. When the page uses all its segments, the oldest one is collected
+ *   if there is no room, and a step of the garbage collector is run after
+ *   the write.
+ *
+ * @param[in] key
+ *   The key, with NVM_KV_KEY_DELETED set to delete it.
+ *
+ * @param[in] pData
+ *   Pointer to the value.
+ *
+ * @param[in] len
+ *   The length of the value.
+ *
+ * @return
+ *   Returns the result of the write operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_KvRecordWrite(uint16_t key, void const *pData, uint16_t len)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical page and offset of the record. */
+  uint16_t page;
+  uint16_t offset;
+
+  /* Entry of the key in the hash index. */
+  uint16_t index;
+
+  /* Number of attempts to make room for the record. */
+  uint8_t  attempts;
+
+  for (attempts = 0;
+       (nvmResultOk == result) && ((nvmKv->tailOffset + NVM_LOG_RECORD_SIZE(NVM_KV_KEY_SIZE + len)) > NVM_PAGE_SIZE);
+       ++attempts)
+  {
+    if (attempts > nvmKv->segments)
+    {
+      result = nvmResultNoPages;
+    }
+    else if (nvmKv->count < nvmKv->segments)
+    {
+      result = NVM_LogSegmentOpen(nvmKv);
+    }
+    else
+    {
+      result = NVM_KvCollect(NVM_KV_COLLECT_ALL);
+    }
+  }
+
+  if (nvmResultOk == result)
+  {
+    page   = nvmKv->page[nvmKv->count - 1];
+    offset = nvmKv->tailOffset;
+    result = NVM_LogRecordWrite(nvmKv, (uint8_t const *) &key, NVM_KV_KEY_SIZE, (uint8_t const *) pData, len);
+  }
+
+  if (nvmResultOk == result)
+  {
+    if (0 != (key & NVM_KV_KEY_DELETED))
+    {
+      index = NVM_KvFind(key & NVM_KV_KEY_MAX);
+      if (NVM_KV_NO_ENTRY != index)
+      {
+        NVM_KvRemove(index);
+      }
+    }
+    else
+    {
+      NVM_KvInsert(key, page, offset, len);
+    }
+
+    NVM_STATS_INC(kvWrites)
+
+    /* The value is written, so a failed step only leaves garbage for the
+     * next one. */
+    if (nvmKv->count >= nvmKv->segments)
+    {
+      NVM_KvCollect(NVM_KV_COLLECT_STEP);
+    }
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Set the value of a key in the key-value page.
+ *
+ * @details
+ *   This function does the work of NVM_KvSet for a key that is checked
+ *   already, and must be called with the write lock held. Nothing is
+ *   written if the value is unchanged.
+ *
+ * @param[in] key
+ *   The key.
+ *
+ * @param[in] pData
+ *   Pointer to the value.
+ *
+ * @param[in] len
+ *   The length of the value.
+ *
+ * @return
+ *   Returns nvmResultNoPages if there are NVM_KV_MAX_KEYS keys already, or
+ *   if the values would take more than all but one of the physical pages of
+ *   the key-value page. Otherwise returns the result of the write operation
+ *   using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_KvValueWrite(uint16_t key, void const *pData, uint16_t len)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  /* Entry of the key in the hash index. */
+  uint16_t index;
+
+  /* Size of the newest records of all the keys after the write. */
+  uint32_t liveSize;
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Address of the old value. */
+  uint8_t  *pValue;
+  /* Single byte buffer used when comparing with the old value. */
+  uint8_t  copyBuffer;
+  /* Amount of bytes compared. */
+  uint16_t copyLength;
+#endif
+
+  index = NVM_KvFind(key);
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Nothing is written if the value is unchanged. */
+  if ((NVM_KV_NO_ENTRY != index) && (nvmKvIndex[index].len == len))
+  {
+    pValue = (uint8_t *)(nvmConfig->nvmArea) + nvmKvIndex[index].page * NVM_PAGE_SIZE
+             + nvmKvIndex[index].offset + NVM_LOG_RECORD_HEADER_SIZE + NVM_KV_KEY_SIZE;
+
+    for (copyLength = 0; copyLength < len; copyLength += sizeof(copyBuffer))
+    {
+      NVMHAL_Read(pValue + copyLength, &copyBuffer, sizeof(copyBuffer));
+      if (((uint8_t const *) pData)[copyLength] != copyBuffer)
+      {
+        break;
+      }
+    }
+
+    if (copyLength == len)
+    {
+      NVM_STATS_INC(writesSkipped)
+      return nvmResultOk;
+    }
+  }
+#endif
+
+  /* The values must leave a physical page for the garbage collector. */
+  liveSize = nvmKvLiveSize + NVM_LOG_RECORD_SIZE(NVM_KV_KEY_SIZE + len);
+  if (NVM_KV_NO_ENTRY != index)
+  {
+    liveSize -= NVM_LOG_RECORD_SIZE(NVM_KV_KEY_SIZE + nvmKvIndex[index].len);
+  }
+
+  if (((NVM_KV_NO_ENTRY == index) && (nvmKvKeys >= NVM_KV_MAX_KEYS))
+      || (liveSize > ((uint32_t)(nvmKv->segments - 1) * NVM_LOG_SEGMENT_SPACE)))
+  {
+    result = nvmResultNoPages;
+  }
+  else
+  {
+    result = NVM_KvRecordWrite(key, pData, len);
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Collect garbage in the key-value page.
+ *
+ * @details
+ *   This function checks the records of the oldest segment in order, and
+ *   moves each record that holds the newest value of its key to the newest
+ *   segment. The oldest segment is erased when all its records are checked.
+ *
+ *   A step stops early if the newest segment is full. A full collection
+ *   instead opens a new segment, and goes on until the oldest segment is
+ *   erased.
+ *
+ * @param[in] steps
+ *   The number of records to check, or NVM_KV_COLLECT_ALL.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_KvCollect(uint16_t steps)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Set if the whole oldest segment is collected. */
+  bool all = (NVM_KV_COLLECT_ALL == steps);
+
+  /* Physical address of the oldest segment, and of the moved record. */
+  uint8_t  *pSegment;
+  uint8_t  *pDestination;
+
+  /* Length and key of the record. */
+  uint16_t len;
+  uint16_t key;
+  /* Entry of the key in the hash index. */
+  uint16_t index;
+  /* Checksum of the data copied, not used. */
+  uint16_t checksum = NVM_CHECKSUM_INITIAL;
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+  /* Length of the record read back. */
+  uint16_t checkLen;
+#endif
+
+  while ((all || (0 != steps)) && (nvmKv->count > 1))
+  {
+    steps--;
+
+    /* Start at the first record of a new oldest segment. */
+    if (nvmKvCollectPage != nvmKv->page[0])
+    {
+      nvmKvCollectPage   = nvmKv->page[0];
+      nvmKvCollectOffset = NVM_LOG_RECORDS_START;
+    }
+
+    pSegment = (uint8_t *)(nvmConfig->nvmArea) + nvmKv->page[0] * NVM_PAGE_SIZE;
+
+    if (nvmLogRecordValid != NVM_LogRecordCheck(pSegment, nvmKvCollectOffset, &len))
+    {
+      /* Every record left in the segment has been moved. */
+      result = NVM_LogSegmentDrop(nvmKv);
+      break;
+    }
+
+    index = NVM_KV_NO_ENTRY;
+    if (len >= NVM_KV_KEY_SIZE)
+    {
+      NVMHAL_Read(pSegment + nvmKvCollectOffset + NVM_LOG_RECORD_HEADER_SIZE, &key, sizeof(key));
+      if (0 == (key & NVM_KV_KEY_DELETED))
+      {
+        index = NVM_KvFind(key);
+      }
+    }
+
+    /* Move the record if it holds the newest value of its key. Deletions
+     * are dropped, since there are no older records left for them to hide. */
+    if ((NVM_KV_NO_ENTRY != index)
+        && (nvmKvIndex[index].page == nvmKv->page[0])
+        && (nvmKvIndex[index].offset == nvmKvCollectOffset))
+    {
+      if ((nvmKv->tailOffset + NVM_LOG_RECORD_SIZE(len)) > NVM_PAGE_SIZE)
+      {
+        if (!all)
+        {
+          break;
+        }
+
+        result = NVM_LogSegmentOpen(nvmKv);
+        if (nvmResultOk != result)
+        {
+          break;
+        }
+      }
+
+      /* The record is copied as it is, since the checksum does not depend
+       * on where it is stored. */
+      pDestination = (uint8_t *)(nvmConfig->nvmArea) + nvmKv->page[nvmKv->count - 1] * NVM_PAGE_SIZE;
+      result       = NVM_PageCopy(pDestination + nvmKv->tailOffset,
+                                  pSegment + nvmKvCollectOffset,
+                                  NVM_LOG_RECORD_HEADER_SIZE + len,
+                                  &checksum);
+
+#if (NVM_FEATURE_WRITE_VALIDATION_ENABLED == true)
+      /* Validate that the correct data was written. */
+      if ((nvmResultOk == result)
+          && (nvmLogRecordValid != NVM_LogRecordCheck(pDestination, nvmKv->tailOffset, &checkLen)))
+      {
+        result = nvmResultError;
+      }
+#endif
+
+      if (nvmResultOk != result)
+      {
+        /* The segment ends at the failed record. */
+        nvmKv->tailOffset = NVM_PAGE_SIZE;
+        break;
+      }
+
+      nvmKvIndex[index].page   = nvmKv->page[nvmKv->count - 1];
+      nvmKvIndex[index].offset = nvmKv->tailOffset;
+      nvmKv->tailOffset       += NVM_LOG_RECORD_SIZE(len);
+      nvmKv->nextSequence++;
+      NVM_STATS_INC(kvMoves)
+    }
+
+    nvmKvCollectOffset += NVM_LOG_RECORD_SIZE(len);
+  }
+
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Read an object or all the objects of a packed page to RAM.
+ *
+ * @details
+ *   The objects are read from the value of the page in the key-value page.
+ *   An object after the end of the value, because the page has grown since
+ *   it was written, is left as it is in RAM.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object, or NVM_READ_ALL.
+ *
+ * @return
+ *   Returns nvmResultNoPage if the page has not been written, and
+ *   nvmResultDataInvalid if its record failed validation.
+ ******************************************************************************/
+static NVM_Result_t NVM_PackedRead(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+  /* Entry of the page in the hash index. */
+  uint16_t index = NVM_KvFind(NVM_KV_PACKED_KEY(pPageDesc->pageId));
+
+  /* Physical address of the segment holding the value. */
+  uint8_t  *pSegment;
+
+  /* Index of object in page. */
+  uint16_t objectIndex   = 0;
+  /* Address of the object within the value. */
+  uint16_t offsetAddress = 0;
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+  /* Length of the record. */
+  uint16_t len;
+#endif
+
+  if (NVM_KV_NO_ENTRY == index)
+  {
+    return nvmResultNoPage;
+  }
+
+  pSegment = (uint8_t *)(nvmConfig->nvmArea) + nvmKvIndex[index].page * NVM_PAGE_SIZE;
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+  if ((nvmLogRecordValid != NVM_LogRecordCheck(pSegment, nvmKvIndex[index].offset, &len))
+      || (len != (NVM_KV_KEY_SIZE + nvmKvIndex[index].len)))
+  {
+    return nvmResultDataInvalid;
+  }
+#endif
+
+  /* Loop through and read the objects of a page, as long as the current item
+   * has got a size other than 0. Size 0 is a marker for the NULL object. */
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    if (((NVM_READ_ALL_CMD == objectId) || ((*pPageDesc->page)[objectIndex].objectId == objectId))
+        && (NULL != (*pPageDesc->page)[objectIndex].location)
+        && ((offsetAddress + (*pPageDesc->page)[objectIndex].size) <= nvmKvIndex[index].len))
+    {
+      NVMHAL_Read(pSegment + nvmKvIndex[index].offset + NVM_LOG_RECORD_HEADER_SIZE + NVM_KV_KEY_SIZE + offsetAddress,
+                  (*pPageDesc->page)[objectIndex].location,
+                  (*pPageDesc->page)[objectIndex].size);
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write an object or all the objects of a packed page.
+ *
+ * @details
+ *   The objects selected by the object id are taken from RAM and the others
+ *   from the old value, and the whole value is appended to the key-value
+ *   page. An object that is not in the old value is left erased. Like a
+ *   relocated page, the old value is kept if the write is interrupted by a
+ *   power loss.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write from RAM, NVM_WRITE_ALL, NVM_WRITE_NONE
+ *   or NVM_WRITE_VECTOR.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PackedWrite(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+  /* Key of the value of the page. */
+  uint16_t key = NVM_KV_PACKED_KEY(pPageDesc->pageId);
+
+  /* Entry of the page in the hash index. */
+  uint16_t index = NVM_KvFind(key);
+
+  /* Address and length of the old value, if any. */
+  uint8_t  *pOldValue = NULL;
+  uint16_t oldLen     = 0;
+
+  /* Index of object in page. */
+  uint16_t objectIndex   = 0;
+  /* Address of the object within the value. */
+  uint16_t offsetAddress = 0;
+  /* Amount of bytes copied. */
+  uint16_t copyLength;
+
+  if (NULL == nvmKv)
+  {
+    return nvmResultInputInvalid;
+  }
+
+  if (NVM_KV_NO_ENTRY != index)
+  {
+    pOldValue = (uint8_t *)(nvmConfig->nvmArea) + nvmKvIndex[index].page * NVM_PAGE_SIZE
+                + nvmKvIndex[index].offset + NVM_LOG_RECORD_HEADER_SIZE + NVM_KV_KEY_SIZE;
+    oldLen    = nvmKvIndex[index].len;
+  }
+
+  /* Loop through the objects of the page, as long as the current item has got
+   * a size other than 0. Size 0 is a marker for the NULL object. */
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    if (NVM_ObjectSelected(objectId, (*pPageDesc->page)[objectIndex].objectId)
+        && (NULL != (*pPageDesc->page)[objectIndex].location))
+    {
+      /* Take object from RAM. */
+      for (copyLength = 0; copyLength < (*pPageDesc->page)[objectIndex].size; ++copyLength)
+      {
+        nvmPackedBuffer[offsetAddress + copyLength] = (*pPageDesc->page)[objectIndex].location[copyLength];
+      }
+    }
+    else if ((offsetAddress + (*pPageDesc->page)[objectIndex].size) <= oldLen)
+    {
+      /* Take object from the old value. */
+      NVMHAL_Read(pOldValue + offsetAddress,
+                  &nvmPackedBuffer[offsetAddress],
+                  (*pPageDesc->page)[objectIndex].size);
+    }
+    else
+    {
+      for (copyLength = 0; copyLength < (*pPageDesc->page)[objectIndex].size; ++copyLength)
+      {
+        nvmPackedBuffer[offsetAddress + copyLength] = NVM_NO_WRITE_8BIT;
+      }
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  return NVM_KvValueWrite(key, nvmPackedBuffer, offsetAddress);
+}
+#endif
+
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Describe the objects held by a segment of a spanning page.
+ *
+ * @details
+ *   The objects of a spanning page are stored after each other, and each
+ *   segment holds the next NVM_CONTENT_SIZE bytes of them. The returned
+ *   descriptor is for a normal page with the parts of the objects in the
+ *   segment, and keeps their object IDs. It is only valid until the next
+ *   call.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the spanning page.
+ *
+ * @param[in] segment
+ *   Number of the segment.
+ *
+ * @return
+ *   Returns the descriptor of the segment. It has got no objects if the
+ *   segment is after the end of the page.
+ ******************************************************************************/
+static NVM_Page_Descriptor_t NVM_SpanSegmentGet(NVM_Page_Descriptor_t const *pPageDesc, uint8_t segment)
+{
+  /* Descriptor of the segment. */
+  NVM_Page_Descriptor_t segmentDesc = *pPageDesc;
+
+  /* Index of object in page, and number of objects in the segment. */
+  uint16_t objectIndex = 0;
+  uint16_t count       = 0;
+  /* Address of the object within the page. */
+  uint32_t offsetAddress = 0;
+  /* Bytes of the page held by the segment. */
+  uint32_t start = (uint32_t) segment * NVM_CONTENT_SIZE;
+  uint32_t end   = start + NVM_CONTENT_SIZE;
+  /* Bytes of the object held by the segment. */
+  uint32_t first;
+  uint32_t last;
+
+  while (((*pPageDesc->page)[objectIndex].size != 0) && (count < NVM_SPAN_MAX_OBJECTS))
+  {
+    first = (offsetAddress > start) ? offsetAddress : start;
+    last  = offsetAddress + (*pPageDesc->page)[objectIndex].size;
+    last  = (last < end) ? last : end;
+
+    if (first < last)
+    {
+      nvmSpanObjects[count].location = NULL;
+      if (NULL != (*pPageDesc->page)[objectIndex].location)
+      {
+        nvmSpanObjects[count].location = (*pPageDesc->page)[objectIndex].location + (first - offsetAddress);
+      }
+      nvmSpanObjects[count].size     = (uint16_t)(last - first);
+      nvmSpanObjects[count].objectId = (*pPageDesc->page)[objectIndex].objectId;
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+      nvmSpanObjects[count].offset   = (uint16_t)(first - start);
+#endif
+      count++;
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  nvmSpanObjects[count].location = NULL;
+  nvmSpanObjects[count].size     = 0;
+  nvmSpanObjects[count].objectId = 0;
+
+  segmentDesc.page     = (NVM_Page_t const *) &nvmSpanObjects;
+  segmentDesc.pageType = nvmPageTypeNormal;
+
+  return segmentDesc;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read an object or all the objects of a spanning page to RAM.
+ *
+ * @details
+ *   Only the segments holding parts of the object are found and checked, and
+ *   each of them is read like a normal page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object, or NVM_READ_ALL.
+ *
+ * @return
+ *   Returns nvmResultNoPage if a segment has not been written, and
+ *   nvmResultDataInvalid if it failed validation.
+ ******************************************************************************/
+static NVM_Result_t NVM_SpanRead(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Descriptor and physical address of the current segment. */
+  NVM_Page_Descriptor_t segmentDesc;
+  uint8_t               *pPhysicalAddress;
+
+  /* Number of the segment, and index of object in it. */
+  uint8_t segment;
+  uint16_t objectIndex;
+
+  for (segment = 0; (segment < NVM_SPAN_MAX_SEGMENTS) && (nvmResultOk == result); ++segment)
+  {
+    segmentDesc = NVM_SpanSegmentGet(pPageDesc, segment);
+
+    /* Skip segments without any part of the object. */
+    for (objectIndex = 0;
+         ((*segmentDesc.page)[objectIndex].size != 0)
+         && (NVM_READ_ALL_CMD != objectId) && ((*segmentDesc.page)[objectIndex].objectId != objectId);
+         ++objectIndex)
+    {
+    }
+    if ((*segmentDesc.page)[objectIndex].size == 0)
+    {
+      continue;
+    }
+
+    pPhysicalAddress = NVM_PageFind(NVM_SPAN_SEGMENT_ID(pPageDesc->pageId, segment));
+
+    if ((uint8_t *) NVM_NO_PAGE_RETURNED == pPhysicalAddress)
+    {
+      result = nvmResultNoPage;
+    }
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+    else if (nvmValidateResultError == NVM_PageValidateDeferred(pPhysicalAddress))
+    {
+      result = nvmResultDataInvalid;
+    }
+#endif
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+    else if (nvmValidateResultError == NVM_PageValidate(pPhysicalAddress))
+    {
+      result = nvmResultDataInvalid;
+    }
+#endif
+    else
+    {
+      /* Validation described the same segment again. */
+      result = NVM_ObjectRead(pPhysicalAddress, &segmentDesc, objectId);
+    }
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write an object or all the objects of a spanning page.
+ *
+ * @details
+ *   Each segment is written like a normal page, with the parts of the
+ *   selected objects from RAM and the rest copied from the old version. A
+ *   segment without any changed part is left as it is, and a segment that
+ *   does not exist yet is always written.
+ *
+ *   Each segment is replaced on its own. If a write of several segments is
+ *   interrupted by a power loss, some of them might have been replaced.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write from RAM, NVM_WRITE_ALL, NVM_WRITE_NONE
+ *   or NVM_WRITE_VECTOR.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_SpanWrite(NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Descriptor, ID and old physical address of the current segment. */
+  NVM_Page_Descriptor_t segmentDesc;
+  uint16_t              segmentId;
+  uint8_t               *pOldPhysicalAddress;
+
+  /* Number of the segment. */
+  uint8_t segment;
+
+  for (segment = 0; (segment < NVM_SPAN_MAX_SEGMENTS) && (nvmResultOk == result); ++segment)
+  {
+    segmentDesc = NVM_SpanSegmentGet(pPageDesc, segment);
+    if ((*segmentDesc.page)[0].size == 0)
+    {
+      break;
+    }
+
+    segmentId           = NVM_SPAN_SEGMENT_ID(pPageDesc->pageId, segment);
+    pOldPhysicalAddress = NVM_PageFind(segmentId);
+
+    if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+    {
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+      /* Parts not written from RAM are copied from the old segment. */
+      if ((NVM_WRITE_ALL_CMD != objectId)
+          && (nvmValidateResultError == NVM_PageValidateDeferred(pOldPhysicalAddress)))
+      {
+        result = nvmResultDataInvalid;
+        break;
+      }
+
+      /* Validation described the same segment again. */
+#endif
+      if (!NVM_SpanSegmentChanged(pOldPhysicalAddress, &segmentDesc, objectId))
+      {
+        continue;
+      }
+    }
+
+    result = NVM_PageRelocate(segmentId, &segmentDesc, objectId, pOldPhysicalAddress, NULL, NVM_VERSION);
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check if a segment of a spanning page must be rewritten.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the old version of the segment.
+ *
+ * @param[in] pSegmentDesc
+ *   The descriptor of the segment.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write from RAM, NVM_WRITE_ALL, NVM_WRITE_NONE
+ *   or NVM_WRITE_VECTOR.
+ *
+ * @return
+ *   Returns true if the segment holds a part of an object written from RAM,
+ *   which is different from the old version when
+ *   NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED is set.
+ ******************************************************************************/
+static bool NVM_SpanSegmentChanged(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pSegmentDesc, NVM_Object_Id_t objectId)
+{
+  /* Index of object in the segment, and its address within it. */
+  uint16_t objectIndex   = 0;
+  uint16_t offsetAddress = 0;
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Single byte buffer used when comparing with the old segment. */
+  uint8_t  copyBuffer;
+  /* Amount of bytes compared. */
+  uint16_t copyLength;
+#endif
+
+  while ((*pSegmentDesc->page)[objectIndex].size != 0)
+  {
+    if (NVM_ObjectSelected(objectId, (*pSegmentDesc->page)[objectIndex].objectId)
+        && (NULL != (*pSegmentDesc->page)[objectIndex].location))
+    {
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+      for (copyLength = 0; copyLength < (*pSegmentDesc->page)[objectIndex].size; copyLength += sizeof(copyBuffer))
+      {
+        NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE + offsetAddress + copyLength, &copyBuffer, sizeof(copyBuffer));
+        if ((*pSegmentDesc->page)[objectIndex].location[copyLength] != copyBuffer)
+        {
+          return true;
+        }
+      }
+#else
+      return true;
+#endif
+    }
+
+    offsetAddress += (*pSegmentDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  NVM_STATS_INC(writesSkipped)
+#endif
+
+  return false;
+}
+#endif
+
+#if (NVM_FEATURE_COMPRESSED_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Describe the encoded content of a compressed page.
+ *
+ * @details
+ *   The returned descriptor has got one object, holding the length of the
+ *   encoded objects and the encoded objects, so that the checksum of the page
+ *   is calculated over them. A length too big for the page is cut to the
+ *   content of the page. The descriptor is only valid until the next call.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @return
+ *   Returns the descriptor of the encoded content.
+ ******************************************************************************/
+static NVM_Page_Descriptor_t NVM_CompressedContentGet(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t const *pPageDesc)
+{
+  /* Descriptor returned. */
+  NVM_Page_Descriptor_t contentDesc = *pPageDesc;
+
+  /* Length of the encoded objects. */
+  uint16_t length;
+
+  NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE, &length, sizeof(length));
+  if (length > NVM_COMPRESSED_STREAM_SIZE)
+  {
+    length = NVM_COMPRESSED_STREAM_SIZE;
+  }
+
+  nvmCompressedObjects[0].location = NULL;
+  nvmCompressedObjects[0].size     = NVM_COMPRESSED_LENGTH_SIZE + length;
+  nvmCompressedObjects[0].objectId = 0;
+
+  nvmCompressedObjects[1].location = NULL;
+  nvmCompressedObjects[1].size     = 0;
+  nvmCompressedObjects[1].objectId = 0;
+
+  contentDesc.page = (NVM_Page_t const *) &nvmCompressedObjects;
+
+  return contentDesc;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decode the objects of a compressed page to the buffer.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @return
+ *   Returns the number of bytes decoded, or NVM_NO_WRITE_16BIT if the encoded
+ *   objects are not valid.
+ ******************************************************************************/
+static uint16_t NVM_CompressedDecode(uint8_t *pPhysicalAddress)
+{
+  /* Length of the encoded objects, and the position in them. */
+  uint16_t length;
+  uint16_t in  = 0;
+  /* Number of bytes decoded. */
+  uint16_t out = 0;
+
+  /* Control byte, the byte repeated by it, and the number of bytes it
+   * stands for. */
+  uint8_t  control;
+  uint8_t  value;
+  uint16_t count;
+
+  /* Address of the encoded objects. */
+  uint8_t *pStream = pPhysicalAddress + NVM_HEADER_SIZE + NVM_COMPRESSED_LENGTH_SIZE;
+
+  NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE, &length, sizeof(length));
+  if (length > NVM_COMPRESSED_STREAM_SIZE)
+  {
+    return NVM_NO_WRITE_16BIT;
+  }
+
+  while (in < length)
+  {
+    NVMHAL_Read(pStream + in, &control, sizeof(control));
+    in++;
+
+    if ((control & NVM_RLE_RUN_FLAG) != 0)
+    {
+      count = (control & ~NVM_RLE_RUN_FLAG) + NVM_RLE_RUN_MIN;
+      if ((in >= length) || ((out + count) > NVM_COMPRESSED_PAGE_MAX_SIZE))
+      {
+        return NVM_NO_WRITE_16BIT;
+      }
+
+      NVMHAL_Read(pStream + in, &value, sizeof(value));
+      in++;
+
+      while (count-- > 0)
+      {
+        nvmCompressedBuffer[out++] = value;
+      }
+    }
+    else
+    {
+      count = control + 1U;
+      if (((in + count) > length) || ((out + count) > NVM_COMPRESSED_PAGE_MAX_SIZE))
+      {
+        return NVM_NO_WRITE_16BIT;
+      }
+
+      NVMHAL_Read(pStream + in, &nvmCompressedBuffer[out], count);
+      in  += count;
+      out += count;
+    }
+  }
+
+  return out;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Read an object or all the objects of a compressed page to RAM.
+ *
+ * @details
+ *   The whole page is decoded to the buffer, and the selected objects are
+ *   copied from there.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object, or NVM_READ_ALL.
+ *
+ * @return
+ *   Returns nvmResultDataInvalid if the encoded objects do not decode to the
+ *   size of the objects.
+ ******************************************************************************/
+static NVM_Result_t NVM_CompressedRead(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId)
+{
+  /* Number of bytes decoded. */
+  uint16_t length = NVM_CompressedDecode(pPhysicalAddress);
+
+  /* Index of object in page. */
+  uint16_t objectIndex   = 0;
+  /* Address of the object within the decoded objects. */
+  uint16_t offsetAddress = 0;
+  /* Amount of bytes copied. */
+  uint16_t copyLength;
+
+  /* Loop through the objects of the page, as long as the current item has got
+   * a size other than 0. Size 0 is a marker for the NULL object. */
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  if (length != offsetAddress)
+  {
+    return nvmResultDataInvalid;
+  }
+
+  objectIndex   = 0;
+  offsetAddress = 0;
+
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    if (((NVM_READ_ALL_CMD == objectId) || ((*pPageDesc->page)[objectIndex].objectId == objectId))
+        && (NULL != (*pPageDesc->page)[objectIndex].location))
+    {
+      for (copyLength = 0; copyLength < (*pPageDesc->page)[objectIndex].size; ++copyLength)
+      {
+        (*pPageDesc->page)[objectIndex].location[copyLength] = nvmCompressedBuffer[offsetAddress + copyLength];
+      }
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write an object or all the objects of a compressed page.
+ *
+ * @details
+ *   The objects are put together in the buffer, with the selected objects
+ *   taken from RAM and the others decoded from the old version, and then run
+ *   length encoded. Runs of three or more equal bytes are stored as two bytes,
+ *   and other bytes are stored with one control byte per 128 bytes. The
+ *   encoded objects are written like a normal page with one object.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to write.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write from RAM, NVM_WRITE_ALL, NVM_WRITE_NONE
+ *   or NVM_WRITE_VECTOR.
+ *
+ * @param[in] pOldPhysicalAddress
+ *   Pointer to the old version of the page, or NVM_NO_PAGE_RETURNED.
+ *
+ * @return
+ *   Returns nvmResultError if the encoded objects do not fit in the page, and
+ *   nvmResultDataInvalid if the old version could not be decoded.
+ ******************************************************************************/
+static NVM_Result_t NVM_CompressedWrite(uint16_t pageId, NVM_Page_Descriptor_t *pPageDesc, NVM_Object_Id_t objectId, uint8_t *pOldPhysicalAddress)
+{
+  /* Descriptor of the encoded content. */
+  NVM_Page_Descriptor_t contentDesc = *pPageDesc;
+
+  /* Size of all the objects, and the length of the encoded objects. */
+  uint16_t size = 0;
+  uint16_t length;
+
+  /* Index of object in page. */
+  uint16_t objectIndex   = 0;
+  /* Address of the object within the buffer. */
+  uint16_t offsetAddress = 0;
+  /* Amount of bytes copied. */
+  uint16_t copyLength;
+
+  /* Position in the buffer, and the position in and length of the encoded
+   * objects. */
+  uint16_t in  = 0;
+  uint16_t out = NVM_COMPRESSED_LENGTH_SIZE;
+  /* Number of equal bytes, or of bytes stored as they are. */
+  uint16_t run;
+  uint16_t literal;
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* Single byte buffer used when comparing with the old page. */
+  uint8_t  copyBuffer;
+#endif
+
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    size += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  /* Objects not written from RAM keep the old version, or are left erased. */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress) && (NVM_WRITE_ALL_CMD != objectId))
+  {
+    if (NVM_CompressedDecode(pOldPhysicalAddress) != size)
+    {
+      return nvmResultDataInvalid;
+    }
+  }
+  else
+  {
+    for (copyLength = 0; copyLength < size; ++copyLength)
+    {
+      nvmCompressedBuffer[copyLength] = NVM_NO_WRITE_8BIT;
+    }
+  }
+
+  objectIndex = 0;
+  while ((*pPageDesc->page)[objectIndex].size != 0)
+  {
+    if (NVM_ObjectSelected(objectId, (*pPageDesc->page)[objectIndex].objectId)
+        && (NULL != (*pPageDesc->page)[objectIndex].location))
+    {
+      for (copyLength = 0; copyLength < (*pPageDesc->page)[objectIndex].size; ++copyLength)
+      {
+        nvmCompressedBuffer[offsetAddress + copyLength] = (*pPageDesc->page)[objectIndex].location[copyLength];
+      }
+    }
+
+    offsetAddress += (*pPageDesc->page)[objectIndex].size;
+    objectIndex++;
+  }
+
+  /* Encode the objects after the length. */
+  while (in < size)
+  {
+    for (run = 1;
+         ((in + run) < size) && (run < NVM_RLE_RUN_MAX) && (nvmCompressedBuffer[in + run] == nvmCompressedBuffer[in]);
+         ++run)
+    {
+    }
+
+    if (run >= NVM_RLE_RUN_MIN)
+    {
+      if ((out + 2U) > NVM_CONTENT_SIZE)
+      {
+        return nvmResultError;
+      }
+      nvmCompressedContent[out++] = (uint8_t)(NVM_RLE_RUN_FLAG | (run - NVM_RLE_RUN_MIN));
+      nvmCompressedContent[out++] = nvmCompressedBuffer[in];
+      in += run;
+    }
+    else
+    {
+      /* Store bytes as they are until the next run. */
+      for (literal = run; ((in + literal) < size) && (literal < NVM_RLE_LITERAL_MAX); ++literal)
+      {
+        if (((in + literal + 2U) < size)
+            && (nvmCompressedBuffer[in + literal] == nvmCompressedBuffer[in + literal + 1U])
+            && (nvmCompressedBuffer[in + literal] == nvmCompressedBuffer[in + literal + 2U]))
+        {
+          break;
+        }
+      }
+
+      if ((out + 1U + literal) > NVM_CONTENT_SIZE)
+      {
+        return nvmResultError;
+      }
+      nvmCompressedContent[out++] = (uint8_t)(literal - 1U);
+      for (copyLength = 0; copyLength < literal; ++copyLength)
+      {
+        nvmCompressedContent[out++] = nvmCompressedBuffer[in++];
+      }
+    }
+  }
+
+  /* The length is stored in the byte order read by NVM_CompressedDecode. */
+  length = out - NVM_COMPRESSED_LENGTH_SIZE;
+  nvmCompressedContent[0] = ((uint8_t *) &length)[0];
+  nvmCompressedContent[1] = ((uint8_t *) &length)[1];
+
+#if (NVM_FEATURE_WRITE_NECESSARY_CHECK_ENABLED == true)
+  /* The page is not rewritten if the encoded objects are the same. The
+   * static wear leveling system might want to rewrite it anyway. */
+  if (((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+      && !nvmStaticWearWorking
+#endif
+      )
+  {
+    for (copyLength = 0; copyLength < out; ++copyLength)
+    {
+      NVMHAL_Read(pOldPhysicalAddress + NVM_HEADER_SIZE + copyLength, &copyBuffer, sizeof(copyBuffer));
+      if (nvmCompressedContent[copyLength] != copyBuffer)
+      {
+        break;
+      }
+    }
+
+    if (copyLength == out)
+    {
+      NVM_STATS_INC(writesSkipped)
+      return nvmResultOk;
+    }
+  }
+#endif
+
+  nvmCompressedObjects[0].location = nvmCompressedContent;
+  nvmCompressedObjects[0].size     = out;
+  nvmCompressedObjects[0].objectId = 0;
+
+  nvmCompressedObjects[1].location = NULL;
+  nvmCompressedObjects[1].size     = 0;
+  nvmCompressedObjects[1].objectId = 0;
+
+  contentDesc.page = (NVM_Page_t const *) &nvmCompressedObjects;
+
+  return NVM_PageRelocate(pageId, &contentDesc, NVM_WRITE_ALL_CMD, pOldPhysicalAddress, NULL, NVM_VERSION);
+}
+#endif
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Check if a physical page holds a normal page stored like a wear page.
+ *
+ * @details
+ *   Only a normal page in the page table with a single object can be stored
+ *   like that. The version of any other page is not looked at.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor of the page in the page table.
+ *
+ * @return
+ *   Returns true if the header has got the version of a promoted page.
+ ******************************************************************************/
+static bool NVM_HotPromoted(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t const *pPageDesc)
+{
+  /* Page header, of which only the version is read. */
+  NVM_Page_Header_t header;
+
+  if ((NULL == pPageDesc->page)
+      || (nvmPageTypeNormal != pPageDesc->pageType)
+      || (0 == (*pPageDesc->page)[0].size)
+      || (0 != (*pPageDesc->page)[1].size))
+  {
+    return false;
+  }
+
+  NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+
+  return (NVM_HOT_VERSION == header.version);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Describe a page as it is stored in a physical page.
+ *
+ * @details
+ *   A normal page stored like a wear page is described as a wear page, so
+ *   that it is read and validated like one. Any other descriptor is left as
+ *   it is.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in,out] pPageDesc
+ *   The page descriptor for the page.
+ ******************************************************************************/
+static void NVM_HotLayoutGet(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc)
+{
+  if (NVM_HotPromoted(pPhysicalAddress, pPageDesc))
+  {
+    pPageDesc->pageType = nvmPageTypeWear;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Decide how to store a page that is written.
+ *
+ * @details
+ *   A page whose write count reaches NVM_HOT_PAGE_THRESHOLD gets a large
+ *   share of the writes, and is stored like a wear page until its count falls
+ *   below half of that.
+ *
+ *   Only normal pages with a single object, which has got a RAM location and
+ *   fits at least twice in a page, can be stored like a wear page.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] writes
+ *   Recent writes to the page, from NVM_WriteHistoryAdd.
+ *
+ * @param[in] promoted
+ *   Set if the page is stored like a wear page now.
+ *
+ * @return
+ *   Returns true if the page should be stored like a wear page.
+ ******************************************************************************/
+static bool NVM_HotPageCheck(NVM_Page_Descriptor_t const *pPageDesc, uint8_t writes, bool promoted)
+{
+  if ((NULL == (*pPageDesc->page)[0].location)
+      || ((*pPageDesc->page)[1].size != 0)
+      || ((2U * ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH)) > NVM_WEAR_CONTENT_SIZE))
+  {
+    return false;
+  }
+
+  if (promoted)
+  {
+    return (writes >= (NVM_HOT_PAGE_THRESHOLD / 2));
+  }
+
+  return (writes >= NVM_HOT_PAGE_THRESHOLD);
+}
+#endif
+
+#if (NVM_WRITE_HISTORY_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Count a write to a page.
+ *
+ * @details
+ *   Each page in the page table has got a count of its recent writes, and
+ *   all the counts are halved every NVM_HOT_PAGE_WINDOW writes.
+ *
+ * @param[in] pageId
+ *   Identifier of the page written.
+ *
+ * @return
+ *   Returns the count of the page, including this write. Pages that are not
+ *   in the page table are not counted, and 0 is returned.
+ ******************************************************************************/
+static uint8_t NVM_WriteHistoryAdd(uint16_t pageId)
+{
+  /* Index of the page in the page table. */
+  uint16_t pageIndex;
+  uint16_t i;
+
+  for (pageIndex = 0;
+       (pageIndex < nvmConfig->userPages) && ((*(nvmConfig->nvmPages))[pageIndex].pageId != pageId);
+       ++pageIndex)
+  {
+  }
+
+  if ((pageIndex >= nvmConfig->userPages) || (pageIndex >= NVM_MAX_NUMBER_OF_PAGES))
+  {
+    return 0;
+  }
+
+  if (nvmHotWrites[pageIndex] < NVM_NO_WRITE_8BIT)
+  {
+    nvmHotWrites[pageIndex]++;
+  }
+
+  /* Halve the counts at the end of the window. */
+  if (++nvmHotWindowWrites >= NVM_HOT_PAGE_WINDOW)
+  {
+    nvmHotWindowWrites = 0;
+    nvmHotWindowDone   = true;
+    for (i = 0; i < NVM_MAX_NUMBER_OF_PAGES; ++i)
+    {
+      nvmHotWrites[i] >>= 1;
+    }
+  }
+
+  return nvmHotWrites[pageIndex];
+}
+#endif
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Get the recent writes to a page.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns the count of the page. Pages that are not in the page table
+ *   return NVM_NO_WRITE_8BIT, as if they were written often.
+ ******************************************************************************/
+static uint8_t NVM_WriteHistoryGet(uint16_t pageId)
+{
+  /* Index of the page in the page table. */
+  uint16_t pageIndex;
+
+  for (pageIndex = 0; (pageIndex < nvmConfig->userPages) && (pageIndex < NVM_MAX_NUMBER_OF_PAGES); ++pageIndex)
+  {
+    if ((*(nvmConfig->nvmPages))[pageIndex].pageId == pageId)
+    {
+      return nvmHotWrites[pageIndex];
+    }
+  }
+
+  return NVM_NO_WRITE_8BIT;
+}
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Reset the governor.
+ *
+ * @details
+ *   The erase budget starts full.
+ ******************************************************************************/
+static void NVM_GovernorReset(void)
+{
+  nvmGovernorCredit   = 0;
+  nvmGovernorDeferred = 0;
+  nvmGovernorErases   = 0;
+
+  if (NULL != nvmConfig->wearPolicy)
+  {
+    nvmGovernorCredit = (int64_t) nvmConfig->wearPolicy->burst * nvmConfig->wearPolicy->lifetime;
+  }
+}
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Add up the erase counts in the page headers.
+ *
+ * @return
+ *   Returns the sum of the erase counts of the physical pages. It wraps, so
+ *   only the difference between two sums is of use.
+ ******************************************************************************/
+static uint32_t NVM_GovernorEraseTotal(void)
+{
+  uint16_t page;
+  /* Sum of the erase counts, and the erase count of a page. */
+  uint32_t total = 0;
+  uint32_t eraseCount;
+  /* Address of physical page. */
+  uint8_t  *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    NVMHAL_Read(pPhysicalAddress + 2, &eraseCount, sizeof(eraseCount));
+
+    /* A page erased without its count written back has got no count. */
+    if (NVM_HIGHEST_32BIT != eraseCount)
+    {
+      total += eraseCount;
+    }
+
+    /* Go to the next physical page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  return total;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Continue the governor from the budget stored in a checkpoint.
+ *
+ * @details
+ *   The erases counted in the page headers since the budget was stored are
+ *   taken from it, so a device that restarts in a loop cannot renew its
+ *   budget. The time since the budget was stored is not known, and is not
+ *   added to it.
+ *
+ * @param[in] credit
+ *   The erase budget stored in the checkpoint.
+ *
+ * @param[in] eraseTotal
+ *   The sum of the erase counts when the budget was stored.
+ ******************************************************************************/
+static void NVM_GovernorRestore(int64_t credit, uint32_t eraseTotal)
+{
+  /* Erases counted in the page headers since the budget was stored. */
+  int32_t erases;
+
+  if (NULL == nvmConfig->wearPolicy)
+  {
+    return;
+  }
+
+  /* A sum that went down, like after the pages were given new erase
+   * counts, counts as no erases. */
+  erases = (int32_t) (NVM_GovernorEraseTotal() - eraseTotal);
+  if (erases > 0)
+  {
+    credit -= (int64_t) erases * nvmConfig->wearPolicy->lifetime;
+  }
+
+  /* The policy may have got a smaller burst since. */
+  if (credit < nvmGovernorCredit)
+  {
+    nvmGovernorCredit = credit;
+  }
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Check if the erase budget is spent.
+ *
+ * @return
+ *   Returns true if writes to deferrable pages should be held back.
+ ******************************************************************************/
+static bool NVM_GovernorThrottled(void)
+{
+  if ((NULL == nvmConfig->wearPolicy) || (0 == nvmConfig->wearPolicy->lifetime))
+  {
+    return false;
+  }
+
+  return (nvmGovernorCredit < (int64_t) nvmConfig->wearPolicy->lifetime);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Take an erase from the erase budget.
+ *
+ * @details
+ *   Erases that cannot be held back, like those of pages that are not
+ *   deferrable, still take from the budget, which may then be overdrawn.
+ ******************************************************************************/
+static void NVM_GovernorErase(void)
+{
+  nvmGovernorErases++;
+
+  if (NULL != nvmConfig->wearPolicy)
+  {
+    nvmGovernorCredit -= (int64_t) nvmConfig->wearPolicy->lifetime;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check if a write to a page is held back by the governor.
+ *
+ * @details
+ *   Writes to normal and wear pages marked NVM_PAGE_DEFERRABLE are held back
+ *   while the erase budget is spent.
+ *
+ * @param[in] pPageDesc
+ *   The page descriptor for the page.
+ *
+ * @return
+ *   Returns true if the write should be held back.
+ ******************************************************************************/
+static bool NVM_GovernorDefers(NVM_Page_Descriptor_t const *pPageDesc)
+{
+  return (NULL != pPageDesc->page)
+         && ((pPageDesc->flags & NVM_PAGE_DEFERRABLE) != 0)
+         && ((nvmPageTypeNormal == pPageDesc->pageType) || (nvmPageTypeWear == pPageDesc->pageType))
+         && NVM_GovernorThrottled();
+}
+#endif
+
+#if (NVM_PENDING_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Write a page, or hold the write back.
+ *
+ * @details
+ *   A write held back by the governor or the write-behind cache leaves the
+ *   objects in RAM, and the page is written in full later. A page with writes
+ *   held back is also written in full by the next write that is not held
+ *   back. Moves by the static wear leveling system are never held back.
+ *
+ * @param[in] pageId
+ *   Identifier of the page to write.
+ *
+ * @param[in] objectId
+ *   Identifier of the object to write.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PendingCheck(uint16_t pageId, NVM_Object_Id_t objectId)
+{
+  /* Description of the page, used to find page type and flags. */
+  NVM_Page_Descriptor_t pageDesc = NVM_PageGet(pageId);
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  if (!nvmStaticWearWorking)
+#endif
+  {
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+    if (NVM_GovernorDefers(&pageDesc))
+    {
+      NVM_PendingSet(pageId, true);
+      nvmGovernorDeferred++;
+      return nvmResultOk;
+    }
+#endif
+
+#if (NVM_FEATURE_WRITE_BEHIND_ENABLED == true)
+    if ((NULL != pageDesc.page)
+        && ((pageDesc.flags & NVM_PAGE_WRITE_BEHIND) != 0)
+        && ((nvmPageTypeNormal == pageDesc.pageType) || (nvmPageTypeWear == pageDesc.pageType)))
+    {
+      NVM_PendingSet(pageId, true);
+      nvmWriteBehindIdle = 0;
+      NVM_STATS_INC(writesCoalesced)
+      return nvmResultOk;
+    }
+#endif
+  }
+
+  if (NVM_PendingGet(pageId))
+  {
+    return NVM_PendingWrite(pageId);
+  }
+
+  return NVM_PageWrite(pageId, objectId);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check if a page has got writes held back.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns true if the page has got writes held back.
+ ******************************************************************************/
+static bool NVM_PendingGet(uint16_t pageId)
+{
+  /* Index of the page in the page table. */
+  uint16_t pageIndex;
+
+  for (pageIndex = 0; (pageIndex < nvmConfig->userPages) && (pageIndex < NVM_MAX_NUMBER_OF_PAGES); ++pageIndex)
+  {
+    if ((*(nvmConfig->nvmPages))[pageIndex].pageId == pageId)
+    {
+      return ((nvmPendingPages[pageIndex / 8] & (1U << (pageIndex % 8))) != 0);
+    }
+  }
+
+  return false;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Mark if a page has got writes held back.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @param[in] pending
+ *   Set if the page has got writes held back.
+ ******************************************************************************/
+static void NVM_PendingSet(uint16_t pageId, bool pending)
+{
+  /* Index of the page in the page table. */
+  uint16_t pageIndex;
+
+  for (pageIndex = 0; (pageIndex < nvmConfig->userPages) && (pageIndex < NVM_MAX_NUMBER_OF_PAGES); ++pageIndex)
+  {
+    if ((*(nvmConfig->nvmPages))[pageIndex].pageId == pageId)
+    {
+      if (pending)
+      {
+        nvmPendingPages[pageIndex / 8] |= (uint8_t) (1U << (pageIndex % 8));
+      }
+      else
+      {
+        nvmPendingPages[pageIndex / 8] &= (uint8_t) ~(1U << (pageIndex % 8));
+      }
+      return;
+    }
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write a page with writes held back.
+ *
+ * @details
+ *   All the objects of the page are written from RAM. The page keeps its
+ *   writes held back if the write fails.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns the result of the write operation using a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_PendingWrite(uint16_t pageId)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  NVM_PendingSet(pageId, false);
+  result = NVM_PageWrite(pageId, NVM_WRITE_ALL_CMD);
+  if (nvmResultOk != result)
+  {
+    NVM_PendingSet(pageId, true);
+  }
+
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_EEPROM_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Build the content of the EEPROM page in RAM.
+ *
+ * @details
+ *   The records of all the segments are applied from the oldest to the
+ *   newest. Must be run after the segments have been found.
+ *
+ * @return
+ *   Returns nvmResultError if a page could not be erased.
+ ******************************************************************************/
+static NVM_Result_t NVM_EepromInit(void)
+{
+  uint16_t i;
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  /* Physical address of the current segment. */
+  uint8_t  *pSegment;
+  /* Index of the current segment, and offset of the record in it. */
+  uint8_t  segment;
+  uint16_t offset;
+  /* Length of the record, and the address of its first byte. */
+  uint16_t len;
+  uint16_t address;
+
+  for (i = 0; i < NVM_EEPROM_SIZE; ++i)
+  {
+    nvmEeprom[i] = NVM_EEPROM_ERASED;
+  }
+
+  nvmEepromLog = NULL;
+
+  for (i = 0; i < NVM_LOG_MAX_PAGES; ++i)
+  {
+    if ((NVM_PAGE_EMPTY_VALUE != nvmLogs[i].pageId) && (nvmPageTypeEeprom == nvmLogs[i].pageType))
+    {
+      nvmEepromLog = &nvmLogs[i];
+    }
+  }
+
+  if (NULL == nvmEepromLog)
+  {
+    return nvmResultOk;
+  }
+
+  /* The extra segment only holds a copy of the content in the others, so
+   * an interrupted compaction is started over. */
+  if (nvmEepromLog->count > nvmEepromLog->segments)
+  {
+    if (nvmResultOk != NVM_PageErase((uint8_t *)(nvmConfig->nvmArea) + nvmEepromLog->page[nvmEepromLog->count - 1] * NVM_PAGE_SIZE))
+    {
+      result = nvmResultError;
+    }
+    nvmEepromLog->count--;
+    nvmEepromLog->tailOffset = NVM_PAGE_SIZE;
+  }
+
+  for (segment = 0; segment < nvmEepromLog->count; ++segment)
+  {
+    pSegment = (uint8_t *)(nvmConfig->nvmArea) + nvmEepromLog->page[segment] * NVM_PAGE_SIZE;
+
+    for (offset = NVM_LOG_RECORDS_START;
+         nvmLogRecordValid == NVM_LogRecordCheck(pSegment, offset, &len);
+         offset += NVM_LOG_RECORD_SIZE(len))
+    {
+      if (len < NVM_EEPROM_ADDRESS_SIZE)
+      {
+        continue;
+      }
+
+      NVMHAL_Read(pSegment + offset + NVM_LOG_RECORD_HEADER_SIZE, &address, sizeof(address));
+      len -= NVM_EEPROM_ADDRESS_SIZE;
+
+      if ((address <= NVM_EEPROM_SIZE) && (len <= (NVM_EEPROM_SIZE - address)))
+      {
+        NVMHAL_Read(pSegment + offset + NVM_LOG_RECORD_HEADER_SIZE + NVM_EEPROM_ADDRESS_SIZE, &nvmEeprom[address], len);
+      }
+
+      len += NVM_EEPROM_ADDRESS_SIZE;
+    }
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Compact the EEPROM page into a new segment.
+ *
+ * @details
+ *   The whole content is written to a new segment, and the older segments
+ *   are erased. Since the records of the new segment hold the same bytes as
+ *   the older segments give together, the content is the same wherever a
+ *   power loss interrupts this.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_EepromCompact(void)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+
+  /* Address and length of the current chunk. */
+  uint16_t address;
+  uint16_t len;
+  uint16_t i;
+
+  result = NVM_LogSegmentOpen(nvmEepromLog);
+
+  /* Chunks that are still erased are left out. */
+  for (address = 0; (nvmResultOk == result) && (address < NVM_EEPROM_SIZE); address += NVM_EEPROM_CHUNK_SIZE)
+  {
+    len = NVM_EEPROM_SIZE - address;
+    if (len > NVM_EEPROM_CHUNK_SIZE)
+    {
+      len = NVM_EEPROM_CHUNK_SIZE;
+    }
+
+    for (i = 0; (i < len) && (NVM_EEPROM_ERASED == nvmEeprom[address + i]); ++i)
+    {
+    }
+
+    if (i < len)
+    {
+      result = NVM_LogRecordWrite(nvmEepromLog, (uint8_t const *) &address, NVM_EEPROM_ADDRESS_SIZE, &nvmEeprom[address], len);
+    }
+  }
+
+  /* The oldest segment is erased first, so that the newer ones still
+   * override it if this is interrupted. */
+  while ((nvmResultOk == result) && (nvmEepromLog->count > 1))
+  {
+    result = NVM_LogSegmentDrop(nvmEepromLog);
+  }
+
+  if (nvmResultOk == result)
+  {
+    NVM_STATS_INC(eepromCompactions)
+  }
+
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_TRANSACTIONS_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Finish or undo a transaction.
+ *
+ * @details
+ *   This function finds the pages staged by a transaction. If the page that
+ *   commits the transaction is there and validates, the old version of each
+ *   staged page is erased, and the staged page replaces it. The page that
+ *   commits the transaction is replaced last, so that this can be repeated if
+ *   it is interrupted. Otherwise all the staged pages are erased.
+ *
+ * @param[out] pCommitted
+ *   Set if the staged pages replaced the old versions.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_TxResolve(bool *pCommitted)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultOk;
+
+  uint16_t page;
+  uint16_t old;
+
+  /* Physical address of the current page, and of an old version of it. */
+  uint8_t  *pPhysicalAddress;
+  uint8_t  *pOldPhysicalAddress;
+  /* Staged page that commits the transaction. */
+  uint8_t  *pCommitPage = (uint8_t *) NVM_NO_PAGE_RETURNED;
+
+  /* Header of the current page, and the watermark of an old version. */
+  NVM_Page_Header_t header;
+  uint16_t          oldWatermark;
+
+  /* Set if any page is staged. */
+  bool staged = false;
+
+  *pCommitted = false;
+
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea) + page * NVM_PAGE_SIZE;
+    NVMHAL_Read(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+    NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+
+    if ((NVM_PAGE_EMPTY_VALUE != header.watermark)
+        && (NVM_VERSION == (header.version & NVM_TX_VERSION_MASK))
+        && (0 != (header.version & NVM_TX_VERSION_STAGED)))
+    {
+      staged = true;
+      if (0 == (header.version & NVM_TX_VERSION_OPEN))
+      {
+        pCommitPage = pPhysicalAddress;
+      }
+    }
+  }
+
+  if (!staged)
+  {
+    return nvmResultOk;
+  }
+
+  /* The transaction is only committed if the last page was completed. */
+  *pCommitted = ((uint8_t *) NVM_NO_PAGE_RETURNED != pCommitPage)
+                && (nvmValidateResultOk == NVM_PageValidate(pCommitPage));
+
+  for (page = 0; page <= nvmConfig->pages; ++page)
+  {
+    if (page == nvmConfig->pages)
+    {
+      /* The page that commits the transaction is handled last. */
+      if ((uint8_t *) NVM_NO_PAGE_RETURNED == pCommitPage)
+      {
+        break;
+      }
+      pPhysicalAddress = pCommitPage;
+    }
+    else
+    {
+      pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea) + page * NVM_PAGE_SIZE;
+      if (pPhysicalAddress == pCommitPage)
+      {
+        continue;
+      }
+    }
+
+    NVMHAL_Read(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+    NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+
+    if ((NVM_PAGE_EMPTY_VALUE == header.watermark)
+        || (NVM_VERSION != (header.version & NVM_TX_VERSION_MASK))
+        || (0 == (header.version & NVM_TX_VERSION_STAGED)))
+    {
+      continue;
+    }
+
+    if (!*pCommitted)
+    {
+      if (nvmResultOk != NVM_PageErase(pPhysicalAddress))
+      {
+        result = nvmResultError;
+      }
+      continue;
+    }
+
+    /* Erase the old version before the staged page replaces it. */
+    for (old = 0; old < nvmConfig->pages; ++old)
+    {
+      pOldPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea) + old * NVM_PAGE_SIZE;
+      NVMHAL_Read(pOldPhysicalAddress, &oldWatermark, sizeof(oldWatermark));
+
+      if ((pOldPhysicalAddress != pPhysicalAddress)
+          && ((oldWatermark | NVM_FIRST_BIT_ONE) == header.watermark))
+      {
+        if (nvmResultOk != NVM_PageErase(pOldPhysicalAddress))
+        {
+          result = nvmResultError;
+        }
+      }
+    }
+
+    header.version = NVM_VERSION;
+    if (nvmResultOk != NVMHAL_Write(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version)))
+    {
+      result = nvmResultError;
+    }
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+    NVM_CheckpointRecord(nvmCheckpointRecordDone, header.watermark & NVM_FIRST_BIT_ZERO, pPhysicalAddress);
+#endif
+  }
+
+  return result;
+}
+#endif
+
+#if (NVM_FEATURE_LAZY_VALIDATION_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Validate a page on its first use.
+ *
+ * @details
+ *   When lazy validation is enabled NVM_Init only checks the page headers and
+ *   footers, and registers each page found as pending. This function runs the
+ *   full validation of a pending page the first time it is used, and then
+ *   removes it from the pending list.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the page you want to use.
+ *
+ * @return
+ *   Returns the validation status of the page as a NVM_ValidateResult_t.
+ *   Pages that are not pending are reported as nvmValidateResultOk.
+ ******************************************************************************/
+static NVM_ValidateResult_t NVM_PageValidateDeferred(uint8_t *pPhysicalAddress)
+{
+  /* Index of the physical page. */
+  uint16_t page = (uint16_t)((pPhysicalAddress - (uint8_t *)(nvmConfig->nvmArea)) / NVM_PAGE_SIZE);
+
+  if ((nvmValidationPending[page / NVM_PAGES_PER_VALIDATION_BYTE] & (1U << (page % NVM_PAGES_PER_VALIDATION_BYTE))) == 0)
+  {
+    return nvmValidateResultOk;
+  }
+
+  return NVM_PageValidate(pPhysicalAddress);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Register or unregister a page as pending validation.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the start of the page.
+ *
+ * @param[in] pending
+ *   True if the page must be validated before it is used.
+ ******************************************************************************/
+static void NVM_ValidationPendingSet(uint8_t *pPhysicalAddress, bool pending)
+{
+  /* Index of the physical page. */
+  uint16_t page = (uint16_t)((pPhysicalAddress - (uint8_t *)(nvmConfig->nvmArea)) / NVM_PAGE_SIZE);
+  /* Bitmask to change the desired bit. */
+  uint8_t  mask = 1U << (page % NVM_PAGES_PER_VALIDATION_BYTE);
+
+  if (pending)
+  {
+    nvmValidationPending[page / NVM_PAGES_PER_VALIDATION_BYTE] |= mask;
+  }
+  else
+  {
+    nvmValidationPending[page / NVM_PAGES_PER_VALIDATION_BYTE] &= ~mask;
+  }
+}
+#endif
+
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Find used wear slots.
+ *
+ * @details
+ *   This function returns the index of the first unused space in a wear page,
+ *   might be outside of the page. The index is based on using the size of the
+ *   object and checksum as the step size when traversing the memory.
+ *
+ * @param[in] *pPhysicalAddress
+ *   Pointer to the start of the page you want to check.
+ *
+ * @param[in] pageDesc
+ *   The page descriptor for the page.
+ *
+ * @return
+ *   Returns the index as a uint16_t.
+ ******************************************************************************/
+static uint16_t NVM_WearIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc)
+{
+  /* Index to return. */
+  uint16_t wearIndex = 0;
+
+  /* Temporary variable used when calculating and comparing checksums. */
+  uint16_t checksum;
+
+  /* Size of the object in the wear page, including a 16 bit checksum. */
+  uint16_t wearObjectSize = ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH);
+
+  /* Byte of the object, and the number of bytes checked. */
+  uint8_t  objectByte = NVM_NO_WRITE_8BIT;
+  uint16_t i;
+
+  /* Loop over possible pages. Stop when empty page was found. */
+  while (wearIndex < NVM_WEAR_CONTENT_SIZE / wearObjectSize)
+  {
+    NVMHAL_Read((uint8_t *)(pPhysicalAddress + NVM_HEADER_SIZE +
+                            wearIndex * wearObjectSize +
+                            (*pPageDesc->page)[0].size
+                            ),
+                &checksum,
+                sizeof(checksum));
+
+    /* Flip the last bit of the checksum to zero. This is a mark used to
+     * determine that an object is written to this location. */
+    if ((checksum & NVM_LAST_BIT_ZERO) != checksum)
+    {
+      /* A write interrupted before the checksum was written leaves part of
+       * the object programmed, and the location cannot be used again. */
+      for (i = 0; (i < (*pPageDesc->page)[0].size) && (NVM_NO_WRITE_8BIT == objectByte); ++i)
+      {
+        NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE + wearIndex * wearObjectSize + i, &objectByte, sizeof(objectByte));
+      }
+
+      if (NVM_NO_WRITE_8BIT == objectByte)
+      {
+        /* Break the loop and accept this location. */
+        break;
+      }
+      objectByte = NVM_NO_WRITE_8BIT;
+    }
+
+    /* Not a valid position for a new write.
+    * Increase the index and check again. */
+    wearIndex++;
+  }
+
+  return wearIndex;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Find newest wear index in a page.
+ *
+ * @details
+ *   This function finds the index of the newest valid instance of the wear
+ *   object in a given page and assigns it to the given index variable. The
+ *   function returns false if there are no valid instances.
+ *
+ * @param[in] *pPhysicalAddress
+ *   Pointer to the start of the page you want to check.
+ *
+ * @param[in] *pageDesc
+ *   The page descriptor for the page.
+ *
+ * @param[in] *index
+ *   Pointer to where to store the index found.
+ *
+ * @return
+ *   Returns the result of the operation as a boolean.
+ ******************************************************************************/
+#if (NVM_FEATURE_WEAR_PAGES_ENABLED == true)
+static bool NVM_WearReadIndex(uint8_t *pPhysicalAddress, NVM_Page_Descriptor_t *pPageDesc, uint16_t *pIndex)
+{
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+  /* Variable used for calculating checksum when validating. */
+  uint16_t checksum = NVM_CHECKSUM_INITIAL;
+#endif
+
+  /* Length of wear object plus checksum. */
+  const uint16_t wearObjectSize = ((*pPageDesc->page)[0].size + NVM_CHECKSUM_LENGTH);
+
+  /* Return value. */
+  bool validObjectFound = false;
+
+  /* Buffer used when reading checksum. */
+  uint16_t readBuffer;
+
+  /* Initialize index at max plus one object. */
+  *pIndex = (((uint16_t) NVM_WEAR_CONTENT_SIZE) / wearObjectSize);
+
+  /* Loop over possible pages. Stop when first OK page is found. */
+  while ((*pIndex > 0) && (!validObjectFound))
+  {
+    (*pIndex)--;
+
+    /* Initialize checksum, and then calculate it from the HAL.*/
+    uint8_t *temp = pPhysicalAddress + NVM_HEADER_SIZE + (*pIndex) * wearObjectSize + (*pPageDesc->page)[0].size;
+    NVMHAL_Read((uint8_t *) temp, &readBuffer, sizeof(readBuffer));
+
+#if (NVM_FEATURE_READ_VALIDATION_ENABLED == true)
+    /* Calculate the checksum before accepting the object. */
+    checksum = NVM_CHECKSUM_INITIAL;
+    NVMHAL_Checksum(&checksum, pPhysicalAddress + NVM_HEADER_SIZE + (*pIndex) * wearObjectSize, (*pPageDesc->page)[0].size);
+    /* Flips the last bit of the checksum to zero. This is a mark used to
+     * determine whether we have written anything to the page. */
+    if ((uint16_t)(checksum & NVM_LAST_BIT_ZERO) == readBuffer)
+#else
+    if (NVM_NO_WRITE_16BIT != readBuffer)
+#endif
+    {
+      validObjectFound = true;
+    }
+  }
+
+  return validObjectFound;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Calculate checksum according to CCITT CRC16.
+ *
+ * @details
+ *   This function calculates a checksum of the supplied buffer.
+ *   The checksum is calculated using CCITT CRC16 plynomial x^16+x^12+x^5+1.
+ *
+ * @param[in] pChecksum
+ *   Pointer to where the checksum should be calculated and stored. This buffer
+ *   should be initialized. A good consistent starting point would be
+ *   NVM_CHECKSUM_INITIAL.
+ *
+ * @param[in] pBuffer
+ *   Pointer to the data you want to calculate a checksum for.
+ *
+ * @param[in] len
+ *   The length of the data.
+ ******************************************************************************/
+static void NVM_ChecksumAdditive(uint16_t *pChecksum, void *pBuffer, uint16_t len)
+{
+  uint8_t *pointer = (uint8_t *) pBuffer;
+  uint16_t crc = *pChecksum;
+
+  while(len--)
+  {
+    crc = (crc >> 8) | (crc << 8);
+    crc ^= *pointer++;
+    crc ^= (crc & 0xf0) >> 4;
+    crc ^= (crc & 0x0f) << 12;
+    crc ^= (crc & 0xff) << 5;
+  }
+
+  *pChecksum = crc;
+}
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Resets the static wear leveling system.
+ *
+ * @details
+ *   This function resets the history of the static wear leveling system. This
+ *   is done at startup and whenever all the pages have been updated at least
+ *   once and the threshold for rewrites have been reached.
+ ******************************************************************************/
+static void NVM_StaticWearReset(void)
+{
+  uint16_t i;
+  nvmStaticWearErasesSinceReset = 0;
+  nvmStaticWearWritesInHistory  = 0;
+
+  for (i = 0; (NVM_PAGES_PER_WEAR_HISTORY * i) < nvmConfig->userPages; i += 1)
+  {
+    nvmStaticWearWriteHistory[i] = 0;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Mark a page as updated.
+ *
+ * @details
+ *   This function marks the given page as updated, and updates the update
+ *   count. It then executes the StaticWearCheck function.
+ *
+ * @param[in] address
+ *   Logical address of the page that was updated.
+ ******************************************************************************/
+static void NVM_StaticWearUpdate(uint16_t address)
+{
+  if (address < nvmConfig->userPages)
+  {
+    /* Mark page with logical address as written. */
+
+    /* Bitmask to check and change the desired bit. */
+    uint8_t mask = 1U << (address % NVM_PAGES_PER_WEAR_HISTORY);
+
+    if ((nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] & mask) == 0)
+    {
+      /* Flip bit. */
+      nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] |= mask;
+      /* Record flip. */
+      nvmStaticWearWritesInHistory++;
+    }
+
+    /* Record erase operation. */
+    nvmStaticWearErasesSinceReset++;
+
+    /* Call the static wear leveler. */
+    NVM_StaticWearCheck();
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Run the static wear leveling check.
+ *
+ * @details
+ *   The static wear leveling check is executed in this function. It uses the
+ *   give threshold value to decide whether it is time to walk through the pages
+ *   and move non-updated ones.
+ *
+ *   The threshold, the number of pages moved in one check and the spread of
+ *   the erase counts needed to move any are taken from the wearPolicy of the
+ *   configuration when there is one.
+ ******************************************************************************/
+static NVM_Result_t NVM_StaticWearCheck(void)
+{
+  /* Threshold, budget and spread of the policy. */
+  uint16_t threshold = NVM_STATIC_WEAR_THRESHOLD;
+  uint16_t budget    = 0;
+  uint32_t spread    = 0;
+  /* Pages moved in this check. */
+  uint16_t moves     = 0;
+
+  if (NULL != nvmConfig->wearPolicy)
+  {
+    threshold = nvmConfig->wearPolicy->staticWearThreshold;
+    budget    = nvmConfig->wearPolicy->relocationBudget;
+    spread    = nvmConfig->wearPolicy->minimumSpread;
+  }
+
+  if (0 == threshold)
+  {
+    return nvmResultOk;
+  }
+
+  /* Check if there is a check already running. We do not need more of these. */
+  if (!nvmStaticWearWorking)
+  {
+    nvmStaticWearWorking = true;
+    while (nvmStaticWearErasesSinceReset / nvmStaticWearWritesInHistory > threshold)
+    {
+      /* If all the pages have been moved in this cycle: reset. */
+      if (nvmStaticWearWritesInHistory >= nvmConfig->userPages)
+      {
+        NVM_StaticWearReset();
+        break;
+      }
+
+      /* Leave the rest to the next operations when the budget is spent. */
+      if ((0 != budget) && (moves >= budget))
+      {
+        break;
+      }
+
+      /* Start a new cycle if the pages are still worn evenly. */
+      if ((0 != spread) && (0 == moves) && (NVM_StaticWearSpread() < spread))
+      {
+        NVM_StaticWearReset();
+        break;
+      }
+
+      /* Find an address for a page that has not been rewritten. */
+      uint16_t address = 0;
+      uint8_t  mask    = 1U << (address % NVM_PAGES_PER_WEAR_HISTORY);
+      while ((nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] & mask) != 0)
+      {
+        address++;
+        mask = 1U << (address % NVM_PAGES_PER_WEAR_HISTORY);
+      }
+
+      /* Check for wear page. Pages stored in log segments are never moved either. */
+      if ((nvmPageTypeWear == NVM_PageGet(address).pageType)
+#if (NVM_FEATURE_LOG_PAGES_ENABLED == true)
+          || NVM_PAGE_TYPE_SEGMENTED(NVM_PageGet(address).pageType)
+#endif
+#if (NVM_FEATURE_PACKED_PAGES_ENABLED == true)
+          || (nvmPageTypePacked == NVM_PageGet(address).pageType)
+#endif
+#if (NVM_FEATURE_SPAN_PAGES_ENABLED == true)
+          || (nvmPageTypeSpan == NVM_PageGet(address).pageType)
+#endif
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+          || NVM_StaticWearParked(address)
+#endif
+          )
+      {
+        /* Flip bit. */
+        nvmStaticWearWriteHistory[address / NVM_PAGES_PER_WEAR_HISTORY] |= mask;
+        /* Record flip. */
+        nvmStaticWearWritesInHistory++;
+      }
+      else
+      {
+        /* Must release write lock, run the write function to move the data,
+         * then acquire lock again. */
+
+        /* Give up write lock and open for other API operations. */
+        NVM_RELEASE_WRITE_LOCK
+
+        if (nvmResultOk == NVM_Write(address, NVM_WRITE_NONE_CMD))
+        {
+          NVM_STATS_INC(staticWearMoves)
+        }
+        moves++;
+
+        /* Require write lock to continue. */
+        NVM_ACQUIRE_WRITE_LOCK
+      }
+    }
+    nvmStaticWearWorking = false;
+  }
+
+  return nvmResultOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the spread of the erase counts.
+ *
+ * @return
+ *   Returns the difference between the highest and the lowest erase count of
+ *   the physical pages as a uint32_t.
+ ******************************************************************************/
+static uint32_t NVM_StaticWearSpread(void)
+{
+  uint16_t page;
+  /* Used to temporarily store the update id of the current page. */
+  uint32_t updateId;
+  /* Lowest and highest update id. */
+  uint32_t lowUpdateId  = NVM_HIGHEST_32BIT;
+  uint32_t highUpdateId = 0;
+
+  /* Address of physical page. */
+  uint8_t *pPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea);
+
+  /* Loop through all pages in memory. */
+  for (page = 0; page < nvmConfig->pages; ++page)
+  {
+    /* Find and compare erasure count. */
+    NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+    if (updateId < lowUpdateId)
+    {
+      lowUpdateId = updateId;
+    }
+    if (updateId > highUpdateId)
+    {
+      highUpdateId = updateId;
+    }
+
+    /* Go to the next physical page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  return highUpdateId - lowUpdateId;
+}
+
+#if (NVM_FEATURE_HOT_COLD_ALLOCATION_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Check if a page is already parked on a worn physical page.
+ *
+ * @details
+ *   A page moved by the static wear leveling system goes to the most worn
+ *   empty page. There is nothing to gain from moving a page that is already
+ *   on a page at least as worn as that one.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns true if the page does not need to be moved.
+ ******************************************************************************/
+static bool NVM_StaticWearParked(uint16_t pageId)
+{
+  /* Physical address of the page and of the most worn empty page. */
+  uint8_t  *pPhysicalAddress = NVM_PageFind(pageId);
+  uint8_t  *pWornAddress;
+  /* Erasure counts of the two pages. */
+  uint32_t updateId;
+  uint32_t wornUpdateId;
+
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED == pPhysicalAddress)
+  {
+    return false;
+  }
+
+  pWornAddress = NVM_ScratchPageFindWorn();
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED == pWornAddress)
+  {
+    return false;
+  }
+
+  NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+  NVMHAL_Read(pWornAddress + 2, &wornUpdateId, sizeof(wornUpdateId));
+
+  return (updateId >= wornUpdateId);
+}
+#endif
+
+#endif
+
+#if (NVM_FEATURE_CHECKPOINT_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Get the index of a page in the page table.
+ *
+ * @param[in] pageId
+ *   Identifier of the page.
+ *
+ * @return
+ *   Returns the index as a uint16_t. If the page is not in the page table
+ *   NVM_CHECKPOINT_NO_PAGE is returned.
+ ******************************************************************************/
+static uint16_t NVM_PageIndexGet(uint16_t pageId)
+{
+  uint16_t pageIndex;
+
+  /* Step through all configured pages. */
+  for (pageIndex = 0; pageIndex < nvmConfig->userPages; ++pageIndex)
+  {
+    if ((*(nvmConfig->nvmPages))[pageIndex].pageId == pageId)
+    {
+      return pageIndex;
+    }
+  }
+
+  return NVM_CHECKPOINT_NO_PAGE;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Clear the page map.
+ *
+ * @details
+ *   This function removes all pages and page writes in progress from the page
+ *   map kept in RAM.
+ ******************************************************************************/
+static void NVM_CheckpointMapClear(void)
+{
+  uint16_t i;
+
+  for (i = 0; i < NVM_MAX_NUMBER_OF_PAGES; ++i)
+  {
+    nvmCheckpoint.map[i] = NVM_CHECKPOINT_NO_PAGE;
+  }
+
+  for (i = 0; i < NVM_CHECKPOINT_INFLIGHT_MAX; ++i)
+  {
+    nvmCheckpoint.inflight[i].pageIndex = NVM_CHECKPOINT_NO_PAGE;
+    nvmCheckpoint.inflight[i].page      = NVM_CHECKPOINT_NO_PAGE;
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Apply a checkpoint record to the page map.
+ *
+ * @details
+ *   A start record registers a page write in progress. A done record moves
+ *   the page in the page map to the physical page given, and ends the write
+ *   in progress.
+ *
+ * @param[in] pRecord
+ *   Pointer to the record.
+ *
+ * @return
+ *   Returns false if there is no room for another page write in progress.
+ ******************************************************************************/
+static bool NVM_CheckpointApply(NVM_Checkpoint_Record_t const *pRecord)
+{
+  uint16_t i;
+  /* Slot used by the page, or a free one. */
+  uint16_t slot = NVM_CHECKPOINT_NO_PAGE;
+
+  for (i = 0; i < NVM_CHECKPOINT_INFLIGHT_MAX; ++i)
+  {
+    if (pRecord->pageIndex == nvmCheckpoint.inflight[i].pageIndex)
+    {
+      slot = i;
+      break;
+    }
+    if ((NVM_CHECKPOINT_NO_PAGE == slot) && (NVM_CHECKPOINT_NO_PAGE == nvmCheckpoint.inflight[i].pageIndex))
+    {
+      slot = i;
+    }
+  }
+
+  if (nvmCheckpointRecordStart == pRecord->type)
+  {
+    if (NVM_CHECKPOINT_NO_PAGE == slot)
+    {
+      return false;
+    }
+    nvmCheckpoint.inflight[slot].pageIndex = pRecord->pageIndex;
+    nvmCheckpoint.inflight[slot].page      = pRecord->page;
+  }
+  else
+  {
+    nvmCheckpoint.map[pRecord->pageIndex] = pRecord->page;
+    if ((NVM_CHECKPOINT_NO_PAGE != slot) && (pRecord->pageIndex == nvmCheckpoint.inflight[slot].pageIndex))
+    {
+      nvmCheckpoint.inflight[slot].pageIndex = NVM_CHECKPOINT_NO_PAGE;
+      nvmCheckpoint.inflight[slot].page      = NVM_CHECKPOINT_NO_PAGE;
+    }
+  }
+
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Load the newest checkpoint.
+ *
+ * @details
+ *   This function finds the newest committed checkpoint, loads it into RAM and
+ *   applies the records appended after it. A record torn by a power loss ends
+ *   the list, and makes the next record start a new checkpoint.
+ *
+ * @return
+ *   Returns true if a checkpoint matching the configuration was loaded.
+ ******************************************************************************/
+static bool NVM_CheckpointLoad(void)
+{
+  uint16_t i;
+  /* Address of the checkpoint page checked, and of the newest one found. */
+  uint8_t  *pPhysicalAddress;
+  uint8_t  *pNewestAddress = 0;
+  /* Sequence number of the checkpoint checked, and of the newest one found. */
+  uint32_t sequence;
+  uint32_t newestSequence = 0;
+
+  /* Page header and the commit word after the checkpoint. */
+  NVM_Page_Header_t header;
+  uint32_t          commit;
+  /* Variable used for calculating checksums. */
+  uint16_t          checksum;
+
+  /* Record read from the checkpoint page, and its offset. */
+  NVM_Checkpoint_Record_t record;
+  uint16_t                offsetAddress;
+
+  /* Find the newest committed checkpoint. */
+  pPhysicalAddress = (uint8_t *)(nvmConfig->checkpointArea);
+  for (i = 0; i < NVM_CHECKPOINT_PAGES; ++i)
+  {
+    NVMHAL_Read(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+    NVMHAL_Read(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+
+    if ((NVM_CHECKPOINT_WATERMARK == header.watermark) && (NVM_VERSION == header.version))
+    {
+      checksum = NVM_CHECKSUM_INITIAL;
+      NVMHAL_Checksum(&checksum, pPhysicalAddress + NVM_HEADER_SIZE, sizeof(NVM_Checkpoint_t));
+      NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE + sizeof(NVM_Checkpoint_t), &commit, sizeof(commit));
+      NVMHAL_Read(pPhysicalAddress + NVM_HEADER_SIZE, &sequence, sizeof(sequence));
+
+      if ((NVM_CHECKPOINT_COMMIT(checksum) == commit)
+          && ((0 == pNewestAddress) || ((int32_t)(sequence - newestSequence) > 0)))
+      {
+        pNewestAddress = pPhysicalAddress;
+        newestSequence = sequence;
+      }
+    }
+
+    /* Go to the next checkpoint page. */
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+
+  if (0 == pNewestAddress)
+  {
+    return false;
+  }
+
+  /* The checkpoint can only be used with the configuration it was made for. */
+  NVMHAL_Read(pNewestAddress + NVM_HEADER_SIZE, &nvmCheckpoint, sizeof(nvmCheckpoint));
+  if ((nvmConfig->pages != nvmCheckpoint.pages) || (nvmConfig->userPages != nvmCheckpoint.userPages))
+  {
+    return false;
+  }
+
+  for (i = 0; i < nvmConfig->userPages; ++i)
+  {
+    if ((NVM_CHECKPOINT_NO_PAGE != nvmCheckpoint.map[i]) && (nvmCheckpoint.map[i] >= nvmConfig->pages))
+    {
+      return false;
+    }
+  }
+
+  /* Apply the records written after the checkpoint. */
+  for (offsetAddress = NVM_CHECKPOINT_RECORDS_OFFSET;
+       (offsetAddress + sizeof(record)) <= NVM_PAGE_SIZE;
+       offsetAddress += sizeof(record))
+  {
+    NVMHAL_Read(pNewestAddress + offsetAddress, &record, sizeof(record));
+
+    /* Stop at the first unused record. */
+    if ((NVM_NO_WRITE_16BIT == record.type) && (NVM_NO_WRITE_16BIT == record.pageIndex)
+        && (NVM_NO_WRITE_16BIT == record.page) && (NVM_NO_WRITE_16BIT == record.check))
+    {
+      break;
+    }
+
+    if ((NVM_CHECKPOINT_RECORD_CHECK(record) != record.check)
+        || ((nvmCheckpointRecordStart != record.type) && (nvmCheckpointRecordDone != record.type))
+        || (record.pageIndex >= nvmConfig->userPages)
+        || ((NVM_CHECKPOINT_NO_PAGE != record.page) && (record.page >= nvmConfig->pages)))
+    {
+      /* Torn record. Nothing was done after it, but nothing must be appended
+       * after it either. */
+      offsetAddress = NVM_PAGE_SIZE;
+      break;
+    }
+
+    if (!NVM_CheckpointApply(&record))
+    {
+      return false;
+    }
+  }
+
+  nvmCheckpointPage   = pNewestAddress;
+  nvmCheckpointOffset = offsetAddress;
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  /* Continue the static wear leveling from where it was. */
+  for (i = 0; i < sizeof(nvmStaticWearWriteHistory); ++i)
+  {
+    nvmStaticWearWriteHistory[i] = nvmCheckpoint.staticWearWriteHistory[i];
+  }
+  nvmStaticWearWritesInHistory  = nvmCheckpoint.staticWearWritesInHistory;
+  nvmStaticWearErasesSinceReset = nvmCheckpoint.staticWearErasesSinceReset;
+#endif
+
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  /* Continue the erase budget from where it was. */
+  NVM_GovernorRestore(nvmCheckpoint.governorCredit, nvmCheckpoint.governorEraseTotal);
+#endif
+
+  return true;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Resolve the page writes in progress of a loaded checkpoint.
+ *
+ * @details
+ *   For every page write in progress the new page is kept if it validates,
+ *   and the old one is erased. Otherwise the new page is erased, and the old
+ *   one stays in the page map. A new checkpoint is written if anything was
+ *   resolved. All the pages in the page map are then registered as pending
+ *   validation.
+ *
+ * @return
+ *   Returns the result of the initialization as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_CheckpointResolve(void)
+{
+  uint16_t i;
+  /* Result used as return value from the function. */
+  NVM_Result_t result = nvmResultNoPages;
+  /* True if a page write was resolved. */
+  bool resolved = false;
+
+  /* Physical addresses of the old and new version of a page. */
+  uint8_t  *pOldPhysicalAddress;
+  uint8_t  *pNewPhysicalAddress;
+  /* Watermark used to check if a page is empty. */
+  uint16_t watermark;
+
+  /* Result of validation of the new page. */
+  NVM_ValidateResult_t validationResult;
+  /* Temporary variable to store results of a erase operation. */
+  NVM_Result_t         eraseResult = nvmResultOk;
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  /* Do not move any pages until the page map is complete. */
+  nvmStaticWearWorking = true;
+#endif
+
+  for (i = 0; i < NVM_CHECKPOINT_INFLIGHT_MAX; ++i)
+  {
+    if (NVM_CHECKPOINT_NO_PAGE == nvmCheckpoint.inflight[i].pageIndex)
+    {
+      continue;
+    }
+
+    resolved = true;
+
+    if (NVM_CHECKPOINT_NO_PAGE != nvmCheckpoint.inflight[i].page)
+    {
+      pNewPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea) + nvmCheckpoint.inflight[i].page * NVM_PAGE_SIZE;
+      NVMHAL_Read(pNewPhysicalAddress, &watermark, sizeof(watermark));
+
+      /* Nothing to do if the write never reached the new page. */
+      if (NVM_PAGE_EMPTY_VALUE != watermark)
+      {
+        /* Find out if the old page is still there. */
+        pOldPhysicalAddress = (uint8_t *) NVM_NO_PAGE_RETURNED;
+        if (NVM_CHECKPOINT_NO_PAGE != nvmCheckpoint.map[nvmCheckpoint.inflight[i].pageIndex])
+        {
+          pOldPhysicalAddress = (uint8_t *)(nvmConfig->nvmArea) + nvmCheckpoint.map[nvmCheckpoint.inflight[i].pageIndex] * NVM_PAGE_SIZE;
+          NVMHAL_Read(pOldPhysicalAddress, &watermark, sizeof(watermark));
+          if (NVM_PAGE_EMPTY_VALUE == watermark)
+          {
+            pOldPhysicalAddress = (uint8_t *) NVM_NO_PAGE_RETURNED;
+          }
+        }
+
+        validationResult = NVM_PageValidate(pNewPhysicalAddress);
+        NVMHAL_Read(pNewPhysicalAddress, &watermark, sizeof(watermark));
+
+        if (((uint8_t *) NVM_NO_PAGE_RETURNED == pOldPhysicalAddress)
+            || (((nvmValidateResultOk == validationResult) || (nvmValidateResultOkMarked == validationResult))
+                && ((watermark & NVM_FIRST_BIT_ZERO) == (*(nvmConfig->nvmPages))[nvmCheckpoint.inflight[i].pageIndex].pageId)))
+        {
+          /* The new one validates, or it is the only one left. Delete the old one. */
+          if ((uint8_t *) NVM_NO_PAGE_RETURNED != pOldPhysicalAddress)
+          {
+            eraseResult = NVM_PageErase(pOldPhysicalAddress);
+          }
+          nvmCheckpoint.map[nvmCheckpoint.inflight[i].pageIndex] = nvmCheckpoint.inflight[i].page;
+        }
+        else
+        {
+          /* The new one is broken, delete the new one. */
+          eraseResult = NVM_PageErase(pNewPhysicalAddress);
+        }
+
+        /* Something went wrong */
+        if (nvmResultOk != eraseResult)
+        {
+          result = nvmResultError;
+        }
+      }
+    }
+
+    nvmCheckpoint.inflight[i].pageIndex = NVM_CHECKPOINT_NO_PAGE;
+    nvmCheckpoint.inflight[i].page      = NVM_CHECKPOINT_NO_PAGE;
+  }
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  nvmStaticWearWorking = false;
+#endif
+
+  /* The content of the pages is validated the first time they are used. */
+  for (i = 0; i < nvmConfig->pages; ++i)
+  {
+    NVM_ValidationPendingSet((uint8_t *)(nvmConfig->nvmArea) + i * NVM_PAGE_SIZE, false);
+  }
+  for (i = 0; i < nvmConfig->userPages; ++i)
+  {
+    if (NVM_CHECKPOINT_NO_PAGE != nvmCheckpoint.map[i])
+    {
+      NVM_ValidationPendingSet((uint8_t *)(nvmConfig->nvmArea) + nvmCheckpoint.map[i] * NVM_PAGE_SIZE, true);
+      if (nvmResultNoPages == result)
+      {
+        result = nvmResultOk;
+      }
+    }
+  }
+
+  nvmCheckpointValid = true;
+
+  /* Start a new checkpoint without the resolved page writes. */
+  if (resolved && (nvmResultOk != NVM_CheckpointWrite()))
+  {
+    NVM_CheckpointInvalidate();
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Write a new checkpoint.
+ *
+ * @details
+ *   This function writes the page map, static wear leveling state and erase
+ *   budget of the governor kept in RAM to the checkpoint page not in use, and then uses that page for the
+ *   following records. The old checkpoint stays valid until the new one is
+ *   committed. If there is no checkpoint in use both pages are erased.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_CheckpointWrite(void)
+{
+  /* Result used as return value from the function. */
+  NVM_Result_t result;
+  /* Address of the checkpoint page to write. */
+  uint8_t      *pPhysicalAddress = (uint8_t *)(nvmConfig->checkpointArea);
+
+  /* Page header and the commit word after the checkpoint. */
+  NVM_Page_Header_t header;
+  uint32_t          commit;
+  /* Variable used for calculating checksums. */
+  uint16_t          checksum = NVM_CHECKSUM_INITIAL;
+
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  uint16_t i;
+#endif
+
+  if (nvmCheckpointPage == pPhysicalAddress)
+  {
+    pPhysicalAddress += NVM_PAGE_SIZE;
+  }
+  else if (0 == nvmCheckpointPage)
+  {
+    /* No checkpoint in use. Remove anything older than the one written now. */
+    NVM_CheckpointPageErase(pPhysicalAddress + NVM_PAGE_SIZE);
+  }
+
+  /* The checkpoint page is not in use until the new checkpoint is committed. */
+  nvmCheckpointPage = 0;
+
+  result = NVM_CheckpointPageErase(pPhysicalAddress);
+  if (nvmResultOk != result)
+  {
+    return result;
+  }
+
+  /* Write header. The erasure count is already written by the erase. */
+  header.watermark = NVM_CHECKPOINT_WATERMARK;
+  header.version   = NVM_VERSION;
+  result = NVMHAL_Write(pPhysicalAddress, &header.watermark, sizeof(header.watermark));
+  if (nvmResultOk == result)
+  {
+    result = NVMHAL_Write(pPhysicalAddress + sizeof(header.watermark) + sizeof(header.updateId), &header.version, sizeof(header.version));
+  }
+  if (nvmResultOk != result)
+  {
+    return result;
+  }
+
+  nvmCheckpoint.sequence++;
+  nvmCheckpoint.pages     = nvmConfig->pages;
+  nvmCheckpoint.userPages = nvmConfig->userPages;
+#if (NVM_FEATURE_STATIC_WEAR_ENABLED == true)
+  for (i = 0; i < sizeof(nvmStaticWearWriteHistory); ++i)
+  {
+    nvmCheckpoint.staticWearWriteHistory[i] = nvmStaticWearWriteHistory[i];
+  }
+  nvmCheckpoint.staticWearWritesInHistory  = nvmStaticWearWritesInHistory;
+  nvmCheckpoint.staticWearErasesSinceReset = nvmStaticWearErasesSinceReset;
+#endif
+#if (NVM_FEATURE_GOVERNOR_ENABLED == true)
+  nvmCheckpoint.governorCredit     = nvmGovernorCredit;
+  nvmCheckpoint.governorEraseTotal = NVM_GovernorEraseTotal();
+#endif
+
+  /* Write the checkpoint, and commit it. */
+  result = NVMHAL_Write(pPhysicalAddress + NVM_HEADER_SIZE, &nvmCheckpoint, sizeof(nvmCheckpoint));
+  if (nvmResultOk == result)
+  {
+    NVM_ChecksumAdditive(&checksum, &nvmCheckpoint, sizeof(nvmCheckpoint));
+    commit = NVM_CHECKPOINT_COMMIT(checksum);
+    result = NVMHAL_Write(pPhysicalAddress + NVM_HEADER_SIZE + sizeof(nvmCheckpoint), &commit, sizeof(commit));
+  }
+
+  if (nvmResultOk == result)
+  {
+    nvmCheckpointPage   = pPhysicalAddress;
+    nvmCheckpointOffset = NVM_CHECKPOINT_RECORDS_OFFSET;
+  }
+
+  return result;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Record a page write in the checkpoint.
+ *
+ * @details
+ *   This function updates the page map in RAM, and appends a record of the
+ *   change to the checkpoint page. A new checkpoint is written when the page
+ *   is full. If the record cannot be stored the checkpoints are invalidated,
+ *   so that the next startup scans all the pages.
+ *
+ * @param[in] type
+ *   Type of record.
+ *
+ * @param[in] pageId
+ *   Identifier of the page written.
+ *
+ * @param[in] pPhysicalAddress
+ *   Physical page written to, or the one holding the page when done.
+ ******************************************************************************/
+static void NVM_CheckpointRecord(NVM_Checkpoint_Record_Type_t type, uint16_t pageId, uint8_t *pPhysicalAddress)
+{
+  NVM_Checkpoint_Record_t record;
+
+  if (!nvmCheckpointValid)
+  {
+    return;
+  }
+
+  record.type      = (uint16_t) type;
+  record.pageIndex = NVM_PageIndexGet(pageId);
+  record.page      = NVM_CHECKPOINT_NO_PAGE;
+  if ((uint8_t *) NVM_NO_PAGE_RETURNED != pPhysicalAddress)
+  {
+    record.page = (uint16_t)((pPhysicalAddress - (uint8_t *)(nvmConfig->nvmArea)) / NVM_PAGE_SIZE);
+  }
+  record.check = NVM_CHECKPOINT_RECORD_CHECK(record);
+
+  if (NVM_CHECKPOINT_NO_PAGE == record.pageIndex)
+  {
+    return;
+  }
+
+  if (!NVM_CheckpointApply(&record))
+  {
+    NVM_CheckpointInvalidate();
+    return;
+  }
+
+  if ((nvmCheckpointOffset + sizeof(record)) > NVM_PAGE_SIZE)
+  {
+    /* The new checkpoint includes the record. */
+    if (nvmResultOk != NVM_CheckpointWrite())
+    {
+      NVM_CheckpointInvalidate();
+    }
+  }
+  else
+  {
+    if (nvmResultOk != NVMHAL_Write(nvmCheckpointPage + nvmCheckpointOffset, &record, sizeof(record)))
+    {
+      NVM_CheckpointInvalidate();
+    }
+    nvmCheckpointOffset += sizeof(record);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Invalidate the checkpoints.
+ *
+ * @details
+ *   This function erases both checkpoint pages and stops using the page map,
+ *   so that pages are found by traversing the flash memory until the next
+ *   startup.
+ ******************************************************************************/
+static void NVM_CheckpointInvalidate(void)
+{
+  uint16_t i;
+
+  nvmCheckpointValid = false;
+  nvmCheckpointPage  = 0;
+
+  for (i = 0; i < NVM_CHECKPOINT_PAGES; ++i)
+  {
+    NVM_CheckpointPageErase((uint8_t *)(nvmConfig->checkpointArea) + i * NVM_PAGE_SIZE);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erases a checkpoint page.
+ *
+ * @details
+ *   This function erases a checkpoint page while the erasure count of the
+ *   page is retained and updated, like NVM_PageErase does for the NVM pages.
+ *
+ * @param[in] pPhysicalAddress
+ *   Pointer to the checkpoint page you want to erase.
+ *
+ * @return
+ *   Returns the result of the operation as a NVM_Result_t.
+ ******************************************************************************/
+static NVM_Result_t NVM_CheckpointPageErase(uint8_t *pPhysicalAddress)
+{
+  /* Read out the old page update id. */
+  uint32_t updateId;
+  NVMHAL_Read(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+
+  /* Erase the page. */
+  NVMHAL_PageErase(pPhysicalAddress);
+  NVM_STATS_INC(pageErases)
+
+  /* Update erasure count. */
+  updateId++;
+
+  /* Write increased erasure count. */
+  return NVMHAL_Write(pPhysicalAddress + 2, &updateId, sizeof(updateId));
+}
+#endif
+
+#if (NVM_FEATURE_STATS_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Record the cycle count of an API call.
+ *
+ * @details
+ *   This function updates the call count, minimum, maximum and total cycle
+ *   count of an API function with the cycles elapsed since the call started.
+ *
+ * @param[in] api
+ *   The API function that was timed.
+ *
+ * @param[in] startCycles
+ *   Value of the cycle counter when the call started.
+ ******************************************************************************/
+static void NVM_StatsTimingRecord(NVM_Stats_Api_t api, uint32_t startCycles)
+{
+  /* Unsigned subtraction handles a wrapping cycle counter. */
+  uint32_t           cycles  = NVM_STATS_CYCLES_GET() - startCycles;
+  NVM_Stats_Timing_t *pTiming = &nvmStats.timing[api];
+
+  if ((0 == pTiming->calls) || (cycles < pTiming->min))
+  {
+    pTiming->min = cycles;
+  }
+  if (cycles > pTiming->max)
+  {
+    pTiming->max = cycles;
+  }
+  pTiming->calls++;
+  nvmStatsCyclesTotal[api] += cycles;
+}
+
+#if defined(NVM_STATS_DWT_CYCLES)
+/***************************************************************************//**
+ * @brief
+ *   Start the cycle counter used to time the API functions.
+ *
+ * @return
+ *   Returns the value of the cycle counter once it runs.
+ ******************************************************************************/
+static uint32_t NVM_StatsCyclesStart(void)
+{
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+  return NVM_STATS_CYCLES_GET();
+}
+#endif
+#endif
+
+/** @endcond */
+
+/** @} (end addtogroup NVM */
+/** @} (end addtogroup EM_Drivers) */
@@ -0,0 +1,63 @@
+/***************************************************************************//**
+ * @file
+ * @brief Host stand-in for the MSC driver, used by the NVM tests.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ *******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#ifndef __EM_MSC_H
+#define __EM_MSC_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Return codes of the MSC functions used by the NVM HAL. */
+typedef enum
+{
+  mscReturnOk          = 0,  /**< Flash operation done. */
+  mscReturnInvalidAddr = -1, /**< Address out of range. */
+  mscReturnLocked      = -2, /**< Page is locked. */
+  mscReturnTimeOut     = -3, /**< Operation timed out. */
+  mscReturnUnaligned   = -4  /**< Address is not word aligned. */
+} msc_Return_TypeDef;
+
+void MSC_Init(void);
+void MSC_Deinit(void);
+msc_Return_TypeDef MSC_WriteWord(uint32_t *address, void const *data, uint32_t numBytes);
+msc_Return_TypeDef MSC_ErasePage(uint32_t *startAddress);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EM_MSC_H */
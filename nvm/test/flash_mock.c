@@ -0,0 +1,226 @@
+/***************************************************************************//**
+ * @file
+ * @brief Flash in RAM with power loss injection, used by the NVM tests.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ *******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "em_msc.h"
+#include "flash_mock.h"
+
+/*******************************************************************************
+ ***************************   GLOBAL VARIABLES   ******************************
+ ******************************************************************************/
+
+uint32_t flashMockWords[FLASHMOCK_PAGES * FLASHMOCK_PAGE_SIZE / sizeof(uint32_t)];
+jmp_buf  flashMockPowerLoss;
+uint8_t  *flashMockCutAddress;
+
+/*******************************************************************************
+ *******************************   STATICS   ***********************************
+ ******************************************************************************/
+
+/* Word programs and page erases done since the last reset. */
+static uint32_t flashMockOperations;
+static uint32_t flashMockErases;
+
+/* Operation hit by the power loss, or 0 if none is armed. */
+static uint32_t        flashMockCutOperation;
+static FlashMock_Cut_t flashMockCut;
+
+/*******************************************************************************
+ ***************************   LOCAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Count a flash operation, and check if the power is lost before it is
+ *   done.
+ *
+ * @return
+ *   Returns true if the power is lost.
+ ******************************************************************************/
+static int FLASHMOCK_Operation(void)
+{
+  flashMockOperations++;
+  if (flashMockOperations != flashMockCutOperation)
+  {
+    return 0;
+  }
+
+  flashMockCutOperation = 0;
+  return 1;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Find the index of a word in the flash, and stop if it is outside.
+ ******************************************************************************/
+static size_t FLASHMOCK_Index(uint32_t *address)
+{
+  if ((address < flashMockWords)
+      || (address >= (flashMockWords + sizeof(flashMockWords) / sizeof(uint32_t))))
+  {
+    fprintf(stderr, "flash access outside the flash\n");
+    abort();
+  }
+
+  return (size_t) (address - flashMockWords);
+}
+
+/*******************************************************************************
+ ***************************   GLOBAL FUNCTIONS   ******************************
+ ******************************************************************************/
+
+void MSC_Init(void)
+{
+}
+
+void MSC_Deinit(void)
+{
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Program words like NOR flash does, by clearing bits.
+ ******************************************************************************/
+msc_Return_TypeDef MSC_WriteWord(uint32_t *address, void const *data, uint32_t numBytes)
+{
+  uint32_t i;
+  uint32_t word;
+
+  for (i = 0; i < numBytes / sizeof(uint32_t); ++i)
+  {
+    FLASHMOCK_Index(address + i);
+    memcpy(&word, (uint8_t const *) data + i * sizeof(uint32_t), sizeof(word));
+
+    if (FLASHMOCK_Operation())
+    {
+      if (flashMockCutTorn == flashMockCut)
+      {
+        /* Only every other bit to be cleared is cleared. */
+        address[i] &= word | 0xaaaaaaaaUL;
+      }
+      flashMockCutAddress = (uint8_t *) (address + i);
+      longjmp(flashMockPowerLoss, 1);
+    }
+
+    address[i] &= word;
+  }
+
+  return mscReturnOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erase a page.
+ ******************************************************************************/
+msc_Return_TypeDef MSC_ErasePage(uint32_t *startAddress)
+{
+  size_t index = FLASHMOCK_Index(startAddress);
+
+  if (0 != (index % (FLASHMOCK_PAGE_SIZE / sizeof(uint32_t))))
+  {
+    return mscReturnUnaligned;
+  }
+
+  if (FLASHMOCK_Operation())
+  {
+    flashMockCutAddress = (uint8_t *) startAddress;
+    longjmp(flashMockPowerLoss, 1);
+  }
+
+  memset(startAddress, 0xff, FLASHMOCK_PAGE_SIZE);
+  flashMockErases++;
+
+  return mscReturnOk;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Erase the whole flash, and clear the operation counts.
+ ******************************************************************************/
+void FLASHMOCK_Reset(void)
+{
+  memset(flashMockWords, 0xff, sizeof(flashMockWords));
+  flashMockOperations   = 0;
+  flashMockErases       = 0;
+  flashMockCutOperation = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Lose the power at a flash operation.
+ *
+ * @details
+ *   The power is lost at the given word program or page erase, counted from
+ *   now. flashMockPowerLoss is then jumped to, and the power loss is disarmed.
+ *
+ * @param[in] operations
+ *   Number of the operation to lose the power at, from 1.
+ *
+ * @param[in] cut
+ *   How the operation is left.
+ ******************************************************************************/
+void FLASHMOCK_PowerLossArm(uint32_t operations, FlashMock_Cut_t cut)
+{
+  flashMockCutOperation = flashMockOperations + operations;
+  flashMockCut          = cut;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Keep the power on.
+ ******************************************************************************/
+void FLASHMOCK_PowerLossDisarm(void)
+{
+  flashMockCutOperation = 0;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of word programs and page erases since the last reset.
+ ******************************************************************************/
+uint32_t FLASHMOCK_Operations(void)
+{
+  return flashMockOperations;
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Get the number of page erases since the last reset.
+ ******************************************************************************/
+uint32_t FLASHMOCK_Erases(void)
+{
+  return flashMockErases;
+}
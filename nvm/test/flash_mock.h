@@ -0,0 +1,75 @@
+/***************************************************************************//**
+ * @file
+ * @brief Flash in RAM with power loss injection, used by the NVM tests.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ *******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#ifndef __FLASH_MOCK_H
+#define __FLASH_MOCK_H
+
+#include <stdint.h>
+#include <setjmp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Number of flash pages, and their size. */
+#define FLASHMOCK_PAGES        10
+#define FLASHMOCK_PAGE_SIZE    512
+
+/** How the flash operation hit by a power loss is left. */
+typedef enum
+{
+  flashMockCutBefore = 0, /**< The operation is not started. */
+  flashMockCutTorn   = 1  /**< A word program clears only some of its bits. An erase is not started. */
+} FlashMock_Cut_t;
+
+/** The flash, as words. */
+extern uint32_t flashMockWords[FLASHMOCK_PAGES * FLASHMOCK_PAGE_SIZE / sizeof(uint32_t)];
+
+/** Jumped to on a power loss. */
+extern jmp_buf flashMockPowerLoss;
+
+/** Address of the word or page hit by the last power loss. */
+extern uint8_t *flashMockCutAddress;
+
+void FLASHMOCK_Reset(void);
+void FLASHMOCK_PowerLossArm(uint32_t operations, FlashMock_Cut_t cut);
+void FLASHMOCK_PowerLossDisarm(void);
+uint32_t FLASHMOCK_Operations(void);
+uint32_t FLASHMOCK_Erases(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FLASH_MOCK_H */
@@ -0,0 +1,764 @@
+/***************************************************************************//**
+ * @file
+ * @brief Power loss tests of the NVM manager, run on a host.
+ * @author Energy Micro AS
+ * @version 3.20.0
+ *******************************************************************************
+ * @section License
+ * <b>(C) Copyright 2013 Energy Micro AS, http://www.energymicro.com</b>
+ *******************************************************************************
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely, subject to the following restrictions:
+ *
+ * 1. The origin of this software must not be misrepresented; you must not
+ *    claim that you wrote the original software.
+ * 2. Altered source versions must be plainly marked as such, and must not be
+ *    misrepresented as being the original software.
+ * 3. This notice may not be removed or altered from any source distribution.
+ * 4. The source and compiled code may only be used on Energy Micro "EFM32"
+ *    microcontrollers and "EFR4" radios.
+ *
+ * DISCLAIMER OF WARRANTY/LIMITATION OF REMEDIES: Energy Micro AS has no
+ * obligation to support this Software. Energy Micro AS is providing the
+ * Software "AS IS", with no express or implied warranties of any kind,
+ * including, but not limited to, any implied warranties of merchantability
+ * or fitness for any particular purpose or warranties against infringement
+ * of any proprietary rights of a third party.
+ *
+ * Energy Micro AS will not be liable for any consequential, incidental, or
+ * special damages, or any other relief, or for any claim by any third party,
+ * arising from your use of this Software.
+ *
+ *****************************************************************************/
+#include <stdio.h>
+#include <string.h>
+#include "nvm.h"
+#include "flash_mock.h"
+
+#if (NVM_FEATURE_WRITE_RANGE_ENABLED != true) || (NVM_FEATURE_WRITE_IN_PLACE_ENABLED != true) \
+  || (NVM_FEATURE_TRANSACTIONS_ENABLED != true) || (NVM_FEATURE_CHECKPOINT_ENABLED != true)
+#error "Build the tests with the Makefile in this directory."
+#endif
+
+/*******************************************************************************
+ *******************************   DEFINES   ***********************************
+ ******************************************************************************/
+
+/** Physical pages used by the NVM. The checkpoint pages follow them. */
+#define TEST_PAGES              8
+
+/** Size of the page header, which comes before the objects. */
+#define TEST_HEADER_SIZE        8
+
+/** Size of the objects. */
+#define TEST_RECORD_SIZE        32
+#define TEST_BLOCK_SIZE         16
+
+/** Range of the record changed in place. */
+#define TEST_RANGE_OFFSET       4
+#define TEST_RANGE_LENGTH       20
+
+/** Page writes in the checkpoint test. Enough to fill a checkpoint page. */
+#define TEST_CHECKPOINT_WRITES  60
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+/** Versions in the page header of a normal page, and of a normal page stored
+ *  like a wear page. */
+#define TEST_NORMAL_VERSION     0x0002
+#define TEST_HOT_VERSION        0x2000
+
+/** Copies of a block that fit in a page stored like a wear page. */
+#define TEST_WEAR_SLOTS         ((FLASHMOCK_PAGE_SIZE - TEST_HEADER_SIZE) / (TEST_BLOCK_SIZE + 2))
+
+/** Page writes in the hot page test. The page is stored like a wear page, and
+ *  fills that page twice. */
+#define TEST_HOT_WRITES         (NVM_HOT_PAGE_THRESHOLD + 2 * TEST_WEAR_SLOTS)
+#endif
+
+/** Check a condition, and count it as a failure if it does not hold. */
+#define CHECK(condition)                                                  \
+  do                                                                      \
+  {                                                                       \
+    if (!(condition))                                                     \
+    {                                                                     \
+      printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition);         \
+      testFailures++;                                                     \
+    }                                                                     \
+  } while (0)
+
+/*******************************************************************************
+ ******************************   TYPEDEFS   ***********************************
+ ******************************************************************************/
+
+/* Object IDs. */
+typedef enum
+{
+  RECORD_ID,
+  GENERATION_ID,
+  BLOCK_ID
+} NVM_Object_Ids;
+
+/* Page IDs. */
+typedef enum
+{
+  RECORD_PAGE_ID,
+  BLOCK_A_PAGE_ID,
+  BLOCK_B_PAGE_ID,
+  TEST_USER_PAGES
+} NVM_Page_Ids;
+
+/*******************************************************************************
+ *******************************   STATICS   ***********************************
+ ******************************************************************************/
+
+/* Objects in RAM. */
+static uint8_t  record[TEST_RECORD_SIZE];
+static uint32_t generation;
+static uint8_t  blockA[TEST_BLOCK_SIZE];
+static uint8_t  blockB[TEST_BLOCK_SIZE];
+
+#define RECORD_PAGE_OBJECTS(X, P)  \
+  X(P, record,     RECORD_ID)      \
+  X(P, generation, GENERATION_ID)
+
+NVM_PAGE_LAYOUT(recordPage, RECORD_PAGE_OBJECTS);
+
+#define BLOCK_A_PAGE_OBJECTS(X, P) \
+  X(P, blockA, BLOCK_ID)
+
+NVM_PAGE_LAYOUT(blockAPage, BLOCK_A_PAGE_OBJECTS);
+
+#define BLOCK_B_PAGE_OBJECTS(X, P) \
+  X(P, blockB, BLOCK_ID)
+
+NVM_PAGE_LAYOUT(blockBPage, BLOCK_B_PAGE_OBJECTS);
+
+static NVM_Page_Table_t const pageTable =
+{
+  { RECORD_PAGE_ID,  &recordPage, nvmPageTypeNormal },
+  { BLOCK_A_PAGE_ID, &blockAPage, nvmPageTypeNormal },
+  { BLOCK_B_PAGE_ID, &blockBPage, nvmPageTypeNormal }
+};
+
+/* The pages are found by scanning them. */
+static NVM_Config_t const scanConfig =
+{
+  &pageTable, TEST_PAGES, TEST_USER_PAGES, (uint8_t *) flashMockWords, NULL, NULL
+};
+
+/* The pages are found from the checkpoints. */
+static NVM_Config_t const checkpointConfig =
+{
+  &pageTable, TEST_PAGES, TEST_USER_PAGES, (uint8_t *) flashMockWords,
+  (uint8_t *) flashMockWords + TEST_PAGES * FLASHMOCK_PAGE_SIZE, NULL
+};
+
+/* A single physical page is free, which is too few for a transaction of two
+ * pages. */
+static NVM_Config_t const tightConfig =
+{
+  &pageTable, TEST_USER_PAGES + 1, TEST_USER_PAGES, (uint8_t *) flashMockWords, NULL, NULL
+};
+
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+/* A page written by hand, with the offsets left at 0. */
+static NVM_Page_t const unlaidPage =
+{
+  { record, sizeof(record), RECORD_ID, 0 },
+  { (uint8_t *) &generation, sizeof(generation), GENERATION_ID, 0 },
+  NVM_PAGE_TERMINATION
+};
+
+static NVM_Page_Table_t const unlaidPageTable =
+{
+  { RECORD_PAGE_ID,  &unlaidPage, nvmPageTypeNormal },
+  { BLOCK_A_PAGE_ID, &blockAPage, nvmPageTypeNormal },
+  { BLOCK_B_PAGE_ID, &blockBPage, nvmPageTypeNormal }
+};
+
+/* NVM_Init must reject the page table. */
+static NVM_Config_t const unlaidConfig =
+{
+  &unlaidPageTable, TEST_PAGES, TEST_USER_PAGES, (uint8_t *) flashMockWords, NULL, NULL
+};
+#endif
+
+/* Content of the flash before the operation under test. */
+static uint32_t testSnapshot[sizeof(flashMockWords) / sizeof(uint32_t)];
+
+/* Number of failed checks. */
+static int testFailures;
+
+/* State of the operation under test when the power is lost. They are kept
+ * here, since locals changed after setjmp are not reliable after longjmp. */
+static bool     testDone;
+static uint16_t testPageId;
+static uint32_t testGeneration;
+static uint32_t testExpected[TEST_USER_PAGES];
+
+/* Content of a block as read from the checkpoint. */
+static uint8_t  testBlock[TEST_BLOCK_SIZE];
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+/* Content of a block after the last finished write, and the one in progress. */
+static uint8_t  testOldBlock[TEST_BLOCK_SIZE];
+static uint8_t  testNewBlock[TEST_BLOCK_SIZE];
+#endif
+
+/* Power losses of the operation under test, in all and by where they hit. */
+static uint32_t testCuts;
+static uint32_t testJournalCuts;
+static uint32_t testRangeCuts;
+
+/*******************************************************************************
+ ***************************   LOCAL FUNCTIONS   *******************************
+ ******************************************************************************/
+
+/***************************************************************************//**
+ * @brief
+ *   Fill a buffer with a pattern given by a generation number.
+ ******************************************************************************/
+static void TEST_Fill(uint8_t *pBuffer, uint16_t len, uint32_t value)
+{
+  uint16_t i;
+
+  for (i = 0; i < len; ++i)
+  {
+    pBuffer[i] = (uint8_t) (value * 31 + i);
+  }
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Check if a buffer holds the pattern of a generation number.
+ ******************************************************************************/
+static bool TEST_Same(uint8_t const *pBuffer, uint16_t len, uint32_t value)
+{
+  uint16_t i;
+
+  for (i = 0; i < len; ++i)
+  {
+    if (pBuffer[i] != (uint8_t) (value * 31 + i))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Get the version in the header of the physical page holding a page.
+ ******************************************************************************/
+static uint16_t TEST_PageVersion(uint16_t pageId)
+{
+  uint8_t  *pPage;
+  uint16_t watermark;
+  uint16_t version;
+  uint16_t page;
+
+  for (page = 0; page < TEST_PAGES; ++page)
+  {
+    pPage = (uint8_t *) flashMockWords + page * FLASHMOCK_PAGE_SIZE;
+    memcpy(&watermark, pPage, sizeof(watermark));
+    if ((pageId | 0x8000) == watermark)
+    {
+      memcpy(&version, pPage + TEST_HEADER_SIZE - sizeof(version), sizeof(version));
+      return version;
+    }
+  }
+
+  return 0xffff;
+}
+#endif
+
+/***************************************************************************//**
+ * @brief
+ *   Format the NVM and write the first generation of every page.
+ ******************************************************************************/
+static void TEST_Format(NVM_Config_t const *config)
+{
+  FLASHMOCK_Reset();
+  CHECK(nvmResultNoPages == NVM_Init(config));
+  CHECK(nvmResultOk == NVM_Erase(0));
+
+  memset(record, 0xff, sizeof(record));
+  generation = 1;
+  TEST_Fill(blockA, sizeof(blockA), 1);
+  TEST_Fill(blockB, sizeof(blockB), 1);
+  CHECK(nvmResultOk == NVM_Write(RECORD_PAGE_ID, NVM_WRITE_ALL_CMD));
+  CHECK(nvmResultOk == NVM_Write(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+  CHECK(nvmResultOk == NVM_Write(BLOCK_B_PAGE_ID, NVM_WRITE_ALL_CMD));
+
+  memcpy(testSnapshot, flashMockWords, sizeof(testSnapshot));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Go back to the flash content before the operation under test, and start
+ *   the NVM again.
+ ******************************************************************************/
+static void TEST_Restore(NVM_Config_t const *config)
+{
+  FLASHMOCK_PowerLossDisarm();
+  memcpy(flashMockWords, testSnapshot, sizeof(testSnapshot));
+  CHECK(nvmResultOk == NVM_Init(config));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Lose the power at every flash operation of a page write.
+ *
+ * @details
+ *   The page is moved to a new physical page, and the old one is marked and
+ *   erased. After a restart the page must hold either the old or the new
+ *   generation, and the other pages must be left as they were.
+ ******************************************************************************/
+static void TEST_PageWrite(NVM_Config_t const *config, FlashMock_Cut_t cut)
+{
+  uint32_t operations;
+
+  TEST_Format(config);
+  testCuts = 0;
+
+  for (operations = 1, testDone = false; !testDone; ++operations)
+  {
+    TEST_Restore(config);
+
+    FLASHMOCK_PowerLossArm(operations, cut);
+    if (0 == setjmp(flashMockPowerLoss))
+    {
+      TEST_Fill(blockA, sizeof(blockA), 2);
+      CHECK(nvmResultOk == NVM_Write(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+      FLASHMOCK_PowerLossDisarm();
+      testDone = true;
+    }
+    else
+    {
+      testCuts++;
+    }
+
+    /* Restart, and check that the page is old or new. */
+    memset(blockA, 0, sizeof(blockA));
+    memset(blockB, 0, sizeof(blockB));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(nvmResultOk == NVM_Read(RECORD_PAGE_ID, GENERATION_ID));
+    CHECK(TEST_Same(blockA, sizeof(blockA), 2) || (!testDone && TEST_Same(blockA, sizeof(blockA), 1)));
+    CHECK(TEST_Same(blockB, sizeof(blockB), 1));
+    CHECK(1 == generation);
+
+    /* The page can still be written after the restart. */
+    TEST_Fill(blockA, sizeof(blockA), 3);
+    CHECK(nvmResultOk == NVM_Write(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+    memset(blockA, 0, sizeof(blockA));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(TEST_Same(blockA, sizeof(blockA), 3));
+  }
+
+  CHECK(testCuts > 0);
+  printf("page write: %lu power losses\n", (unsigned long) testCuts);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Lose the power at every flash operation of an in-place NVM_WriteRange, or
+ *   of an NVM_Write of the whole record.
+ *
+ * @details
+ *   The new data is first added to the patch journal of the page, and then
+ *   programmed in place. After a restart the record must hold either the old
+ *   or the new data, and the page must still be writable.
+ ******************************************************************************/
+static void TEST_PatchJournal(NVM_Config_t const *config, FlashMock_Cut_t cut, bool writeRange)
+{
+  uint32_t operations;
+  uint32_t erases;
+  uint16_t pageOffset;
+  uint8_t  oldData[TEST_RECORD_SIZE];
+  uint8_t  newData[TEST_RANGE_LENGTH];
+  uint8_t  expected[TEST_RECORD_SIZE];
+
+  TEST_Format(config);
+  testJournalCuts = 0;
+  testRangeCuts   = 0;
+
+  /* The new data only clears bits, so it is programmed in place. */
+  memset(oldData, 0xff, sizeof(oldData));
+  TEST_Fill(newData, sizeof(newData), 2);
+  memcpy(expected, oldData, sizeof(expected));
+  memcpy(expected + TEST_RANGE_OFFSET, newData, sizeof(newData));
+
+  for (operations = 1, testDone = false; !testDone; ++operations)
+  {
+    TEST_Restore(config);
+    erases = FLASHMOCK_Erases();
+
+    FLASHMOCK_PowerLossArm(operations, cut);
+    if (0 == setjmp(flashMockPowerLoss))
+    {
+      if (writeRange)
+      {
+        CHECK(nvmResultOk == NVM_WriteRange(RECORD_PAGE_ID, RECORD_ID, TEST_RANGE_OFFSET, TEST_RANGE_LENGTH, newData));
+      }
+      else
+      {
+        memcpy(record, expected, sizeof(record));
+        CHECK(nvmResultOk == NVM_Write(RECORD_PAGE_ID, RECORD_ID));
+      }
+      FLASHMOCK_PowerLossDisarm();
+      testDone = true;
+
+      /* Nothing was erased, so the range was programmed in place. */
+      CHECK(FLASHMOCK_Erases() == erases);
+    }
+    else
+    {
+      pageOffset = (uint16_t) ((flashMockCutAddress - (uint8_t *) flashMockWords) % FLASHMOCK_PAGE_SIZE);
+      if (pageOffset < TEST_HEADER_SIZE + sizeof(record) + sizeof(generation))
+      {
+        testRangeCuts++;
+      }
+      else
+      {
+        testJournalCuts++;
+      }
+    }
+
+    /* Restart, and check that the record is either old or new. */
+    memset(record, 0, sizeof(record));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(RECORD_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(1 == generation);
+    if (testDone)
+    {
+      CHECK(0 == memcmp(record, expected, sizeof(record)));
+    }
+    else
+    {
+      CHECK((0 == memcmp(record, oldData, sizeof(record))) || (0 == memcmp(record, expected, sizeof(record))));
+    }
+
+    /* The page can still be written after the restart. */
+    memset(expected, 0, 4);
+    CHECK(nvmResultOk == NVM_WriteRange(RECORD_PAGE_ID, RECORD_ID, 0, 4, expected));
+    memcpy(expected, oldData, 4);
+    memset(record, 0xff, sizeof(record));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(RECORD_PAGE_ID, RECORD_ID));
+    CHECK((0 == record[0]) && (0 == record[3]));
+  }
+
+  /* Both the journal record and the range were cut. */
+  CHECK(testJournalCuts > 0);
+  CHECK(testRangeCuts > 0);
+  printf("patch journal, %s: %lu journal and %lu range power losses\n",
+         writeRange ? "NVM_WriteRange" : "NVM_Write",
+         (unsigned long) testJournalCuts, (unsigned long) testRangeCuts);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Lose the power at every flash operation of a transaction.
+ *
+ * @details
+ *   After a restart both pages of the transaction must hold either the old or
+ *   the new generation.
+ ******************************************************************************/
+static void TEST_Transaction(NVM_Config_t const *config, FlashMock_Cut_t cut)
+{
+  uint32_t operations;
+
+  TEST_Format(config);
+  testCuts = 0;
+
+  for (operations = 1, testDone = false; !testDone; ++operations)
+  {
+    TEST_Restore(config);
+
+    FLASHMOCK_PowerLossArm(operations, cut);
+    if (0 == setjmp(flashMockPowerLoss))
+    {
+      TEST_Fill(blockA, sizeof(blockA), 2);
+      TEST_Fill(blockB, sizeof(blockB), 2);
+      CHECK(nvmResultOk == NVM_TxBegin());
+      CHECK(nvmResultOk == NVM_TxWrite(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+      CHECK(nvmResultOk == NVM_TxWrite(BLOCK_B_PAGE_ID, NVM_WRITE_ALL_CMD));
+      CHECK(nvmResultOk == NVM_TxCommit());
+      FLASHMOCK_PowerLossDisarm();
+      testDone = true;
+    }
+    else
+    {
+      testCuts++;
+    }
+
+    /* Restart, and check that the pages are both old or both new. */
+    memset(blockA, 0, sizeof(blockA));
+    memset(blockB, 0, sizeof(blockB));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD));
+    if (testDone)
+    {
+      CHECK(TEST_Same(blockA, sizeof(blockA), 2) && TEST_Same(blockB, sizeof(blockB), 2));
+    }
+    else
+    {
+      CHECK((TEST_Same(blockA, sizeof(blockA), 1) && TEST_Same(blockB, sizeof(blockB), 1))
+            || (TEST_Same(blockA, sizeof(blockA), 2) && TEST_Same(blockB, sizeof(blockB), 2)));
+    }
+
+    /* The pages can still be written after the restart. */
+    TEST_Fill(blockA, sizeof(blockA), 3);
+    CHECK(nvmResultOk == NVM_Write(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+    memset(blockA, 0, sizeof(blockA));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(TEST_Same(blockA, sizeof(blockA), 3));
+  }
+
+  CHECK(testCuts > 0);
+  printf("transaction: %lu power losses\n", (unsigned long) testCuts);
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Commit a transaction with more pages than there are free physical pages.
+ *
+ * @details
+ *   The transaction must be rejected before anything is written.
+ ******************************************************************************/
+static void TEST_TransactionSpace(void)
+{
+  TEST_Format(&tightConfig);
+
+  TEST_Fill(blockA, sizeof(blockA), 2);
+  TEST_Fill(blockB, sizeof(blockB), 2);
+  CHECK(nvmResultOk == NVM_TxBegin());
+  CHECK(nvmResultOk == NVM_TxWrite(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+  CHECK(nvmResultOk == NVM_TxWrite(BLOCK_B_PAGE_ID, NVM_WRITE_ALL_CMD));
+  CHECK(nvmResultInputInvalid == NVM_TxCommit());
+  CHECK(0 == memcmp(flashMockWords, testSnapshot, sizeof(testSnapshot)));
+
+  /* A transaction of a single page fits. */
+  CHECK(nvmResultOk == NVM_TxBegin());
+  CHECK(nvmResultOk == NVM_TxWrite(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+  CHECK(nvmResultOk == NVM_TxCommit());
+  memset(blockA, 0, sizeof(blockA));
+  memset(blockB, 0, sizeof(blockB));
+  CHECK(nvmResultOk == NVM_Init(&tightConfig));
+  CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+  CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD));
+  CHECK(TEST_Same(blockA, sizeof(blockA), 2) && TEST_Same(blockB, sizeof(blockB), 1));
+}
+
+/***************************************************************************//**
+ * @brief
+ *   Lose the power at every flash operation of a series of page writes, while
+ *   the page map is kept in checkpoints.
+ *
+ * @details
+ *   The series is long enough to fill a checkpoint page and start the other
+ *   one. After a restart every page must hold the generation of its last
+ *   finished write, or of the write in progress.
+ ******************************************************************************/
+static void TEST_Checkpoint(FlashMock_Cut_t cut)
+{
+  uint32_t operations;
+  uint16_t i;
+  uint8_t  *pCheckpointArea = (uint8_t *) flashMockWords + TEST_PAGES * FLASHMOCK_PAGE_SIZE;
+
+  TEST_Format(&checkpointConfig);
+  testCuts = 0;
+
+  for (operations = 1, testDone = false; !testDone; ++operations)
+  {
+    TEST_Restore(&checkpointConfig);
+    testExpected[RECORD_PAGE_ID]  = 1;
+    testExpected[BLOCK_A_PAGE_ID] = 1;
+    testExpected[BLOCK_B_PAGE_ID] = 1;
+    testPageId                    = TEST_USER_PAGES;
+
+    FLASHMOCK_PowerLossArm(operations, cut);
+    if (0 == setjmp(flashMockPowerLoss))
+    {
+      for (testGeneration = 2; testGeneration < TEST_CHECKPOINT_WRITES + 2; ++testGeneration)
+      {
+        testPageId = (testGeneration % 2) ? BLOCK_A_PAGE_ID : BLOCK_B_PAGE_ID;
+        TEST_Fill((BLOCK_A_PAGE_ID == testPageId) ? blockA : blockB, TEST_BLOCK_SIZE, testGeneration);
+        CHECK(nvmResultOk == NVM_Write(testPageId, NVM_WRITE_ALL_CMD));
+        testExpected[testPageId] = testGeneration;
+      }
+      FLASHMOCK_PowerLossDisarm();
+      testPageId = TEST_USER_PAGES;
+      testDone   = true;
+
+      /* Both checkpoint pages have been used. */
+      CHECK(0xffffffffUL != *(uint32_t *) pCheckpointArea);
+      CHECK(0xffffffffUL != *(uint32_t *) (pCheckpointArea + FLASHMOCK_PAGE_SIZE));
+    }
+    else
+    {
+      testCuts++;
+    }
+
+    /* Restart, and check every page. */
+    memset(blockA, 0, sizeof(blockA));
+    memset(blockB, 0, sizeof(blockB));
+    CHECK(nvmResultOk == NVM_Init(&checkpointConfig));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(nvmResultOk == NVM_Read(RECORD_PAGE_ID, NVM_READ_ALL_CMD) && (1 == generation));
+    for (i = BLOCK_A_PAGE_ID; i <= BLOCK_B_PAGE_ID; ++i)
+    {
+      CHECK(TEST_Same((BLOCK_A_PAGE_ID == i) ? blockA : blockB, TEST_BLOCK_SIZE, testExpected[i])
+            || ((testPageId == i)
+                && TEST_Same((BLOCK_A_PAGE_ID == i) ? blockA : blockB, TEST_BLOCK_SIZE, testGeneration)));
+    }
+
+    /* The pages can still be written after the restart. */
+    TEST_Fill(blockB, sizeof(blockB), 1000);
+    CHECK(nvmResultOk == NVM_Write(BLOCK_B_PAGE_ID, NVM_WRITE_ALL_CMD));
+    memset(blockB, 0, sizeof(blockB));
+    CHECK(nvmResultOk == NVM_Init(&checkpointConfig));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(TEST_Same(blockB, sizeof(blockB), 1000));
+
+    /* Scanning the pages finds the same data as the checkpoint. */
+    memcpy(testBlock, blockA, sizeof(testBlock));
+    memset(blockA, 0, sizeof(blockA));
+    memset(blockB, 0, sizeof(blockB));
+    CHECK(nvmResultOk == NVM_Init(&scanConfig));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(0 == memcmp(blockA, testBlock, sizeof(blockA)));
+    CHECK(TEST_Same(blockB, sizeof(blockB), 1000));
+  }
+
+  CHECK(testCuts > 0);
+  printf("checkpoint: %lu power losses\n", (unsigned long) testCuts);
+}
+
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+/***************************************************************************//**
+ * @brief
+ *   Lose the power at every flash operation while a page is written often
+ *   enough to be stored like a wear page, and then stored as a normal page
+ *   again.
+ *
+ * @details
+ *   The page is promoted, its copies fill the wear page, and it is moved while
+ *   promoted. A partial write then stores it as a normal page. After a restart
+ *   the page must hold the data of its last finished write, or of the write in
+ *   progress, and a slot left partly programmed must not be used again.
+ ******************************************************************************/
+static void TEST_HotPage(NVM_Config_t const *config, FlashMock_Cut_t cut)
+{
+  uint32_t operations;
+
+  TEST_Format(config);
+  testCuts = 0;
+
+  for (operations = 1, testDone = false; !testDone; ++operations)
+  {
+    TEST_Restore(config);
+    TEST_Fill(testOldBlock, sizeof(testOldBlock), 1);
+    memcpy(testNewBlock, testOldBlock, sizeof(testNewBlock));
+
+    FLASHMOCK_PowerLossArm(operations, cut);
+    if (0 == setjmp(flashMockPowerLoss))
+    {
+      for (testGeneration = 2; testGeneration < TEST_HOT_WRITES + 2; ++testGeneration)
+      {
+        TEST_Fill(testNewBlock, sizeof(testNewBlock), testGeneration);
+        memcpy(blockA, testNewBlock, sizeof(blockA));
+        CHECK(nvmResultOk == NVM_Write(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+        memcpy(testOldBlock, testNewBlock, sizeof(testOldBlock));
+      }
+
+      /* The page is stored like a wear page. */
+      CHECK(TEST_HOT_VERSION == TEST_PageVersion(BLOCK_A_PAGE_ID));
+
+      /* A partial write stores it as a normal page again. */
+      TEST_Fill(testNewBlock, 4, testGeneration);
+      CHECK(nvmResultOk == NVM_WriteRange(BLOCK_A_PAGE_ID, BLOCK_ID, 0, 4, testNewBlock));
+      memcpy(testOldBlock, testNewBlock, sizeof(testOldBlock));
+      FLASHMOCK_PowerLossDisarm();
+      testDone = true;
+
+      CHECK(TEST_NORMAL_VERSION == TEST_PageVersion(BLOCK_A_PAGE_ID));
+    }
+    else
+    {
+      testCuts++;
+    }
+
+    /* Restart, and check the page. */
+    memset(blockA, 0, sizeof(blockA));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK((0 == memcmp(blockA, testOldBlock, sizeof(blockA))) || (0 == memcmp(blockA, testNewBlock, sizeof(blockA))));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_B_PAGE_ID, NVM_READ_ALL_CMD) && TEST_Same(blockB, sizeof(blockB), 1));
+
+    /* The page can still be written after the restart, and is found by
+     * scanning the pages. */
+    TEST_Fill(blockA, sizeof(blockA), 1000);
+    CHECK(nvmResultOk == NVM_Write(BLOCK_A_PAGE_ID, NVM_WRITE_ALL_CMD));
+    memset(blockA, 0, sizeof(blockA));
+    CHECK(nvmResultOk == NVM_Init(config));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(TEST_Same(blockA, sizeof(blockA), 1000));
+    memset(blockA, 0, sizeof(blockA));
+    CHECK(nvmResultOk == NVM_Init(&scanConfig));
+    CHECK(nvmResultOk == NVM_Read(BLOCK_A_PAGE_ID, NVM_READ_ALL_CMD));
+    CHECK(TEST_Same(blockA, sizeof(blockA), 1000));
+  }
+
+  CHECK(testCuts > 0);
+  printf("hot page: %lu power losses\n", (unsigned long) testCuts);
+}
+#endif
+
+/*******************************************************************************
+ ***************************   GLOBAL FUNCTIONS   ******************************
+ ******************************************************************************/
+
+int main(void)
+{
+  FlashMock_Cut_t cut;
+
+#if (NVM_FEATURE_STATIC_LAYOUT_ENABLED == true)
+  FLASHMOCK_Reset();
+  CHECK(nvmResultError == NVM_Init(&unlaidConfig));
+#endif
+
+  TEST_TransactionSpace();
+
+  for (cut = flashMockCutBefore; cut <= flashMockCutTorn; cut = (FlashMock_Cut_t) (cut + 1))
+  {
+    printf("%s programs:\n", (flashMockCutBefore == cut) ? "Interrupted" : "Torn");
+    TEST_PageWrite(&scanConfig, cut);
+    TEST_PageWrite(&checkpointConfig, cut);
+    TEST_PatchJournal(&scanConfig, cut, true);
+    TEST_PatchJournal(&checkpointConfig, cut, true);
+    TEST_PatchJournal(&scanConfig, cut, false);
+    TEST_PatchJournal(&checkpointConfig, cut, false);
+    TEST_Transaction(&scanConfig, cut);
+    TEST_Transaction(&checkpointConfig, cut);
+    TEST_Checkpoint(cut);
+#if (NVM_FEATURE_HOT_PAGES_ENABLED == true)
+    TEST_HotPage(&scanConfig, cut);
+    TEST_HotPage(&checkpointConfig, cut);
+#endif
+  }
+
+  printf(testFailures ? "%d checks failed\n" : "All checks passed\n", testFailures);
+  return (0 != testFailures);
+}